@@ -19,6 +19,19 @@
 				"src/utils/number_list.cpp",
 				"src/utils/warp_options.cpp",
 				"src/utils/ptr_manager.cpp",
+				"src/utils/buffer_path.cpp",
+				"src/utils/dataset_worker.cpp",
+				"src/utils/dataset_pool.cpp",
+				"src/utils/dataset_cache.cpp",
+				"src/utils/virtual_mem.cpp",
+				"src/utils/chunk_scan.cpp",
+				"src/utils/overview_builder.cpp",
+				"src/utils/calc_expression.cpp",
+				"src/utils/band_calc.cpp",
+				"src/utils/band_stats.cpp",
+				"src/utils/zonal_stats.cpp",
+				"src/utils/tile_generator.cpp",
+				"src/utils/mosaic_builder.cpp",
 				"src/node_gdal.cpp",
 				"src/gdal_common.cpp",
 				"src/gdal_dataset.cpp",
@@ -43,6 +56,7 @@
 				"src/gdal_warper.cpp",
 				"src/gdal_algorithms.cpp",
 				"src/collections/dataset_bands.cpp",
+				"src/collections/dataset_pixels.cpp",
 				"src/collections/dataset_layers.cpp",
 				"src/collections/layer_features.cpp",
 				"src/collections/layer_fields.cpp",
@@ -79,6 +93,9 @@
 					]
 				}],
 				["shared_gdal == 'false'", {
+					"defines": [
+						"BUNDLED_GDAL=1"
+					],
 					"dependencies": [
 						"deps/libgdal/libgdal.gyp:libgdal"
 					]
@@ -95,6 +95,11 @@ patch gdal/ogr/ogrsf_frmts/shape/shpopen.c < patches/ogrsf_frmts_shape_shpopenc.
 patch gdal/ogr/ogrsf_frmts/shape/dbfopen.c < patches/ogrsf_frmts_shape_dbfopen.diff
 patch gdal/ogr/ogrsf_frmts/shape/sbnsearch.c < patches/ogrsf_frmts_shape_sbnsearch.diff
 patch gdal/frmts/blx/blx.c < patches/frmts_blx_blxc.diff # missing cpl_port.h
+patch gdal/gcore/gdalproxypool.cpp < patches/gcore_gdalproxypool.diff # dataset pool hit / miss / eviction counters
+patch gdal/gcore/gdal_proxy.h < patches/gcore_gdal_proxy.diff
+patch gdal/gcore/gdal_priv.h < patches/gcore_gdal_priv_blockstats.diff # block cache hit / miss / eviction counters
+patch gdal/gcore/gdalrasterband.cpp < patches/gcore_gdalrasterband.diff
+patch gdal/gcore/gdalrasterblock.cpp < patches/gcore_gdalrasterblock.diff
 
 
 #
@@ -742,6 +742,11 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
     CPLErr eFlushBlockErr;
     GDALAbstractBandBlockCache* poBandBlockCache;
 
+    volatile int nBlockCacheHits;
+    volatile int nBlockCacheMisses;
+    volatile int nBlockCacheEvictions;
+    volatile int nBlocksDecoded;
+
     void           SetFlushBlockErr( CPLErr eErr );
     CPLErr         UnreferenceBlock( GDALRasterBlock* poBlock );
 
@@ -827,6 +832,9 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
 
     GDALDataType GetRasterDataType( void );
     void        GetBlockSize( int *, int * );
+    void        GetBlockCacheStats( GIntBig *pnHits, GIntBig *pnMisses,
+                                    GIntBig *pnEvictions, GIntBig *pnBytesDecoded );
+    void        ResetBlockCacheStats();
     GDALAccess  GetAccess();
 
     CPLErr      RasterIO( GDALRWFlag, int, int, int, int,
@@ -204,6 +204,9 @@ class CPL_DLL GDALProxyRasterBand : public GDALRasterBand
 typedef struct _GDALProxyPoolCacheEntry GDALProxyPoolCacheEntry;
 class     GDALProxyPoolRasterBand;
 
+void CPL_DLL GDALGetDatasetPoolStats(GIntBig* pnHits, GIntBig* pnMisses, GIntBig* pnEvictions,
+                                     int* pnOpen, int* pnMaxSize);
+
 class CPL_DLL GDALProxyPoolDataset : public GDALProxyDataset
 {
     private:
@@ -48,6 +48,11 @@ CPL_CVSID("$Id: gdalproxypool.cpp 32234 2015-12-18 12:40:59Z rouault $");
 class GDALDatasetPool;
 static GDALDatasetPool* singleton = NULL;
 
+/* Usage counters, kept across singleton re-creations */
+static GIntBig nPoolHits = 0;
+static GIntBig nPoolMisses = 0;
+static GIntBig nPoolEvictions = 0;
+
 void GDALNullifyProxyPoolSingleton() { singleton = NULL; }
 
 struct _GDALProxyPoolCacheEntry
@@ -110,6 +115,9 @@ class GDALDatasetPool
 
         static void PreventDestroy();
         static void ForceDestroy();
+
+        static void GetStats(GIntBig* pnHits, GIntBig* pnMisses, GIntBig* pnEvictions,
+                             int* pnOpen, int* pnMaxSize);
 };
 
 
@@ -227,6 +235,7 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
             }
 
             cur->refCount ++;
+            nPoolHits ++;
             return cur;
         }
 
@@ -260,6 +269,7 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
 
             lastEntryWithZeroRefCount->poDS = NULL;
             GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+            nPoolEvictions ++;
         }
         CPLFree(lastEntryWithZeroRefCount->pszFileName);
 
@@ -306,6 +316,7 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
     cur->pszFileName = CPLStrdup(pszFileName);
     cur->responsiblePID = responsiblePID;
     cur->refCount = 1;
+    nPoolMisses ++;
 
     refCountOfDisableRefCount ++;
     int nFlag = ((eAccess == GA_Update) ? GDAL_OF_UPDATE : GDAL_OF_READONLY) | GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
@@ -432,6 +443,44 @@ void GDALDatasetPoolForceDestroy()
     GDALDatasetPool::ForceDestroy();
 }
 
+/************************************************************************/
+/*                             GetStats()                               */
+/************************************************************************/
+
+void GDALDatasetPool::GetStats(GIntBig* pnHits, GIntBig* pnMisses, GIntBig* pnEvictions,
+                               int* pnOpen, int* pnMaxSize)
+{
+    CPLMutexHolderD( GDALGetphDLMutex() );
+    *pnHits = nPoolHits;
+    *pnMisses = nPoolMisses;
+    *pnEvictions = nPoolEvictions;
+    *pnOpen = 0;
+    if (singleton)
+    {
+        GDALProxyPoolCacheEntry* cur = singleton->firstEntry;
+        while(cur)
+        {
+            if (cur->poDS)
+                (*pnOpen) ++;
+            cur = cur->next;
+        }
+        *pnMaxSize = singleton->maxSize;
+    }
+    else
+    {
+        *pnMaxSize = atoi(CPLGetConfigOption("GDAL_MAX_DATASET_POOL_SIZE", "100"));
+        if (*pnMaxSize < 2 || *pnMaxSize > 1000)
+            *pnMaxSize = 100;
+    }
+}
+
+/* Not part of upstream GDAL: reports how well the pool is doing */
+void GDALGetDatasetPoolStats(GIntBig* pnHits, GIntBig* pnMisses, GIntBig* pnEvictions,
+                             int* pnOpen, int* pnMaxSize)
+{
+    GDALDatasetPool::GetStats(pnHits, pnMisses, pnEvictions, pnOpen, pnMaxSize);
+}
+
 /************************************************************************/
 /*                           RefDataset()                               */
 /************************************************************************/
@@ -75,6 +75,46 @@ void GDALRasterBand::Init(int bForceCachedIOIn)
 
     eFlushBlockErr = CE_None;
     poBandBlockCache = NULL;
+
+    ResetBlockCacheStats();
+}
+
+/************************************************************************/
+/*                         GetBlockCacheStats()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch block cache counters of this band.
+ *
+ * Hits and misses count GetLockedBlockRef() requests that did or did not
+ * find the block in the cache; bytes decoded counts the output of IReadBlock()
+ * for cache misses and ReadBlock() calls that succeeded. Evictions count
+ * blocks of this band dropped from the cache to make room for other blocks.
+ * The counters are updated with atomic operations, as blocks may be read
+ * from several threads.
+ */
+
+void GDALRasterBand::GetBlockCacheStats( GIntBig *pnHits, GIntBig *pnMisses,
+                                         GIntBig *pnEvictions, GIntBig *pnBytesDecoded )
+{
+    if( pnHits ) *pnHits = nBlockCacheHits;
+    if( pnMisses ) *pnMisses = nBlockCacheMisses;
+    if( pnEvictions ) *pnEvictions = nBlockCacheEvictions;
+    if( pnBytesDecoded )
+        *pnBytesDecoded = static_cast<GIntBig>(nBlocksDecoded) * nBlockXSize *
+                          nBlockYSize * GDALGetDataTypeSizeBytes(eDataType);
+}
+
+/************************************************************************/
+/*                        ResetBlockCacheStats()                        */
+/************************************************************************/
+
+void GDALRasterBand::ResetBlockCacheStats()
+{
+    nBlockCacheHits = 0;
+    nBlockCacheMisses = 0;
+    nBlockCacheEvictions = 0;
+    nBlocksDecoded = 0;
 }
 
 /************************************************************************/
@@ -472,6 +512,8 @@ CPLErr GDALRasterBand::ReadBlock( int nXBlockOff, int nYBlockOff,
     int bCallLeaveReadWrite = EnterReadWrite(GF_Read);
     CPLErr eErr = IReadBlock( nXBlockOff, nYBlockOff, pImage );
     if( bCallLeaveReadWrite) LeaveReadWrite();
+    if( eErr == CE_None )
+        CPLAtomicInc(&nBlocksDecoded);
     return eErr;
 }
 
@@ -1078,6 +1120,11 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
 /*      block (potentially load from disk) and "adopt" it into the      */
 /*      cache.                                                          */
 /* -------------------------------------------------------------------- */
+    if( poBlock != NULL )
+        CPLAtomicInc(&nBlockCacheHits);
+    else if( !bJustInitialize )
+        CPLAtomicInc(&nBlockCacheMisses);
+
     if( poBlock == NULL )
     {
         if( !InitBlockInfo() )
@@ -1153,6 +1200,7 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
 
         if( !bJustInitialize )
         {
+            CPLAtomicInc(&nBlocksDecoded);
             nBlockReads++;
             if( static_cast<GIntBig>(nBlockReads) == static_cast<GIntBig>(nBlocksPerRow) * nBlocksPerColumn + 1
                 && nBand == 1 && poDS != NULL )
@@ -876,6 +876,7 @@ CPLErr GDALRasterBlock::Internalize()
 
                     poTarget->Detach_unlocked();
                     poTarget->GetBand()->UnreferenceBlock(poTarget);
+                    CPLAtomicInc(&(poTarget->GetBand()->nBlockCacheEvictions));
 
                     apoBlocksToFree[nBlocksToFree++] = poTarget;
                     if( poTarget->GetDirty() )
@@ -58,6 +58,77 @@ if (process.env.GDAL_DATA === undefined) {
 	gdal.config.set('GDAL_DATA', data_path);
 }
 
+gdal.datasetCache = {};
+
+/**
+ * Opens a raster read-only through GDAL's shared pool of dataset handles.
+ *
+ * At most `GDAL_MAX_DATASET_POOL_SIZE` (default 100) files are kept open across
+ * all cached datasets; the least recently used handle is closed when the pool
+ * is full and reopened transparently the next time its dataset is accessed.
+ * Set the option before the first dataset is opened to change the limit.
+ *
+ * @example
+ * ```
+ * gdal.config.set('GDAL_MAX_DATASET_POOL_SIZE', '500');
+ * var dataset = gdal.datasetCache.open('tiles/1234.tif');```
+ *
+ * @for gdal
+ * @static
+ * @method datasetCache.open
+ * @throws Error
+ * @param {String} path
+ * @return {gdal.Dataset}
+ */
+gdal.datasetCache.open = gdal.openCached;
+
+/**
+ * Returns the usage counters of the dataset pool behind
+ * {{#crossLink "gdal/datasetCache.open:method"}}datasetCache.open(){{/crossLink}}.
+ *
+ * @for gdal
+ * @static
+ * @method datasetCache.stats
+ * @return {Object} `{hits, misses, evictions, open, max}`
+ */
+gdal.datasetCache.stats = gdal.getDatasetCacheStats;
+
+delete gdal.openCached;
+delete gdal.getDatasetCacheStats;
+
+gdal.blockCache = {};
+
+/**
+ * Returns the memory used by GDAL's raster block cache, shared by all datasets
+ * in the process. Per-dataset and per-band hit / miss counters are available
+ * from {{#crossLink "gdal.Dataset/getCacheStats:method"}}Dataset.getCacheStats(){{/crossLink}}
+ * and {{#crossLink "gdal.RasterBand/getCacheStats:method"}}RasterBand.getCacheStats(){{/crossLink}}.
+ *
+ * @for gdal
+ * @static
+ * @method blockCache.stats
+ * @return {Object} `{used, max}` in bytes
+ */
+gdal.blockCache.stats = gdal.getBlockCacheStats;
+
+/**
+ * Sets the maximum size of the raster block cache in bytes, overriding
+ * `GDAL_CACHEMAX`. Blocks over the new limit are flushed immediately.
+ *
+ * @example
+ * ```
+ * gdal.blockCache.setMax(512 * 1024 * 1024);```
+ *
+ * @for gdal
+ * @static
+ * @method blockCache.setMax
+ * @param {Number} bytes
+ */
+gdal.blockCache.setMax = gdal.setBlockCacheMax;
+
+delete gdal.getBlockCacheStats;
+delete gdal.setBlockCacheMax;
+
 gdal.Envelope = require('./envelope.js')(gdal);
 gdal.Envelope3D = require('./envelope_3d.js')(gdal);
 
@@ -652,24 +723,11 @@ gdal.DatasetLayers.prototype.create = (function() {
 	};
 })();
 
-function getTypedArrayType(array) {
-	if (array instanceof Uint8Array)   return 1; // gdal.GDT_Byte
-	if (array instanceof Int8Array)    return 1; // gdal.GDT_Byte
-	if (array instanceof Int16Array)   return 3; // gdal.GDT_Int16
-	if (array instanceof Uint16Array)  return 2; // gdal.GDT_UInt16
-	if (array instanceof Int32Array)   return 5; // gdal.GDT_Int32
-	if (array instanceof Uint32Array)  return 4; // gdal.GDT_UInt32
-	if (array instanceof Float32Array) return 6; // gdal.GDT_Float32
-	if (array instanceof Float64Array) return 7; // gdal.GDT_Float64
-	return 0; // gdal.GDT_Unknown
-}
-
 gdal.RasterBandPixels.prototype.read = (function() {
 	var read = gdal.RasterBandPixels.prototype.read;
 	return function(x, y, width, height, data, options) {
 		if (!options) options = {};
-		if (data) data._gdal_type = getTypedArrayType(data);
-		return read.apply(this, [x, y, width, height, data, options.buffer_width, options.buffer_height, options.type, options.pixel_space, options.line_space]);
+		return read.apply(this, [x, y, width, height, data, options.buffer_width, options.buffer_height, options.type, options.pixel_space, options.line_space, options.resampling]);
 	};
 })();
 
@@ -677,23 +735,890 @@ gdal.RasterBandPixels.prototype.write = (function() {
 	var write = gdal.RasterBandPixels.prototype.write;
 	return function(x, y, width, height, data, options) {
 		if (!options) options = {};
-		if (data) data._gdal_type = getTypedArrayType(data);
 		return write.apply(this, [x, y, width, height, data, options.buffer_width, options.buffer_height, options.pixel_space, options.line_space]);
 	};
 })();
 
-gdal.RasterBandPixels.prototype.readBlock = (function() {
-	var readBlock = gdal.RasterBandPixels.prototype.readBlock;
+gdal.DatasetPixels.prototype.read = (function() {
+	var read = gdal.DatasetPixels.prototype.read;
+	return function(x, y, width, height, data, options) {
+		if (!options) options = {};
+		return read.apply(this, [x, y, width, height, data, options.buffer_width, options.buffer_height, options.type, options.bands, options.interleave, options.pixel_space, options.line_space, options.band_space]);
+	};
+})();
+
+gdal.DatasetPixels.prototype.write = (function() {
+	var write = gdal.DatasetPixels.prototype.write;
+	return function(x, y, width, height, data, options) {
+		if (!options) options = {};
+		return write.apply(this, [x, y, width, height, data, options.buffer_width, options.buffer_height, null, options.bands, options.interleave, options.pixel_space, options.line_space, options.band_space]);
+	};
+})();
+
+// calls a native method taking a trailing node-style callback and returns a Promise
+function callAsync(method, self, args) {
+	return new Promise(function(resolve, reject) {
+		args.push(function(err, result) {
+			if (err) return reject(err);
+			resolve(result);
+		});
+		method.apply(self, args);
+	});
+}
+
+/**
+ * Reads a region of pixels without blocking the event loop. The read is
+ * performed on the libuv threadpool; async jobs on the same dataset are run
+ * one at a time in the order they were called, and closing the dataset is
+ * deferred until they complete.
+ *
+ * @example
+ * ```
+ * band.pixels.readAsync(0, 0, 256, 256).then(function(data) { ... });```
+ *
+ * @for gdal.RasterBandPixels
+ * @method readAsync
+ * @param {Number} x
+ * @param {Number} y
+ * @param {Number} width
+ * @param {Number} height
+ * @param {TypedArray} [data] The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) to put the data in. A new array is created if not given.
+ * @param {Object} [options] See {{#crossLink "gdal.RasterBandPixels/read:method"}}read(){{/crossLink}}.
+ * @return {Promise} Resolves with a [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values.
+ */
+gdal.RasterBandPixels.prototype.readAsync = (function() {
+	var readAsync = gdal.RasterBandPixels.prototype.readAsync;
+	return function(x, y, width, height, data, options) {
+		if (!options) options = {};
+		return callAsync(readAsync, this, [x, y, width, height, data, options.buffer_width, options.buffer_height, options.type, options.pixel_space, options.line_space, options.resampling]);
+	};
+})();
+
+/**
+ * Writes a region of pixels without blocking the event loop. The array must
+ * not be modified until the returned promise settles.
+ *
+ * @for gdal.RasterBandPixels
+ * @method writeAsync
+ * @param {Integer} x
+ * @param {Integer} y
+ * @param {Integer} width
+ * @param {Integer} height
+ * @param {TypedArray} data The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) to write to the band.
+ * @param {Object} [options] See {{#crossLink "gdal.RasterBandPixels/write:method"}}write(){{/crossLink}}.
+ * @return {Promise}
+ */
+gdal.RasterBandPixels.prototype.writeAsync = (function() {
+	var writeAsync = gdal.RasterBandPixels.prototype.writeAsync;
+	return function(x, y, width, height, data, options) {
+		if (!options) options = {};
+		return callAsync(writeAsync, this, [x, y, width, height, data, options.buffer_width, options.buffer_height, options.pixel_space, options.line_space]);
+	};
+})();
+
+/**
+ * Reads a block of pixels without blocking the event loop.
+ *
+ * @for gdal.RasterBandPixels
+ * @method readBlockAsync
+ * @param {Integer} x
+ * @param {Integer} y
+ * @param {TypedArray} [data] The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) to put the data in. A new array is created if not given.
+ * @return {Promise} Resolves with a [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values.
+ */
+gdal.RasterBandPixels.prototype.readBlockAsync = (function() {
+	var readBlockAsync = gdal.RasterBandPixels.prototype.readBlockAsync;
 	return function(x, y, data) {
-		if (data) data._gdal_type = getTypedArrayType(data);
-		return readBlock.apply(this, arguments);
+		return callAsync(readBlockAsync, this, [x, y, data]);
 	};
 })();
 
-gdal.RasterBandPixels.prototype.writeBlock = (function() {
-	var writeBlock = gdal.RasterBandPixels.prototype.writeBlock;
+/**
+ * Writes a block of pixels without blocking the event loop.
+ *
+ * @for gdal.RasterBandPixels
+ * @method writeBlockAsync
+ * @param {Integer} x
+ * @param {Integer} y
+ * @param {TypedArray} data The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values to write to the band.
+ * @return {Promise}
+ */
+gdal.RasterBandPixels.prototype.writeBlockAsync = (function() {
+	var writeBlockAsync = gdal.RasterBandPixels.prototype.writeBlockAsync;
 	return function(x, y, data) {
-		data._gdal_type = getTypedArrayType(data);
-		return writeBlock.apply(this, arguments);
+		return callAsync(writeBlockAsync, this, [x, y, data]);
+	};
+})();
+
+// block layout of a band, read once per iterator
+function blockLayout(band) {
+	var block_size = band.blockSize;
+	var size = band.size;
+	return {
+		block_size: block_size,
+		size: size,
+		blocks_x: Math.ceil(size.x / block_size.x),
+		blocks_y: Math.ceil(size.y / block_size.y)
+	};
+}
+
+// position and valid extent of the i-th block, in storage order (rows of blocks, left to right)
+function blockAt(layout, i) {
+	var block_size = layout.block_size;
+	var size = layout.size;
+	if (i >= layout.blocks_x * layout.blocks_y) return null;
+
+	var x = i % layout.blocks_x;
+	var y = Math.floor(i / layout.blocks_x);
+	return {
+		x: x,
+		y: y,
+		offset_x: x * block_size.x,
+		offset_y: y * block_size.y,
+		width: Math.min(block_size.x, size.x - x * block_size.x),
+		height: Math.min(block_size.y, size.y - y * block_size.y)
+	};
+}
+
+/**
+ * Returns an iterator over every block of the band, in the order they are
+ * stored. Each value is an object with the block position (`x`, `y`), its
+ * pixel offset (`offset_x`, `offset_y`), the valid `width` / `height` (smaller
+ * than the block size for edge blocks) and the block `data`, a full block-sized
+ * array with rows `band.blockSize.x` values apart.
+ *
+ * @example
+ * ```
+ * var it = band.pixels.blocks(), step;
+ * while (!(step = it.next()).done) {
+ *     process(step.value.data);
+ * }
+ *
+ * for (var block of band.pixels.blocks()) { ... }```
+ *
+ * @for gdal.RasterBandPixels
+ * @method blocks
+ * @return {Object} An iterator
+ */
+gdal.RasterBandPixels.prototype.blocks = function() {
+	var pixels = this;
+	var layout = blockLayout(this.band);
+	var i = 0;
+
+	var iterator = {
+		next: function() {
+			var block = blockAt(layout, i);
+			if (!block) return {value: undefined, done: true};
+			i++;
+			block.data = pixels.readBlock(block.x, block.y);
+			return {value: block, done: false};
+		}
+	};
+	if (typeof Symbol !== 'undefined' && Symbol.iterator) {
+		iterator[Symbol.iterator] = function() { return this; };
+	}
+	return iterator;
+};
+
+/**
+ * Returns an async iterator over every block of the band, in the order they
+ * are stored. The next `prefetch` blocks are read and decoded on the libuv
+ * threadpool while the current one is being processed.
+ *
+ * Values are the same as {{#crossLink "gdal.RasterBandPixels/blocks:method"}}blocks(){{/crossLink}}.
+ *
+ * @example
+ * ```
+ * var it = band.pixels.blocksAsync({prefetch: 4});
+ * function step() {
+ *     return it.next().then(function(result) {
+ *         if (result.done) return;
+ *         process(result.value.data);
+ *         return step();
+ *     });
+ * }
+ *
+ * for await (const block of band.pixels.blocksAsync()) { ... }```
+ *
+ * @for gdal.RasterBandPixels
+ * @method blocksAsync
+ * @param {Object} [options]
+ * @param {Integer} [options.prefetch=2] Number of blocks to read ahead.
+ * @return {Object} An async iterator
+ */
+gdal.RasterBandPixels.prototype.blocksAsync = function(options) {
+	options = options || {};
+	var pixels = this;
+	var layout = blockLayout(this.band);
+	var prefetch = options.prefetch === undefined ? 2 : options.prefetch;
+	var i = 0;
+	var queue = [];
+
+	if (typeof prefetch !== 'number' || prefetch < 0) {
+		throw new RangeError('prefetch must be a non-negative number');
+	}
+
+	// starts reading the next block, returns null past the last one
+	var take = function() {
+		var block = blockAt(layout, i);
+		if (!block) return null;
+		i++;
+		var result = pixels.readBlockAsync(block.x, block.y).then(function(data) {
+			block.data = data;
+			return {value: block, done: false};
+		});
+		// errors surface when the block is reached, not while it's queued
+		result.catch(function() {});
+		return result;
+	};
+	var fill = function() {
+		while (queue.length < prefetch) {
+			var result = take();
+			if (!result) return;
+			queue.push(result);
+		}
+	};
+
+	var iterator = {
+		next: function() {
+			var result = queue.length ? queue.shift() : take();
+			fill();
+			return result || Promise.resolve({value: undefined, done: true});
+		}
+	};
+	if (typeof Symbol !== 'undefined' && Symbol.asyncIterator) {
+		iterator[Symbol.asyncIterator] = function() { return this; };
+	}
+	return iterator;
+};
+
+require('./pixel_streams.js')(gdal);
+
+/**
+ * Reads a region of pixels from several bands without blocking the event loop.
+ *
+ * @for gdal.DatasetPixels
+ * @method readAsync
+ * @param {Integer} x
+ * @param {Integer} y
+ * @param {Integer} width
+ * @param {Integer} height
+ * @param {TypedArray} [data] The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) to put the data in. A new array is created if not given.
+ * @param {Object} [options] See {{#crossLink "gdal.DatasetPixels/read:method"}}read(){{/crossLink}}.
+ * @return {Promise} Resolves with a [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values.
+ */
+gdal.DatasetPixels.prototype.readAsync = (function() {
+	var readAsync = gdal.DatasetPixels.prototype.readAsync;
+	return function(x, y, width, height, data, options) {
+		if (!options) options = {};
+		return callAsync(readAsync, this, [x, y, width, height, data, options.buffer_width, options.buffer_height, options.type, options.bands, options.interleave, options.pixel_space, options.line_space, options.band_space]);
+	};
+})();
+
+/**
+ * Writes a region of pixels to several bands without blocking the event loop.
+ * The array must not be modified until the returned promise settles.
+ *
+ * @for gdal.DatasetPixels
+ * @method writeAsync
+ * @param {Integer} x
+ * @param {Integer} y
+ * @param {Integer} width
+ * @param {Integer} height
+ * @param {TypedArray} data
+ * @param {Object} [options] See {{#crossLink "gdal.DatasetPixels/write:method"}}write(){{/crossLink}}.
+ * @return {Promise}
+ */
+gdal.DatasetPixels.prototype.writeAsync = (function() {
+	var writeAsync = gdal.DatasetPixels.prototype.writeAsync;
+	return function(x, y, width, height, data, options) {
+		if (!options) options = {};
+		return callAsync(writeAsync, this, [x, y, width, height, data, options.buffer_width, options.buffer_height, null, options.bands, options.interleave, options.pixel_space, options.line_space, options.band_space]);
+	};
+})();
+
+/**
+ * Opens a dataset without blocking the event loop. Driver probing and header
+ * parsing are performed on the libuv threadpool.
+ *
+ * @example
+ * ```
+ * gdal.openAsync('./data.tif').then(function(dataset) { ... });```
+ *
+ * @for gdal
+ * @method openAsync
+ * @static
+ * @param {String} path Path to dataset to open
+ * @param {String} [mode="r"] The mode to use to open the file: `"r"` or `"r+"`
+ * @param {String|Array} [drivers] Driver name, or list of driver names to attempt to use.
+ * @return {Promise} Resolves with a {{#crossLink "gdal.Dataset"}}Dataset{{/crossLink}}
+ */
+gdal.openAsync = (function() {
+	var openAsync = gdal.openAsync;
+
+	return function(filename, mode, drivers) {
+		mode = mode || 'r';
+		if (typeof drivers === 'string') {
+			drivers = [drivers];
+		} else if (drivers && !Array.isArray(drivers)) {
+			return Promise.reject(new Error('driver(s) must be a string or list of strings'));
+		}
+
+		if (!drivers) {
+			return callAsync(openAsync, gdal, [filename, mode]);
+		}
+
+		// try each driver in turn until one of them opens the file
+		var i = 0;
+		var next = function() {
+			if (i >= drivers.length) return Promise.reject(new Error('Error opening dataset'));
+			var driver_name = drivers[i++];
+			var driver = gdal.drivers.get(driver_name);
+			if (!driver) return Promise.reject(new Error('Cannot find driver: ' + driver_name));
+			return driver.openAsync(filename, mode).catch(next);
+		};
+		return next();
+	};
+})();
+
+/**
+ * Opens a dataset without blocking the event loop.
+ *
+ * @for gdal.Driver
+ * @method openAsync
+ * @param {String} path
+ * @param {String} [mode=`"r"`] The mode to use to open the file: `"r"` or `"r+"`
+ * @return {Promise} Resolves with a {{#crossLink "gdal.Dataset"}}Dataset{{/crossLink}}
+ */
+gdal.Driver.prototype.openAsync = (function() {
+	var openAsync = gdal.Driver.prototype.openAsync;
+	return function(path, mode) {
+		return callAsync(openAsync, this, [path, mode]);
+	};
+})();
+
+/**
+ * Opens a raster read-only with several independent handles to the same file.
+ *
+ * The result is a regular {{#crossLink "gdal.Dataset"}}Dataset{{/crossLink}},
+ * but `readAsync()` / `readBlockAsync()` on its bands are dispatched to whichever
+ * handle is free, so concurrent reads of one file run in parallel on the libuv
+ * threadpool instead of queuing behind a single GDAL handle. Other methods use
+ * the dataset's own handle. The extra handles are opened on the threadpool by
+ * the first reads that need them, and all of them are closed with the dataset.
+ *
+ * @example
+ * ```
+ * var dataset = gdal.openPool('./hot.tif', {size: 4});
+ * var band = dataset.bands.get(1);
+ * Promise.all(tiles.map(function(t) {
+ *     return band.pixels.readAsync(t.x, t.y, 256, 256);
+ * }));```
+ *
+ * @for gdal
+ * @method openPool
+ * @static
+ * @throws Error
+ * @param {String} path Path to the raster to open
+ * @param {Object} [options]
+ * @param {Integer} [options.size] Number of extra handles to keep open for async reads. Defaults to the number of CPUs.
+ * @return {gdal.Dataset}
+ */
+gdal.openPool = (function() {
+	var openPool = gdal.openPool;
+	return function(path, options) {
+		options = options || {};
+		var size = options.size === undefined ? require('os').cpus().length : options.size;
+		return openPool(path, size);
+	};
+})();
+
+/**
+ * Opens a dataset from the contents of a Buffer without copying it.
+ *
+ * The Buffer's memory is exposed to GDAL as a `/vsimem/` file and is kept
+ * alive until the dataset is closed, when the file is removed. The dataset is
+ * read-only, and the Buffer must not be modified while it is open. The file
+ * can't be opened again, with `gdal.open()`, a driver's `open()` or
+ * `gdal.buildVRT()`, as nothing would keep the Buffer alive for the other
+ * handle.
+ *
+ * @example
+ * ```
+ * var dataset = gdal.openBuffer(fs.readFileSync('./tile.png'), 'tile.png');```
+ *
+ * @for gdal
+ * @method openBuffer
+ * @static
+ * @throws Error
+ * @param {Buffer} buffer Contents of the file to open
+ * @param {String} [hint] File name or extension (e.g. `".geojson"`) for drivers that identify files by their extension
+ * @return {gdal.Dataset}
+ */
+
+/**
+ * A token used to abort a long-running async operation. Pass it in the
+ * `cancelToken` option and call `cancel()` to stop the operation at its next
+ * progress checkpoint; the returned Promise is then rejected with an
+ * "Operation cancelled" error.
+ *
+ * @example
+ * ```
+ * var token = new gdal.CancelToken();
+ * driver.createCopyAsync('copy.tif', dataset, {cancelToken: token});
+ * token.cancel();```
+ *
+ * @class gdal.CancelToken
+ * @constructor
+ */
+gdal.CancelToken = function() {
+	// shared with the worker thread, which polls it from the GDAL progress callback
+	this._flag = new Int32Array(1);
+};
+
+/**
+ * Requests cancellation of every operation using this token.
+ *
+ * @method cancel
+ */
+gdal.CancelToken.prototype.cancel = function() {
+	this._flag[0] = 1;
+};
+
+/**
+ * Whether `cancel()` has been called.
+ *
+ * @attribute cancelled
+ * @type {Boolean}
+ */
+Object.defineProperty(gdal.CancelToken.prototype, 'cancelled', {
+	get: function() { return this._flag[0] !== 0; }
+});
+
+// pulls the progress callback / cancel token arguments for native async methods out of an options object
+function progressArgs(options) {
+	options = options || {};
+	if (options.cancelToken && !(options.cancelToken instanceof gdal.CancelToken)) {
+		throw new TypeError('cancelToken must be a gdal.CancelToken');
+	}
+	return [options.progress || null, options.cancelToken ? options.cancelToken._flag : null];
+}
+
+/**
+ * Creates a copy of a dataset without blocking the event loop. The copy is
+ * performed on the libuv threadpool and the source dataset is locked against
+ * other async operations until it completes.
+ *
+ * @example
+ * ```
+ * var token = new gdal.CancelToken();
+ * driver.createCopyAsync('copy.tif', dataset, ['COMPRESS=LZW'], {
+ *     progress: function(ratio) { console.log(Math.round(ratio * 100) + '%'); },
+ *     cancelToken: token
+ * }).then(function(copy) { ... });```
+ *
+ * @for gdal.Driver
+ * @method createCopyAsync
+ * @param {String} filename
+ * @param {gdal.Dataset} src
+ * @param {String[]|object} [options=null] An array or object containing driver-specific dataset creation options
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1 as the copy proceeds. Calls are throttled and delivered on the event loop.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise} Resolves with the new {{#crossLink "gdal.Dataset"}}Dataset{{/crossLink}}
+ */
+gdal.Driver.prototype.createCopyAsync = (function() {
+	var createCopyAsync = gdal.Driver.prototype.createCopyAsync;
+	return function(filename, src, options, async_options) {
+		var args;
+		try {
+			args = [filename, src, options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(createCopyAsync, this, args);
+	};
+})();
+
+/**
+ * Encodes a dataset into a Buffer without blocking the event loop. The
+ * source dataset is locked against other async operations until the
+ * encoding completes.
+ *
+ * @example
+ * ```
+ * gdal.drivers.get('PNG').encodeAsync(tile).then(function(png) {
+ *     response.end(png);
+ * });```
+ *
+ * @for gdal.Driver
+ * @method encodeAsync
+ * @param {gdal.Dataset} src
+ * @param {String[]|object} [options=null] An array or object containing driver-specific dataset creation options
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise} Resolves with a Buffer holding the encoded file.
+ */
+gdal.Driver.prototype.encodeAsync = (function() {
+	var encodeAsync = gdal.Driver.prototype.encodeAsync;
+	return function(src, options, async_options) {
+		var args;
+		try {
+			args = [src, options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(encodeAsync, this, args);
+	};
+})();
+
+/**
+ * Reprojects a dataset without blocking the event loop. The whole warp
+ * (transformer setup, chunking and the warp kernel) runs on the libuv
+ * threadpool, and both datasets are locked against other async operations
+ * until it completes.
+ *
+ * @example
+ * ```
+ * gdal.reprojectImageAsync({src: src, dst: dst, s_srs: src.srs, t_srs: dst.srs}, {
+ *     progress: function(ratio) { ... }
+ * }).then(function() { ... });```
+ *
+ * @for gdal
+ * @method reprojectImageAsync
+ * @static
+ * @param {object} options See {{#crossLink "gdal/reprojectImage:method"}}reprojectImage(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1 as the warp proceeds.
+ * @param {gdal.CancelToken} [async_options.cancelToken] Aborts the warp at the next scanline.
+ * @return {Promise}
+ */
+gdal.reprojectImageAsync = (function() {
+	var reprojectImageAsync = gdal.reprojectImageAsync;
+	return function(options, async_options) {
+		var args;
+		try {
+			args = [options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(reprojectImageAsync, gdal, args);
+	};
+})();
+
+/**
+ * Renders a tile pyramid without blocking the event loop. Tiles are rendered
+ * by a pool of native threads while the source dataset is locked against
+ * other async operations.
+ *
+ * @example
+ * ```
+ * gdal.generateTilesAsync(ds, {dir: 'tiles', maxZoom: 12}, {
+ *     progress: function(ratio) { ... }
+ * }).then(function(result) { ... });```
+ *
+ * @for gdal
+ * @method generateTilesAsync
+ * @static
+ * @param {gdal.Dataset} src
+ * @param {Object} options See {{#crossLink "gdal/generateTiles:method"}}generateTiles(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with the ratio of tiles done.
+ * @param {gdal.CancelToken} [async_options.cancelToken] Stops rendering after the tiles in progress.
+ * @return {Promise} Resolves with an object with the number of tiles `written` and `skipped`.
+ */
+gdal.generateTilesAsync = (function() {
+	var generateTilesAsync = gdal.generateTilesAsync;
+	return function(src, options, async_options) {
+		var args;
+		try {
+			args = [src, options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(generateTilesAsync, gdal, args);
+	};
+})();
+
+// wraps a native async algorithm taking (options, progress, cancel_flag, callback)
+function wrapAlgorithmAsync(method) {
+	return function(options, async_options) {
+		var args;
+		try {
+			args = [options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(method, gdal, args);
+	};
+}
+
+/**
+ * Fills raster regions by interpolation from edges without blocking the
+ * event loop. The datasets involved are locked against other async
+ * operations, and the bands are kept alive, until the job completes.
+ *
+ * @for gdal
+ * @method fillNodataAsync
+ * @static
+ * @param {Object} options See {{#crossLink "gdal/fillNodata:method"}}fillNodata(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise}
+ */
+gdal.fillNodataAsync = wrapAlgorithmAsync(gdal.fillNodataAsync);
+
+/**
+ * Creates vector contours from a raster DEM without blocking the event loop.
+ *
+ * @for gdal
+ * @method contourGenerateAsync
+ * @static
+ * @param {Object} options See {{#crossLink "gdal/contourGenerate:method"}}contourGenerate(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise}
+ */
+gdal.contourGenerateAsync = wrapAlgorithmAsync(gdal.contourGenerateAsync);
+
+/**
+ * Removes small raster polygons without blocking the event loop.
+ *
+ * @for gdal
+ * @method sieveFilterAsync
+ * @static
+ * @param {Object} options See {{#crossLink "gdal/sieveFilter:method"}}sieveFilter(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise}
+ */
+gdal.sieveFilterAsync = wrapAlgorithmAsync(gdal.sieveFilterAsync);
+
+/**
+ * Creates vector polygons for all connected regions of pixels sharing a
+ * common value without blocking the event loop.
+ *
+ * @for gdal
+ * @method polygonizeAsync
+ * @static
+ * @param {Object} options See {{#crossLink "gdal/polygonize:method"}}polygonize(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise}
+ */
+gdal.polygonizeAsync = wrapAlgorithmAsync(gdal.polygonizeAsync);
+
+/**
+ * Evaluates a band-math expression without blocking the event loop. The
+ * expression is still evaluated on several threads; the datasets involved are
+ * locked against other async operations until the job completes.
+ *
+ * @for gdal
+ * @method calcAsync
+ * @static
+ * @param {Object} options See {{#crossLink "gdal/calc:method"}}calc(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken] Aborts the job at the next chunk of scanlines.
+ * @return {Promise}
+ */
+gdal.calcAsync = wrapAlgorithmAsync(gdal.calcAsync);
+
+/**
+ * Computes per-feature raster statistics without blocking the event loop.
+ * The layer's and band's datasets are locked against other async operations
+ * until the job completes.
+ *
+ * @for gdal
+ * @method zonalStatsAsync
+ * @static
+ * @param {gdal.Layer} layer
+ * @param {gdal.RasterBand} band
+ * @param {Object} [options] See {{#crossLink "gdal/zonalStats:method"}}zonalStats(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise} Resolves with the same array as zonalStats().
+ */
+gdal.zonalStatsAsync = (function() {
+	var zonalStatsAsync = gdal.zonalStatsAsync;
+	return function(layer, band, options, async_options) {
+		var args;
+		try {
+			args = [layer, band, options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(zonalStatsAsync, gdal, args);
+	};
+})();
+
+/**
+ * Builds a VRT mosaic of raster files without blocking the event loop. The
+ * files' headers are still read on several threads.
+ *
+ * @for gdal
+ * @method buildVRTAsync
+ * @static
+ * @param {String[]} files
+ * @param {Object} [options] See {{#crossLink "gdal/buildVRT:method"}}buildVRT(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with the ratio of headers read.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise} Resolves with the mosaic {{#crossLink "gdal.Dataset"}}Dataset{{/crossLink}}.
+ */
+gdal.buildVRTAsync = (function() {
+	var buildVRTAsync = gdal.buildVRTAsync;
+	return function(files, options, async_options) {
+		var args;
+		try {
+			args = [files, options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(buildVRTAsync, gdal, args);
+	};
+})();
+
+/**
+ * Computes a checksum for an image region without blocking the event loop.
+ * GDAL reports no progress for checksums, so a cancel token only takes
+ * effect if the job hasn't started yet.
+ *
+ * @for gdal
+ * @method checksumImageAsync
+ * @static
+ * @param {gdal.RasterBand} src
+ * @param {integer} [x=0]
+ * @param {integer} [y=0]
+ * @param {integer} [w=src.width]
+ * @param {integer} [h=src.height]
+ * @param {Object} [async_options]
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise} Resolves with the checksum
+ */
+gdal.checksumImageAsync = (function() {
+	var checksumImageAsync = gdal.checksumImageAsync;
+	return function(src, x, y, w, h, async_options) {
+		var args;
+		try {
+			args = [src, x, y, w, h].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(checksumImageAsync, gdal, args);
+	};
+})();
+
+/**
+ * Builds dataset overviews without blocking the event loop. The dataset is
+ * locked against other async operations until the build completes.
+ *
+ * With `concurrent: true` the levels of each band are resampled on separate
+ * threads. Driver I/O is still serialized, so this helps most with expensive
+ * resampling (`"AVERAGE"`, `"GAUSS"`, `"CUBIC"`...) on multi-band datasets.
+ * Bands with nodata values or masks are always built sequentially.
+ *
+ * @for gdal.Dataset
+ * @method buildOverviewsAsync
+ * @param {String} resampling `"NEAREST"`, `"GAUSS"`, `"CUBIC"`, `"AVERAGE"`, `"MODE"`, `"AVERAGE_MAGPHASE"` or `"NONE"`
+ * @param {Integer[]} overviews
+ * @param {Integer[]} [bands]
+ * @param {Object} [async_options]
+ * @param {Boolean} [async_options.concurrent=false] Build the overviews of each band on a separate thread.
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise}
+ */
+gdal.Dataset.prototype.buildOverviewsAsync = (function() {
+	var buildOverviewsAsync = gdal.Dataset.prototype.buildOverviewsAsync;
+	return function(resampling, overviews, bands, async_options) {
+		var args;
+		try {
+			args = [resampling, overviews, bands, !!(async_options && async_options.concurrent)].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(buildOverviewsAsync, this, args);
+	};
+})();
+
+/**
+ * Computes a histogram of the band without blocking the event loop. The scan
+ * itself still runs on several threads, and the dataset is locked against
+ * other async operations until it completes.
+ *
+ * @for gdal.RasterBand
+ * @method getHistogramAsync
+ * @param {Object} [options] See {{#crossLink "gdal.RasterBand/getHistogram:method"}}getHistogram(){{/crossLink}}.
+ * @param {Object} [async_options]
+ * @param {Function} [async_options.progress] Called with a ratio between 0 and 1.
+ * @param {gdal.CancelToken} [async_options.cancelToken]
+ * @return {Promise} Resolves with the same object as getHistogram().
+ */
+gdal.RasterBand.prototype.getHistogramAsync = (function() {
+	var getHistogramAsync = gdal.RasterBand.prototype.getHistogramAsync;
+	return function(options, async_options) {
+		var args;
+		try {
+			args = [options].concat(progressArgs(async_options));
+		} catch (err) {
+			return Promise.reject(err);
+		}
+		return callAsync(getHistogramAsync, this, args);
+	};
+})();
+
+/**
+ * Reads up to `n` features without blocking the event loop, continuing from
+ * the same position as {{#crossLink "gdal.LayerFeatures/next:method"}}next(){{/crossLink}}.
+ * The reads are done on the libuv threadpool and returned together.
+ *
+ * @example
+ * ```
+ * function scan() {
+ *     return layer.features.nextBatchAsync(1000).then(function(features) {
+ *         if (!features.length) return;
+ *         features.forEach(function(feature) { ... });
+ *         return scan();
+ *     });
+ * }```
+ *
+ * @for gdal.LayerFeatures
+ * @method nextBatchAsync
+ * @param {Integer} n Maximum number of features to read
+ * @return {Promise} Resolves with an array of {{#crossLink "gdal.Feature"}}Features{{/crossLink}}. The array is empty once all features have been read. If reading a feature fails, rejects with an error whose `features` property holds the features read before it.
+ */
+gdal.LayerFeatures.prototype.nextBatchAsync = (function() {
+	var nextBatchAsync = gdal.LayerFeatures.prototype.nextBatchAsync;
+	return function(n) {
+		return callAsync(nextBatchAsync, this, [n]);
+	};
+})();
+
+/**
+ * Executes an SQL statement against the data store without blocking the
+ * event loop. The query runs on the libuv threadpool with the dataset locked
+ * against other async operations.
+ *
+ * The resulting layer is a result set owned by the dataset, exactly as with
+ * {{#crossLink "gdal.Dataset/executeSQL:method"}}executeSQL(){{/crossLink}}.
+ *
+ * @for gdal.Dataset
+ * @method executeSQLAsync
+ * @param {String} statement SQL statement to execute.
+ * @param {gdal.Geometry} [spatial_filter=null] Geometry which represents a spatial filter.
+ * @param {String} [dialect=null] See {{#crossLink "gdal.Dataset/executeSQL:method"}}executeSQL(){{/crossLink}}.
+ * @return {Promise} Resolves with a {{#crossLink "gdal.Layer"}}Layer{{/crossLink}}
+ */
+gdal.Dataset.prototype.executeSQLAsync = (function() {
+	var executeSQLAsync = gdal.Dataset.prototype.executeSQLAsync;
+	return function(statement, spatial_filter, dialect) {
+		return callAsync(executeSQLAsync, this, [statement, spatial_filter, dialect]);
 	};
 })();
@@ -0,0 +1,289 @@
+var stream = require('stream');
+var util = require('util');
+
+module.exports = function(gdal) {
+	var ARRAY_TYPES = {
+		'Byte': Uint8Array,
+		'Int16': Int16Array,
+		'UInt16': Uint16Array,
+		'Int32': Int32Array,
+		'UInt32': Uint32Array,
+		'Float32': Float32Array,
+		'Float64': Float64Array
+	};
+
+	function getWindow(band, window) {
+		var size = band.size;
+		window = window || {};
+		var x = window.x || 0;
+		var y = window.y || 0;
+		var result = {
+			x: x,
+			y: y,
+			width: window.width === undefined ? size.x - x : window.width,
+			height: window.height === undefined ? size.y - y : window.height
+		};
+		if (result.x < 0 || result.y < 0 || result.width < 1 || result.height < 1 ||
+			result.x + result.width > size.x || result.y + result.height > size.y) {
+			throw new RangeError('window must lie within the band');
+		}
+		return result;
+	}
+
+	/**
+	 * A readable object stream of the tiles covering a window of a band, read
+	 * with {{#crossLink "gdal.RasterBandPixels/readAsync:method"}}readAsync(){{/crossLink}}.
+	 * Create one with {{#crossLink "gdal.RasterBandPixels/createReadStream:method"}}createReadStream(){{/crossLink}}.
+	 *
+	 * Each chunk is an object with the tile's `x`, `y`, `width`, `height` (in band
+	 * pixels, edge tiles are clipped to the window) and its `data`.
+	 *
+	 * @class gdal.RasterReadStream
+	 * @extends stream.Readable
+	 */
+	function RasterReadStream(pixels, options) {
+		options = options || {};
+		stream.Readable.call(this, {objectMode: true, highWaterMark: options.highWaterMark || 4});
+
+		var band = pixels.band;
+		var tile_size = options.tileSize || band.blockSize;
+
+		this._pixels = pixels;
+		this._window = getWindow(band, options.window);
+		this._tile_size = {x: tile_size.x, y: tile_size.y};
+		this._data_type = options.type;
+		this._next = {x: 0, y: 0};
+		this._reading = false;
+	}
+	util.inherits(RasterReadStream, stream.Readable);
+
+	RasterReadStream.prototype._read = function() {
+		if (this._reading) return;
+
+		var window = this._window;
+		var tile = this._next;
+		if (tile.y >= window.height) {
+			this.push(null);
+			return;
+		}
+
+		var x = window.x + tile.x;
+		var y = window.y + tile.y;
+		var width = Math.min(this._tile_size.x, window.width - tile.x);
+		var height = Math.min(this._tile_size.y, window.height - tile.y);
+
+		tile.x += this._tile_size.x;
+		if (tile.x >= window.width) {
+			tile.x = 0;
+			tile.y += this._tile_size.y;
+		}
+
+		var self = this;
+		this._reading = true;
+		this._pixels.readAsync(x, y, width, height, null, {type: this._data_type}).then(function(data) {
+			self._reading = false;
+			if (self.push({x: x, y: y, width: width, height: height, data: data})) {
+				self._read();
+			}
+		}, function(err) {
+			self._reading = false;
+			self.emit('error', err);
+		});
+	};
+
+	/**
+	 * A writable object stream of tiles (`{x, y, width, height, data}` in band
+	 * pixels) to write to a band. Create one with
+	 * {{#crossLink "gdal.RasterBandPixels/createWriteStream:method"}}createWriteStream(){{/crossLink}}.
+	 *
+	 * Tiles may arrive in any order and needn't line up with blocks: they are
+	 * copied into block buffers and each block is written with
+	 * {{#crossLink "gdal.RasterBandPixels/writeBlockAsync:method"}}writeBlockAsync(){{/crossLink}}
+	 * as soon as it is complete, so compressed formats never have to re-read and
+	 * recompress a partially written block. Blocks that are still incomplete
+	 * when the stream ends are merged with the band's existing contents (read
+	 * with {{#crossLink "gdal.RasterBandPixels/readBlockAsync:method"}}readBlockAsync(){{/crossLink}})
+	 * before being written, and `'finish'` (and `'close'`) are only emitted once
+	 * they are, so the dataset can be closed in a `stream.pipeline()` callback.
+	 *
+	 * @class gdal.RasterWriteStream
+	 * @extends stream.Writable
+	 */
+	function RasterWriteStream(pixels, options) {
+		options = options || {};
+		stream.Writable.call(this, {objectMode: true, highWaterMark: options.highWaterMark || 4});
+
+		var band = pixels.band;
+		var ArrayType = ARRAY_TYPES[band.dataType];
+		if (!ArrayType) throw new Error('Unsupported band data type: ' + band.dataType);
+
+		this._pixels = pixels;
+		this._array_type = ArrayType;
+		this._size = band.size;
+		this._block_size = band.blockSize;
+		this._blocks_x = Math.ceil(this._size.x / this._block_size.x);
+		this._blocks_y = Math.ceil(this._size.y / this._block_size.y);
+		this._blocks = {};
+		this._flushed = false;
+	}
+	util.inherits(RasterWriteStream, stream.Writable);
+
+	RasterWriteStream.prototype._getBlock = function(i) {
+		var block = this._blocks[i];
+		if (block) return block;
+
+		var bs = this._block_size;
+		var bx = i % this._blocks_x;
+		var by = Math.floor(i / this._blocks_x);
+		var width = Math.min(bs.x, this._size.x - bx * bs.x);
+		var height = Math.min(bs.y, this._size.y - by * bs.y);
+
+		block = this._blocks[i] = {
+			x: bx,
+			y: by,
+			data: new this._array_type(bs.x * bs.y),
+			written: new Uint8Array(bs.x * bs.y),
+			remaining: width * height
+		};
+		return block;
+	};
+
+	// copies a tile into the blocks it overlaps, returns the blocks it completed
+	RasterWriteStream.prototype._copyTile = function(tile) {
+		var bs = this._block_size;
+		var x0 = tile.x, y0 = tile.y;
+		var x1 = tile.x + tile.width, y1 = tile.y + tile.height;
+		var complete = [];
+
+		for (var by = Math.floor(y0 / bs.y); by * bs.y < y1; by++) {
+			for (var bx = Math.floor(x0 / bs.x); bx * bs.x < x1; bx++) {
+				var i = by * this._blocks_x + bx;
+				var block = this._getBlock(i);
+				var left = Math.max(x0, bx * bs.x), right = Math.min(x1, (bx + 1) * bs.x);
+				var top = Math.max(y0, by * bs.y), bottom = Math.min(y1, (by + 1) * bs.y);
+
+				for (var y = top; y < bottom; y++) {
+					var src = (y - y0) * tile.width + (left - x0);
+					var dst = (y - by * bs.y) * bs.x + (left - bx * bs.x);
+					for (var x = left; x < right; x++, src++, dst++) {
+						block.data[dst] = tile.data[src];
+						if (!block.written[dst]) {
+							block.written[dst] = 1;
+							block.remaining--;
+						}
+					}
+				}
+				if (block.remaining === 0) complete.push(i);
+			}
+		}
+		return complete;
+	};
+
+	RasterWriteStream.prototype._writeBlock = function(i) {
+		var block = this._blocks[i];
+		delete this._blocks[i];
+		return this._pixels.writeBlockAsync(block.x, block.y, block.data);
+	};
+
+	RasterWriteStream.prototype._writeBlocks = function(blocks) {
+		var self = this;
+		return blocks.reduce(function(prev, i) {
+			return prev.then(function() { return self._writeBlock(i); });
+		}, Promise.resolve());
+	};
+
+	RasterWriteStream.prototype._write = function(tile, encoding, callback) {
+		if (!tile || !tile.data || tile.x < 0 || tile.y < 0 ||
+			tile.x + tile.width > this._size.x || tile.y + tile.height > this._size.y) {
+			return callback(new RangeError('tile must lie within the band'));
+		}
+		if (tile.data.length < tile.width * tile.height) {
+			return callback(new RangeError('tile data is smaller than width * height'));
+		}
+
+		this._writeBlocks(this._copyTile(tile)).then(function() { callback(); }, callback);
+	};
+
+	// merges the incomplete blocks with the band's pixels and writes them
+	RasterWriteStream.prototype._flushPending = function() {
+		var self = this;
+		var pending = Object.keys(this._blocks).map(Number).sort(function(a, b) { return a - b; });
+
+		return pending.reduce(function(prev, i) {
+			return prev.then(function() {
+				var block = self._blocks[i];
+				return self._pixels.readBlockAsync(block.x, block.y).then(function(existing) {
+					for (var j = 0; j < block.data.length; j++) {
+						if (!block.written[j]) block.data[j] = existing[j];
+					}
+					return self._writeBlock(i);
+				});
+			});
+		}, Promise.resolve());
+	};
+
+	// writes the incomplete blocks before 'finish' and 'close', so that the
+	// callbacks of stream.pipeline() and stream.finished() run after them
+	RasterWriteStream.prototype._final = function(callback) {
+		this._flushPending().then(function() { callback(); }, callback);
+	};
+
+	// Node < 8 never calls _final(): hold back 'finish', which is emitted once
+	// every _write() has called back, until the incomplete blocks are written
+	if (parseInt(process.versions.node, 10) < 8) {
+		RasterWriteStream.prototype.emit = function(event) {
+			if (event !== 'finish' || this._flushed) {
+				return stream.Writable.prototype.emit.apply(this, arguments);
+			}
+
+			var self = this;
+			var args = arguments;
+			this._flushed = true;
+			this._flushPending().then(function() {
+				stream.Writable.prototype.emit.apply(self, args);
+			}, function(err) {
+				self.emit('error', err);
+			});
+			return true;
+		};
+	}
+
+	/**
+	 * Creates a readable object stream of the tiles covering a window of the band.
+	 *
+	 * @example
+	 * ```
+	 * band.pixels.createReadStream({tileSize: {x: 512, y: 512}})
+	 *     .pipe(transform)
+	 *     .pipe(output.bands.get(1).pixels.createWriteStream());```
+	 *
+	 * @for gdal.RasterBandPixels
+	 * @method createReadStream
+	 * @param {Object} [options]
+	 * @param {Object} [options.window] `{x, y, width, height}`, the whole band by default.
+	 * @param {Object} [options.tileSize] `{x, y}`, the block size by default.
+	 * @param {String} [options.type] See {{#crossLink "Constants (GDT)"}}GDT constants{{/crossLink}}.
+	 * @param {Integer} [options.highWaterMark=4] Number of tiles to buffer.
+	 * @return {gdal.RasterReadStream}
+	 */
+	gdal.RasterBandPixels.prototype.createReadStream = function(options) {
+		return new RasterReadStream(this, options);
+	};
+
+	/**
+	 * Creates a writable object stream of tiles to write to the band, flushed
+	 * in whole blocks as soon as they are complete.
+	 *
+	 * @for gdal.RasterBandPixels
+	 * @method createWriteStream
+	 * @param {Object} [options]
+	 * @param {Integer} [options.highWaterMark=4] Number of tiles to buffer.
+	 * @return {gdal.RasterWriteStream}
+	 */
+	gdal.RasterBandPixels.prototype.createWriteStream = function(options) {
+		return new RasterWriteStream(this, options);
+	};
+
+	gdal.RasterReadStream = RasterReadStream;
+	gdal.RasterWriteStream = RasterWriteStream;
+};
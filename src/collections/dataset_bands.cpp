@@ -3,6 +3,7 @@
 #include "../gdal_rasterband.hpp"
 #include "dataset_bands.hpp"
 #include "../utils/string_list.hpp"
+#include "../utils/dataset_worker.hpp"
 
 namespace node_gdal {
 
@@ -102,6 +103,8 @@ NAN_METHOD(DatasetBands::get)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr){
 		info.GetReturnValue().Set(Nan::Null());
@@ -141,6 +144,8 @@ NAN_METHOD(DatasetBands::create)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr){
 		Nan::ThrowError("Dataset does not support getting creating bands");
@@ -199,6 +204,8 @@ NAN_METHOD(DatasetBands::count)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr){
 		info.GetReturnValue().Set(Nan::New<Integer>(0));
@@ -4,6 +4,7 @@
 #include "../gdal_spatial_reference.hpp"
 #include "dataset_layers.hpp"
 #include "../utils/string_list.hpp"
+#include "../utils/dataset_worker.hpp"
 
 namespace node_gdal {
 
@@ -106,6 +107,8 @@ NAN_METHOD(DatasetLayers::get)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR >= 2
 		GDALDataset *raw = ds->getDataset();
 	#else
@@ -164,6 +167,8 @@ NAN_METHOD(DatasetLayers::create)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR >= 2
 		GDALDataset *raw = ds->getDataset();
 	#else
@@ -221,6 +226,8 @@ NAN_METHOD(DatasetLayers::count)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR >= 2
 		GDALDataset *raw = ds->getDataset();
 	#else
@@ -255,6 +262,8 @@ NAN_METHOD(DatasetLayers::copy)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR >= 2
 		GDALDataset *raw = ds->getDataset();
 	#else
@@ -307,6 +316,8 @@ NAN_METHOD(DatasetLayers::remove)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR >= 2
 		GDALDataset *raw = ds->getDataset();
 	#else
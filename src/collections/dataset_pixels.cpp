@@ -0,0 +1,399 @@
+#include "../gdal_common.hpp"
+#include "../gdal_dataset.hpp"
+#include "dataset_pixels.hpp"
+#include "../utils/typed_array.hpp"
+#include "../utils/dataset_worker.hpp"
+#include "../utils/virtual_mem.hpp"
+
+#include <vector>
+#include <climits>
+
+namespace node_gdal {
+
+Nan::Persistent<FunctionTemplate> DatasetPixels::constructor;
+
+// Performs the multi-band RasterIO behind readAsync() / writeAsync()
+class DatasetPixelsWorker : public DatasetWorker {
+public:
+	DatasetPixelsWorker(Nan::Callback *callback, Dataset *ds, GDALRWFlag flag, void *data)
+		: DatasetWorker(callback, ds->uid), ds(ds->getDataset()), flag(flag), data(data),
+		  x(0), y(0), w(0), h(0), buffer_w(0), buffer_h(0), type(GDT_Unknown), bands(),
+		  pixel_space(0), line_space(0), band_space(0), mapped(ptr_manager.hasMappings(ds->uid))
+	{}
+
+	void setRegion(int x, int y, int w, int h, int buffer_w, int buffer_h, GDALDataType type,
+	               std::vector<int> &bands, GSpacing pixel_space, GSpacing line_space, GSpacing band_space)
+	{
+		this->x = x; this->y = y; this->w = w; this->h = h;
+		this->buffer_w = buffer_w; this->buffer_h = buffer_h;
+		this->type = type;
+		this->bands = bands;
+		this->pixel_space = pixel_space; this->line_space = line_space; this->band_space = band_space;
+	}
+
+protected:
+	void Run()
+	{
+		MappingSync<GDALDataset> sync(ds, mapped);
+		#if GDAL_VERSION_MAJOR >= 2
+		CPLErr err = ds->RasterIO(flag, x, y, w, h, data, buffer_w, buffer_h, type,
+		                          bands.size(), &bands[0], pixel_space, line_space, band_space, NULL);
+		#else
+		CPLErr err = ds->RasterIO(flag, x, y, w, h, data, buffer_w, buffer_h, type,
+		                          bands.size(), &bands[0], pixel_space, line_space, band_space);
+		#endif
+		if(err) {
+			SetCPLErrorMessage();
+		}
+	}
+
+	Local<Value> GetResult()
+	{
+		if(flag == GF_Read) return GetFromPersistent("array");
+		return Nan::Undefined();
+	}
+
+private:
+	GDALDataset *ds;
+	GDALRWFlag flag;
+	void *data;
+	int x, y, w, h;
+	int buffer_w, buffer_h;
+	GDALDataType type;
+	std::vector<int> bands;
+	GSpacing pixel_space, line_space, band_space;
+	bool mapped;
+};
+
+void DatasetPixels::Initialize(Local<Object> target)
+{
+	Nan::HandleScope scope;
+
+	Local<FunctionTemplate> lcons = Nan::New<FunctionTemplate>(DatasetPixels::New);
+	lcons->InstanceTemplate()->SetInternalFieldCount(1);
+	lcons->SetClassName(Nan::New("DatasetPixels").ToLocalChecked());
+
+	Nan::SetPrototypeMethod(lcons, "toString", toString);
+	Nan::SetPrototypeMethod(lcons, "read", read);
+	Nan::SetPrototypeMethod(lcons, "write", write);
+	Nan::SetPrototypeMethod(lcons, "readAsync", readAsync);
+	Nan::SetPrototypeMethod(lcons, "writeAsync", writeAsync);
+
+	target->Set(Nan::New("DatasetPixels").ToLocalChecked(), lcons->GetFunction());
+
+	constructor.Reset(lcons);
+}
+
+DatasetPixels::DatasetPixels()
+	: Nan::ObjectWrap()
+{}
+
+DatasetPixels::~DatasetPixels()
+{}
+
+/**
+ * The pixels of several of a {{#crossLink "gdal.Dataset"}}Dataset{{/crossLink}}'s
+ * raster bands, read or written in a single call.
+ *
+ * ```
+ * // RGBA tile as one pixel-interleaved array
+ * var rgba = dataset.pixels.read(0, 0, 256, 256, null, {
+ *     bands: [1, 2, 3, 4],
+ *     interleave: 'pixel'
+ * });```
+ *
+ * @class gdal.DatasetPixels
+ */
+NAN_METHOD(DatasetPixels::New)
+{
+	Nan::HandleScope scope;
+
+	if (!info.IsConstructCall()) {
+		Nan::ThrowError("Cannot call constructor as function, you need to use 'new' keyword");
+		return;
+	}
+	if (info[0]->IsExternal()) {
+		Local<External> ext = info[0].As<External>();
+		void* ptr = ext->Value();
+		DatasetPixels *f = static_cast<DatasetPixels *>(ptr);
+		f->Wrap(info.This());
+		info.GetReturnValue().Set(info.This());
+		return;
+	} else {
+		Nan::ThrowError("Cannot create DatasetPixels directly");
+		return;
+	}
+}
+
+Local<Value> DatasetPixels::New(Local<Value> ds_obj)
+{
+	Nan::EscapableHandleScope scope;
+
+	DatasetPixels *wrapped = new DatasetPixels();
+
+	v8::Local<v8::Value> ext = Nan::New<External>(wrapped);
+	v8::Local<v8::Object> obj = Nan::NewInstance(Nan::New(DatasetPixels::constructor)->GetFunction(), 1, &ext).ToLocalChecked();
+	Nan::SetPrivate(obj, Nan::New("parent_").ToLocalChecked(), ds_obj);
+
+	return scope.Escape(obj);
+}
+
+NAN_METHOD(DatasetPixels::toString)
+{
+	Nan::HandleScope scope;
+	info.GetReturnValue().Set(Nan::New("DatasetPixels").ToLocalChecked());
+}
+
+/**
+ * Reads a region of pixels from several bands.
+ *
+ * By default bands are stored one after the other (`interleave: "band"`);
+ * with `interleave: "pixel"` the values of each pixel are stored together,
+ * e.g. RGBARGBA... The spacing options override the layout in bytes.
+ *
+ * @method read
+ * @throws Error
+ * @param {Integer} x
+ * @param {Integer} y
+ * @param {Integer} width
+ * @param {Integer} height
+ * @param {TypedArray} [data] The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) to put the data in. A new array is created if not given.
+ * @param {Object} [options]
+ * @param {Integer[]} [options.bands] Band ids to read (all bands by default).
+ * @param {Integer} [options.buffer_width=x_size]
+ * @param {Integer} [options.buffer_height=y_size]
+ * @param {String} [options.type] See {{#crossLink "Constants (GDT)"}}GDT constants{{/crossLink}}. Defaults to the type of the first band.
+ * @param {String} [options.interleave="band"] `"band"` or `"pixel"`
+ * @param {Integer} [options.pixel_space]
+ * @param {Integer} [options.line_space]
+ * @param {Integer} [options.band_space]
+ * @return {TypedArray} A [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values.
+ */
+NAN_METHOD(DatasetPixels::read)
+{
+	doRasterIO(info, GF_Read, false);
+}
+
+NAN_METHOD(DatasetPixels::readAsync)
+{
+	doRasterIO(info, GF_Read, true);
+}
+
+/**
+ * Writes a region of pixels to several bands.
+ *
+ * @method write
+ * @throws Error
+ * @param {Integer} x
+ * @param {Integer} y
+ * @param {Integer} width
+ * @param {Integer} height
+ * @param {TypedArray} data The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) to write to the bands.
+ * @param {Object} [options] See {{#crossLink "gdal.DatasetPixels/read:method"}}read(){{/crossLink}}.
+ * @param {Integer[]} [options.bands] Band ids to write (all bands by default).
+ * @param {Integer} [options.buffer_width=x_size]
+ * @param {Integer} [options.buffer_height=y_size]
+ * @param {String} [options.interleave="band"] `"band"` or `"pixel"`
+ * @param {Integer} [options.pixel_space]
+ * @param {Integer} [options.line_space]
+ * @param {Integer} [options.band_space]
+ */
+NAN_METHOD(DatasetPixels::write)
+{
+	doRasterIO(info, GF_Write, false);
+}
+
+NAN_METHOD(DatasetPixels::writeAsync)
+{
+	doRasterIO(info, GF_Write, true);
+}
+
+// (x, y, w, h, data, buffer_w, buffer_h, type, bands, interleave, pixel_space, line_space, band_space[, callback])
+void DatasetPixels::doRasterIO(NAN_METHOD_ARGS_TYPE info, GDALRWFlag flag, bool async)
+{
+	Nan::HandleScope scope;
+
+	Local<Object> parent = Nan::GetPrivate(info.This(), Nan::New("parent_").ToLocalChecked()).ToLocalChecked().As<Object>();
+	Dataset *ds = Nan::ObjectWrap::Unwrap<Dataset>(parent);
+	if (!ds->isAlive()) {
+		Nan::ThrowError("Dataset object has already been destroyed");
+		return;
+	}
+
+	#if GDAL_VERSION_MAJOR < 2
+	if (ds->uses_ogr) {
+		Nan::ThrowError("Dataset does not support raster operations");
+		return;
+	}
+	#endif
+
+	GDALDataset *raw = ds->getDataset();
+
+	int x, y, w, h;
+	int buffer_w, buffer_h;
+	int bytes_per_pixel;
+	void *data;
+	Local<Object> obj;
+	Local<Array> band_list;
+	std::string type_name = "";
+	std::string interleave = "band";
+	std::vector<int> bands;
+	GDALDataType type = GDT_Unknown;
+
+	Local<Function> callback;
+	if(async) {
+		NODE_ARG_CALLBACK(13, "callback", callback);
+	}
+
+	NODE_ARG_INT(0, "x_offset", x);
+	NODE_ARG_INT(1, "y_offset", y);
+	NODE_ARG_INT(2, "x_size", w);
+	NODE_ARG_INT(3, "y_size", h);
+
+	buffer_w = w;
+	buffer_h = h;
+	NODE_ARG_INT_OPT(5, "buffer_width", buffer_w);
+	NODE_ARG_INT_OPT(6, "buffer_height", buffer_h);
+	NODE_ARG_OPT_STR(7, "type", type_name);
+	NODE_ARG_ARRAY_OPT(8, "bands", band_list);
+	NODE_ARG_OPT_STR(9, "interleave", interleave);
+
+	if(interleave != "band" && interleave != "pixel") {
+		Nan::ThrowError("interleave must be \"band\" or \"pixel\"");
+		return;
+	}
+
+	if(band_list.IsEmpty()) {
+		for(int i = 1; i <= raw->GetRasterCount(); i++) bands.push_back(i);
+	} else {
+		for(unsigned int i = 0; i < band_list->Length(); i++) {
+			Local<Value> val = band_list->Get(i);
+			if(!val->IsNumber()) {
+				Nan::ThrowError("band array must only contain numbers");
+				return;
+			}
+			int id = val->Int32Value();
+			if(id > raw->GetRasterCount() || id < 1) {
+				Nan::ThrowError("invalid band id");
+				return;
+			}
+			bands.push_back(id);
+		}
+	}
+	if(bands.empty()) {
+		Nan::ThrowError("Dataset has no raster bands");
+		return;
+	}
+	int n_bands = bands.size();
+
+	if(!type_name.empty()) {
+		type = GDALGetDataTypeByName(type_name.c_str());
+		if(type == GDT_Unknown) {
+			Nan::ThrowError("Invalid data type");
+			return;
+		}
+	} else {
+		type = raw->GetRasterBand(bands[0])->GetRasterDataType();
+	}
+
+	if(info.Length() >= 5 && !info[4]->IsUndefined() && !info[4]->IsNull()) {
+		NODE_ARG_OBJECT(4, "data", obj);
+		type = TypedArray::Identify(obj, type);
+		if(type == GDT_Unknown) {
+			Nan::ThrowError("Invalid array");
+			return;
+		}
+	} else if(flag == GF_Write) {
+		Nan::ThrowError("data must be given");
+		return;
+	}
+
+	bytes_per_pixel = GDALGetDataTypeSize(type) / 8;
+
+	int pixel_space, line_space, band_space;
+	if(interleave == "pixel") {
+		pixel_space = bytes_per_pixel * n_bands;
+		band_space  = bytes_per_pixel;
+	} else {
+		pixel_space = bytes_per_pixel;
+		band_space  = 0;
+	}
+	NODE_ARG_INT_OPT(10, "pixel_space", pixel_space);
+	line_space = pixel_space * buffer_w;
+	NODE_ARG_INT_OPT(11, "line_space", line_space);
+	if(interleave == "band") {
+		band_space = line_space * buffer_h;
+	}
+	NODE_ARG_INT_OPT(12, "band_space", band_space);
+
+	if(pixel_space < bytes_per_pixel) {
+		Nan::ThrowError("pixel_space must be greater than or equal to size of type");
+		return;
+	}
+	if(line_space < pixel_space * buffer_w) {
+		Nan::ThrowError("line_space must be greater than or equal to pixel_space * buffer_w");
+		return;
+	}
+	if(band_space < bytes_per_pixel) {
+		Nan::ThrowError("band_space must be greater than or equal to size of type");
+		return;
+	}
+
+	// offset of the last value written, plus its size
+	double min_size = (double) pixel_space * (buffer_w - 1) + (double) line_space * (buffer_h - 1)
+	                + (double) band_space * (n_bands - 1) + bytes_per_pixel;
+	if(min_size > INT_MAX) {
+		Nan::ThrowError("Array would be too large");
+		return;
+	}
+	int min_length = ((int) min_size + bytes_per_pixel - 1) / bytes_per_pixel;
+
+	if(obj.IsEmpty()) {
+		Local<Value> array = TypedArray::New(type, min_length);
+		if(array.IsEmpty() || !array->IsObject()) {
+			return; //TypedArray::New threw an error
+		}
+		obj = array.As<Object>();
+	}
+
+	data = TypedArray::Validate(obj, type, min_length);
+	if(!data) {
+		return; //TypedArray::Validate threw an error
+	}
+	if(ptr_manager.isMapped(ds->uid, data, (size_t) min_size)) {
+		Nan::ThrowError("Array is mapped from the same dataset");
+		return;
+	}
+
+	if(async) {
+		DatasetPixelsWorker *worker = new DatasetPixelsWorker(new Nan::Callback(callback), ds, flag, data);
+		worker->setRegion(x, y, w, h, buffer_w, buffer_h, type, bands, pixel_space, line_space, band_space);
+		worker->SaveToPersistent("dataset", parent);
+		worker->SaveToPersistent("array", obj);
+		worker->queue();
+		return;
+	}
+
+	CPLErr err;
+	{
+		DatasetSyncLock lock(ds->uid);
+		MappingSync<GDALDataset> sync(raw, ptr_manager.hasMappings(ds->uid));
+		#if GDAL_VERSION_MAJOR >= 2
+		err = raw->RasterIO(flag, x, y, w, h, data, buffer_w, buffer_h, type,
+		                    n_bands, &bands[0], pixel_space, line_space, band_space, NULL);
+		#else
+		err = raw->RasterIO(flag, x, y, w, h, data, buffer_w, buffer_h, type,
+		                    n_bands, &bands[0], pixel_space, line_space, band_space);
+		#endif
+	}
+	if(err) {
+		NODE_THROW_CPLERR(err);
+		return;
+	}
+
+	if(flag == GF_Read) {
+		info.GetReturnValue().Set(obj);
+	}
+}
+
+}
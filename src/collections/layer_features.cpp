@@ -2,6 +2,9 @@
 #include "../gdal_layer.hpp"
 #include "../gdal_feature.hpp"
 #include "layer_features.hpp"
+#include "../utils/dataset_worker.hpp"
+
+#include <vector>
 
 namespace node_gdal {
 
@@ -22,6 +25,7 @@ void LayerFeatures::Initialize(Local<Object> target)
 	Nan::SetPrototypeMethod(lcons, "set", set);
 	Nan::SetPrototypeMethod(lcons, "first", first);
 	Nan::SetPrototypeMethod(lcons, "next", next);
+	Nan::SetPrototypeMethod(lcons, "nextBatchAsync", nextBatchAsync);
 	Nan::SetPrototypeMethod(lcons, "remove", remove);
 
 	ATTR_DONT_ENUM(lcons, "layer", layerGetter, READ_ONLY_SETTER);
@@ -106,6 +110,7 @@ NAN_METHOD(LayerFeatures::get)
 
 	int feature_id;
 	NODE_ARG_INT(0, "feature id", feature_id);
+	DatasetSyncLock lock(layer->uid);
 	OGRFeature *feature = layer->get()->GetFeature(feature_id);
 
 	info.GetReturnValue().Set(Feature::New(feature));
@@ -129,6 +134,7 @@ NAN_METHOD(LayerFeatures::first)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
 	layer->get()->ResetReading();
 	OGRFeature *feature = layer->get()->GetNextFeature();
 
@@ -156,11 +162,103 @@ NAN_METHOD(LayerFeatures::next)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
 	OGRFeature *feature = layer->get()->GetNextFeature();
 
 	info.GetReturnValue().Set(Feature::New(feature));
 }
 
+// Reads a batch of features for nextBatchAsync() on the libuv threadpool, holding the dataset lock
+class NextBatchWorker : public DatasetWorker {
+public:
+	NextBatchWorker(Nan::Callback *callback, Layer *layer, int n)
+		: DatasetWorker(callback, layer->uid), layer(layer->get()), n(n)
+	{}
+
+	~NextBatchWorker()
+	{
+		// features not handed to JS (error / early destruction)
+		for(size_t i = 0; i < features.size(); i++) {
+			OGRFeature::DestroyFeature(features[i]);
+		}
+	}
+
+protected:
+	void Run()
+	{
+		for(int i = 0; i < n; i++) {
+			OGRFeature *feature = layer->GetNextFeature();
+			if(!feature) {
+				// NULL is either the end of the layer or a read error
+				if(CPLGetLastErrorType() == CE_Failure) {
+					SetCPLErrorMessage("Error reading feature");
+				}
+				break;
+			}
+			features.push_back(feature);
+			CPLErrorReset();
+		}
+	}
+
+	// the features read before the error are attached to it, so callers can
+	// process them before giving up
+	void HandleErrorCallback()
+	{
+		Nan::HandleScope scope;
+
+		Local<Object> err = Nan::Error(ErrorMessage()).As<Object>();
+		Nan::Set(err, Nan::New("features").ToLocalChecked(), GetResult());
+
+		Local<Value> argv[] = { err };
+		callback->Call(1, argv, async_resource);
+	}
+
+	Local<Value> GetResult()
+	{
+		Nan::EscapableHandleScope scope;
+
+		Local<Array> result = Nan::New<Array>(features.size());
+		for(size_t i = 0; i < features.size(); i++) {
+			result->Set(i, Feature::New(features[i]));
+		}
+		features.clear();
+
+		return scope.Escape(result);
+	}
+
+private:
+	OGRLayer *layer;
+	int n;
+	std::vector<OGRFeature*> features;
+};
+
+NAN_METHOD(LayerFeatures::nextBatchAsync)
+{
+	Nan::HandleScope scope;
+
+	Local<Object> parent = Nan::GetPrivate(info.This(), Nan::New("parent_").ToLocalChecked()).ToLocalChecked().As<Object>();
+	Layer *layer = Nan::ObjectWrap::Unwrap<Layer>(parent);
+	if (!layer->isAlive()) {
+		Nan::ThrowError("Layer object already destroyed");
+		return;
+	}
+
+	int n;
+	Local<Function> callback;
+
+	NODE_ARG_INT(0, "n", n);
+	NODE_ARG_CALLBACK(1, "callback", callback);
+
+	if (n < 1) {
+		Nan::ThrowRangeError("n must be greater than 0");
+		return;
+	}
+
+	NextBatchWorker *worker = new NextBatchWorker(new Nan::Callback(callback), layer, n);
+	worker->SaveToPersistent("layer", parent);
+	worker->queue();
+}
+
 /**
  * Adds a feature to the layer. The feature should be created using the current layer as the definition.
  *
@@ -186,6 +284,8 @@ NAN_METHOD(LayerFeatures::add)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	Feature *f;
 	NODE_ARG_WRAPPED(0, "feature", Feature, f)
 
@@ -215,6 +315,8 @@ NAN_METHOD(LayerFeatures::count)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	int force = 1;
 	NODE_ARG_BOOL_OPT(0, "force", force);
 
@@ -240,6 +342,8 @@ NAN_METHOD(LayerFeatures::set)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	int err;
 	Feature *f;
 	int argc = info.Length();
@@ -290,6 +394,8 @@ NAN_METHOD(LayerFeatures::remove)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	int i;
 	NODE_ARG_INT(0, "feature id", i);
 	int err = layer->get()->DeleteFeature(i);
@@ -31,6 +31,7 @@ public:
 	static NAN_METHOD(get);
 	static NAN_METHOD(first);
 	static NAN_METHOD(next);
+	static NAN_METHOD(nextBatchAsync);
 	static NAN_METHOD(count);
 	static NAN_METHOD(add);
 	static NAN_METHOD(set);
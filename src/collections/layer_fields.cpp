@@ -2,6 +2,7 @@
 #include "../gdal_field_defn.hpp"
 #include "../gdal_layer.hpp"
 #include "layer_fields.hpp"
+#include "../utils/dataset_worker.hpp"
 
 namespace node_gdal {
 
@@ -99,6 +100,8 @@ NAN_METHOD(LayerFields::count)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	OGRFeatureDefn *def = layer->get()->GetLayerDefn();
 	if (!def) {
 		Nan::ThrowError("Layer has no layer definition set");
@@ -126,6 +129,8 @@ NAN_METHOD(LayerFields::indexOf)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	OGRFeatureDefn *def = layer->get()->GetLayerDefn();
 	if (!def) {
 		Nan::ThrowError("Layer has no layer definition set");
@@ -157,6 +162,8 @@ NAN_METHOD(LayerFields::get)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	if (info.Length() < 1) {
 		Nan::ThrowError("Field index or name must be given");
 		return;
@@ -192,6 +199,8 @@ NAN_METHOD(LayerFields::getNames)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	OGRFeatureDefn *def = layer->get()->GetLayerDefn();
 	if (!def) {
 		Nan::ThrowError("Layer has no layer definition set");
@@ -227,6 +236,8 @@ NAN_METHOD(LayerFields::remove)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	if (info.Length() < 1) {
 		Nan::ThrowError("Field index or name must be given");
 		return;
@@ -268,6 +279,8 @@ NAN_METHOD(LayerFields::add)
 		Nan::ThrowError("Layer object already destroyed");
 		return;
 	}
+
+	DatasetSyncLock lock(layer->uid);
 	if (info.Length() < 1) {
 		Nan::ThrowError("field definition(s) must be given");
 		return;
@@ -333,6 +346,8 @@ NAN_METHOD(LayerFields::reorder)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	OGRFeatureDefn *def = layer->get()->GetLayerDefn();
 	if (!def) {
 		Nan::ThrowError("Layer has no layer definition set");
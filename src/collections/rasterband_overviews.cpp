@@ -1,6 +1,7 @@
 #include "../gdal_common.hpp"
 #include "../gdal_rasterband.hpp"
 #include "rasterband_overviews.hpp"
+#include "../utils/dataset_worker.hpp"
 
 namespace node_gdal {
 
@@ -96,6 +97,8 @@ NAN_METHOD(RasterBandOverviews::get)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int id;
 	NODE_ARG_INT(0, "id", id);
 
@@ -134,6 +137,8 @@ NAN_METHOD(RasterBandOverviews::getBySampleCount)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int n_samples;
 	NODE_ARG_INT(0, "minimum number of samples", n_samples);
 
@@ -159,6 +164,8 @@ NAN_METHOD(RasterBandOverviews::count)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	info.GetReturnValue().Set(Nan::New<Integer>(band->get()->GetOverviewCount()));
 }
 
@@ -2,13 +2,122 @@
 #include "../gdal_rasterband.hpp"
 #include "rasterband_pixels.hpp"
 #include "../utils/typed_array.hpp"
+#include "../utils/dataset_worker.hpp"
+#include "../utils/dataset_pool.hpp"
+#include "../utils/virtual_mem.hpp"
 
 #include <sstream>
+#include <cmath>
 
 namespace node_gdal {
 
 Nan::Persistent<FunctionTemplate> RasterBandPixels::constructor;
 
+// Accepts the same names as the gdal.GRA_* constants
+static bool parseResampling(const std::string &name, GDALRIOResampleAlg &alg)
+{
+	if(name == "NearestNeighbor" || name == "NearestNeighbour") { alg = GRIORA_NearestNeighbour; return true; }
+	if(name == "Bilinear") {    alg = GRIORA_Bilinear; return true; }
+	if(name == "Cubic") {       alg = GRIORA_Cubic; return true; }
+	if(name == "CubicSpline") { alg = GRIORA_CubicSpline; return true; }
+	if(name == "Lanczos") {     alg = GRIORA_Lanczos; return true; }
+	if(name == "Average") {     alg = GRIORA_Average; return true; }
+	if(name == "Mode") {        alg = GRIORA_Mode; return true; }
+	if(name == "Gauss") {       alg = GRIORA_Gauss; return true; }
+	return false;
+}
+
+// Performs the RasterIO / block IO behind the *Async methods. The band and
+// the target array are saved to persistent handles by the caller so neither
+// the dataset nor the array's backing store can go away mid-job.
+//
+// Reads of datasets opened with gdal.openPool() run on whichever pooled
+// handle is free instead of waiting for the dataset.
+class RasterBandPixelsWorker : public DatasetWorker {
+public:
+	RasterBandPixelsWorker(Nan::Callback *callback, RasterBand *wrapped, GDALRWFlag flag, void *data)
+		: DatasetWorker(callback, wrapped->uid), band(wrapped->get()), flag(flag), data(data), block(false),
+		  x(0), y(0), w(0), h(0), buffer_w(0), buffer_h(0), type(GDT_Unknown), pixel_space(0), line_space(0),
+		  pool(NULL), mapped(ptr_manager.hasMappings(wrapped->uid))
+	{
+		INIT_RASTERIO_EXTRA_ARG(extra);
+		if(flag == GF_Read) {
+			pool = ptr_manager.getPool(wrapped->uid);
+			if(pool && !pool->contains(band)) pool = NULL;
+			if(pool) setPool(pool);
+		}
+	}
+
+	void setRegion(int x, int y, int w, int h, int buffer_w, int buffer_h, GDALDataType type, int pixel_space, int line_space)
+	{
+		this->x = x; this->y = y; this->w = w; this->h = h;
+		this->buffer_w = buffer_w; this->buffer_h = buffer_h;
+		this->type = type;
+		this->pixel_space = pixel_space; this->line_space = line_space;
+	}
+
+	void setExtraArg(const GDALRasterIOExtraArg &extra)
+	{
+		this->extra = extra;
+	}
+
+	void setBlock(int x, int y)
+	{
+		this->block = true;
+		this->x = x; this->y = y;
+	}
+
+protected:
+	void Run()
+	{
+		GDALRasterBand *band = pool ? pool->getBand(poolHandle(), this->band->GetBand()) : this->band;
+		if(!band) {
+			SetCPLErrorMessage("Error opening pooled handle");
+			return;
+		}
+		MappingSync<GDALRasterBand> sync(band, mapped);
+		CPLErr err;
+		if(block) {
+			err = (flag == GF_Read) ? band->ReadBlock(x, y, data) : band->WriteBlock(x, y, data);
+		} else {
+			err = band->RasterIO(flag, x, y, w, h, data, buffer_w, buffer_h, type, pixel_space, line_space, &extra);
+		}
+		if(err) {
+			SetCPLErrorMessage();
+		}
+	}
+
+	Local<Value> GetResult()
+	{
+		if(flag == GF_Read) return GetFromPersistent("array");
+		return Nan::Undefined();
+	}
+
+private:
+	GDALRasterBand *band;
+	GDALRWFlag flag;
+	void *data;
+	bool block;
+	int x, y, w, h;
+	int buffer_w, buffer_h;
+	GDALDataType type;
+	int pixel_space, line_space;
+	GDALRasterIOExtraArg extra;
+	DatasetPool *pool;
+	bool mapped;
+};
+
+// Arrays returned by map() view the dataset's file, so transferring pixels
+// between them and the same dataset would read and write the same bytes
+static bool checkNotMapped(RasterBand *band, const void *data, size_t size)
+{
+	if(ptr_manager.isMapped(band->uid, data, size)) {
+		Nan::ThrowError("Array is mapped from the same dataset");
+		return false;
+	}
+	return true;
+}
+
 void RasterBandPixels::Initialize(Local<Object> target)
 {
 	Nan::HandleScope scope;
@@ -24,6 +133,13 @@ void RasterBandPixels::Initialize(Local<Object> target)
 	Nan::SetPrototypeMethod(lcons, "write", write);
 	Nan::SetPrototypeMethod(lcons, "readBlock", readBlock);
 	Nan::SetPrototypeMethod(lcons, "writeBlock", writeBlock);
+	Nan::SetPrototypeMethod(lcons, "readAsync", readAsync);
+	Nan::SetPrototypeMethod(lcons, "writeAsync", writeAsync);
+	Nan::SetPrototypeMethod(lcons, "readBlockAsync", readBlockAsync);
+	Nan::SetPrototypeMethod(lcons, "writeBlockAsync", writeBlockAsync);
+	Nan::SetPrototypeMethod(lcons, "map", map);
+
+	ATTR_DONT_ENUM(lcons, "band", bandGetter, READ_ONLY_SETTER);
 
 	target->Set(Nan::New("RasterBandPixels").ToLocalChecked(), lcons->GetFunction());
 
@@ -40,8 +156,9 @@ RasterBandPixels::~RasterBandPixels()
 /**
  * A representation of a {{#crossLink "gdal.RasterBand"}}RasterBand{{/crossLink}}'s pixels.
  *
- * 
- * Note: Typed arrays should be created with an external ArrayBuffer for versions of node >= 0.11
+ * Data can be read into / written from any typed array whose element type
+ * matches the data type, a Buffer (for `GDT_Byte`), or a DataView (raw bytes of
+ * the band's data type), including views on a SharedArrayBuffer.
  * ```
  * var n = 16*16;
  * var data = new Float32Array(new ArrayBuffer(n*4));
@@ -115,7 +232,12 @@ NAN_METHOD(RasterBandPixels::get)
 	NODE_ARG_INT(0, "x", x);
 	NODE_ARG_INT(1, "y", y);
 
-	CPLErr err = band->get()->RasterIO(GF_Read, x, y, 1, 1, &val, 1, 1, GDT_Float64, 0, 0);
+	CPLErr err;
+	{
+		DatasetSyncLock lock(band->uid);
+		MappingSync<GDALRasterBand> sync(band->get(), ptr_manager.hasMappings(band->uid));
+		err = band->get()->RasterIO(GF_Read, x, y, 1, 1, &val, 1, 1, GDT_Float64, 0, 0);
+	}
 	if(err) {
 		NODE_THROW_CPLERR(err);
 		return;
@@ -150,7 +272,12 @@ NAN_METHOD(RasterBandPixels::set)
 	NODE_ARG_INT(1, "y", y);
 	NODE_ARG_DOUBLE(2, "val", val);
 
-	CPLErr err = band->get()->RasterIO(GF_Write, x, y, 1, 1, &val, 1, 1, GDT_Float64, 0, 0);
+	CPLErr err;
+	{
+		DatasetSyncLock lock(band->uid);
+		MappingSync<GDALRasterBand> sync(band->get(), ptr_manager.hasMappings(band->uid));
+		err = band->get()->RasterIO(GF_Write, x, y, 1, 1, &val, 1, 1, GDT_Float64, 0, 0);
+	}
 	if(err) {
 		NODE_THROW_CPLERR(err);
 		return;
@@ -162,22 +289,46 @@ NAN_METHOD(RasterBandPixels::set)
 /**
  * Reads a region of pixels.
  *
+ * When the buffer size differs from the region size, the region is resampled
+ * with `options.resampling`. The region may then be given in fractional pixels
+ * so zoomed-out tiles line up exactly with the source grid.
+ *
+ * @example
+ * ```
+ * // a filtered 256x256 preview of the whole band
+ * var preview = band.pixels.read(0, 0, band.size.x, band.size.y, null, {
+ *     buffer_width: 256,
+ *     buffer_height: 256,
+ *     resampling: gdal.GRA_Average
+ * });```
+ *
  * @method read
  * @throws Error
- * @param {Integer} x
- * @param {Integer} y
- * @param {Integer} width
- * @param {Integer} height
+ * @param {Number} x
+ * @param {Number} y
+ * @param {Number} width
+ * @param {Number} height
  * @param {TypedArray} [data] The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) to put the data in. A new array is created if not given.
  * @param {Object} [options]
  * @param {Integer} [options.buffer_width=x_size]
  * @param {Integer} [options.buffer_height=y_size]
- * @param {String} [options.data_type] See {{#crossLink "Constants (GDT)"}}GDT constants{{/crossLink}}.
+ * @param {String} [options.type] See {{#crossLink "Constants (GDT)"}}GDT constants{{/crossLink}}.
  * @param {Integer} [options.pixel_space]
  * @param {Integer} [options.line_space]
+ * @param {String} [options.resampling=NearestNeighbor] See {{#crossLink "Constants (GRA)"}}GRA constants{{/crossLink}} (`"Gauss"` is also accepted).
  * @return {TypedArray} A [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values.
  */
 NAN_METHOD(RasterBandPixels::read)
+{
+	doRead(info, false);
+}
+
+NAN_METHOD(RasterBandPixels::readAsync)
+{
+	doRead(info, true);
+}
+
+void RasterBandPixels::doRead(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -199,15 +350,48 @@ NAN_METHOD(RasterBandPixels::read)
 	GDALDataType type;
 
 
-	NODE_ARG_INT(0, "x_offset", x);
-	NODE_ARG_INT(1, "y_offset", y);
-	NODE_ARG_INT(2, "x_size", w);
-	NODE_ARG_INT(3, "y_size", h);
+	Local<Function> callback;
+	if(async) {
+		NODE_ARG_CALLBACK(11, "callback", callback);
+	}
+
+	double x_off, y_off, x_size, y_size;
+	NODE_ARG_DOUBLE(0, "x_offset", x_off);
+	NODE_ARG_DOUBLE(1, "y_offset", y_off);
+	NODE_ARG_DOUBLE(2, "x_size", x_size);
+	NODE_ARG_DOUBLE(3, "y_size", y_size);
+
+	// the smallest whole-pixel window containing the requested one
+	x = (int) floor(x_off);
+	y = (int) floor(y_off);
+	w = (int) ceil(x_off + x_size) - x;
+	h = (int) ceil(y_off + y_size) - y;
+
+	GDALRasterIOExtraArg extra;
+	INIT_RASTERIO_EXTRA_ARG(extra);
+	if(x != x_off || y != y_off || w != x_size || h != y_size) {
+		if(x_size <= 0 || y_size <= 0) {
+			Nan::ThrowRangeError("x_size and y_size must be positive");
+			return;
+		}
+		extra.bFloatingPointWindowValidity = TRUE;
+		extra.dfXOff = x_off;
+		extra.dfYOff = y_off;
+		extra.dfXSize = x_size;
+		extra.dfYSize = y_size;
+	}
+
+	std::string resampling = "";
+	NODE_ARG_OPT_STR(10, "resampling", resampling);
+	if(!resampling.empty() && !parseResampling(resampling, extra.eResampleAlg)) {
+		Nan::ThrowError("Invalid resampling algorithm");
+		return;
+	}
 
 	std::string type_name = "";
 
-	buffer_w = w;
-	buffer_h = h;
+	buffer_w = (int) floor(x_size + 0.5);
+	buffer_h = (int) floor(y_size + 0.5);
 	type     = band->get()->GetRasterDataType();
 	NODE_ARG_INT_OPT(5, "buffer_width", buffer_w);
 	NODE_ARG_INT_OPT(6, "buffer_height", buffer_h);
@@ -218,7 +402,7 @@ NAN_METHOD(RasterBandPixels::read)
 
 	if(info.Length() >= 5 && !info[4]->IsUndefined() && !info[4]->IsNull()) {
 		NODE_ARG_OBJECT(4, "data", obj);
-		type = TypedArray::Identify(obj);
+		type = TypedArray::Identify(obj, type);
 		if(type == GDT_Unknown) {
 			Nan::ThrowError("Invalid array");
 			return;
@@ -258,8 +442,24 @@ NAN_METHOD(RasterBandPixels::read)
 	if(!data) {
 		return; //TypedArray::Validate threw an error
 	}
+	if(!checkNotMapped(band, data, min_size)) return;
+
+	if(async) {
+		RasterBandPixelsWorker *worker = new RasterBandPixelsWorker(new Nan::Callback(callback), band, GF_Read, data);
+		worker->setRegion(x, y, w, h, buffer_w, buffer_h, type, pixel_space, line_space);
+		worker->setExtraArg(extra);
+		worker->SaveToPersistent("band", parent);
+		worker->SaveToPersistent("array", obj);
+		worker->queue();
+		return;
+	}
 
-	CPLErr err = band->get()->RasterIO(GF_Read, x, y, w, h, data, buffer_w, buffer_h, type, pixel_space, line_space);
+	CPLErr err;
+	{
+		DatasetSyncLock lock(band->uid);
+		MappingSync<GDALRasterBand> sync(band->get(), ptr_manager.hasMappings(band->uid));
+		err = band->get()->RasterIO(GF_Read, x, y, w, h, data, buffer_w, buffer_h, type, pixel_space, line_space, &extra);
+	}
 	if(err) {
 		NODE_THROW_CPLERR(err);
 		return;
@@ -285,6 +485,16 @@ NAN_METHOD(RasterBandPixels::read)
  * @param {Integer} [options.line_space]
  */
 NAN_METHOD(RasterBandPixels::write)
+{
+	doWrite(info, false);
+}
+
+NAN_METHOD(RasterBandPixels::writeAsync)
+{
+	doWrite(info, true);
+}
+
+void RasterBandPixels::doWrite(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -304,6 +514,11 @@ NAN_METHOD(RasterBandPixels::write)
 	Local<Object> passed_array;
 	GDALDataType type;
 
+	Local<Function> callback;
+	if(async) {
+		NODE_ARG_CALLBACK(9, "callback", callback);
+	}
+
 	NODE_ARG_INT(0, "x_offset", x);
 	NODE_ARG_INT(1, "y_offset", y);
 	NODE_ARG_INT(2, "x_size", w);
@@ -315,7 +530,7 @@ NAN_METHOD(RasterBandPixels::write)
 	NODE_ARG_INT_OPT(5, "buffer_width", buffer_w);
 	NODE_ARG_INT_OPT(6, "buffer_height", buffer_h);
 
-	type = TypedArray::Identify(passed_array);
+	type = TypedArray::Identify(passed_array, band->get()->GetRasterDataType());
 	if(type == GDT_Unknown) {
 		Nan::ThrowError("Invalid array");
 		return;
@@ -344,8 +559,23 @@ NAN_METHOD(RasterBandPixels::write)
 	if(!data){
 		return; //TypedArray::Validate threw an error
 	}
+	if(!checkNotMapped(band, data, min_size)) return;
+
+	if(async) {
+		RasterBandPixelsWorker *worker = new RasterBandPixelsWorker(new Nan::Callback(callback), band, GF_Write, data);
+		worker->setRegion(x, y, w, h, buffer_w, buffer_h, type, pixel_space, line_space);
+		worker->SaveToPersistent("band", parent);
+		worker->SaveToPersistent("array", passed_array);
+		worker->queue();
+		return;
+	}
 
-	CPLErr err = band->get()->RasterIO(GF_Write, x, y, w, h, data, buffer_w, buffer_h, type, pixel_space, line_space);
+	CPLErr err;
+	{
+		DatasetSyncLock lock(band->uid);
+		MappingSync<GDALRasterBand> sync(band->get(), ptr_manager.hasMappings(band->uid));
+		err = band->get()->RasterIO(GF_Write, x, y, w, h, data, buffer_w, buffer_h, type, pixel_space, line_space);
+	}
 	if(err) {
 		NODE_THROW_CPLERR(err);
 		return;
@@ -365,6 +595,16 @@ NAN_METHOD(RasterBandPixels::write)
  * @return {TypedArray} A [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values.
  */
 NAN_METHOD(RasterBandPixels::readBlock)
+{
+	doReadBlock(info, false);
+}
+
+NAN_METHOD(RasterBandPixels::readBlockAsync)
+{
+	doReadBlock(info, true);
+}
+
+void RasterBandPixels::doReadBlock(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -375,6 +615,11 @@ NAN_METHOD(RasterBandPixels::readBlock)
 		return;
 	}
 
+	Local<Function> callback;
+	if(async) {
+		NODE_ARG_CALLBACK(3, "callback", callback);
+	}
+
 	int x, y, w = 0, h = 0;
 	NODE_ARG_INT(0, "block_x_offset", x);
 	NODE_ARG_INT(1, "block_y_offset", y);
@@ -386,7 +631,7 @@ NAN_METHOD(RasterBandPixels::readBlock)
 	Local<Value> array;
 	Local<Object> obj;
 
-	if(info.Length() == 3 && !info[2]->IsUndefined() && !info[2]->IsNull()) {
+	if(info.Length() >= 3 && !info[2]->IsUndefined() && !info[2]->IsNull()) {
 		NODE_ARG_OBJECT(2, "data", obj);
  		array = obj;
 	} else {
@@ -402,8 +647,23 @@ NAN_METHOD(RasterBandPixels::readBlock)
 	if(!data){
 		return; //TypedArray::Validate threw an error
 	}
+	if(!checkNotMapped(band, data, (size_t) w * h * GDALGetDataTypeSizeBytes(type))) return;
+
+	if(async) {
+		RasterBandPixelsWorker *worker = new RasterBandPixelsWorker(new Nan::Callback(callback), band, GF_Read, data);
+		worker->setBlock(x, y);
+		worker->SaveToPersistent("band", parent);
+		worker->SaveToPersistent("array", obj);
+		worker->queue();
+		return;
+	}
 
-	CPLErr err = band->get()->ReadBlock(x, y, data);
+	CPLErr err;
+	{
+		DatasetSyncLock lock(band->uid);
+		MappingSync<GDALRasterBand> sync(band->get(), ptr_manager.hasMappings(band->uid));
+		err = band->get()->ReadBlock(x, y, data);
+	}
 	if(err) {
 		NODE_THROW_CPLERR(err);
 		return;
@@ -422,6 +682,16 @@ NAN_METHOD(RasterBandPixels::readBlock)
  * @param {TypedArray} data The [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses) of values to write to the band.
  */
 NAN_METHOD(RasterBandPixels::writeBlock)
+{
+	doWriteBlock(info, false);
+}
+
+NAN_METHOD(RasterBandPixels::writeBlockAsync)
+{
+	doWriteBlock(info, true);
+}
+
+void RasterBandPixels::doWriteBlock(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -432,6 +702,11 @@ NAN_METHOD(RasterBandPixels::writeBlock)
 		return;
 	}
 
+	Local<Function> callback;
+	if(async) {
+		NODE_ARG_CALLBACK(3, "callback", callback);
+	}
+
 	int x, y, w = 0, h = 0;
 
 	band->get()->GetBlockSize(&w, &h);
@@ -447,8 +722,23 @@ NAN_METHOD(RasterBandPixels::writeBlock)
 	if(!data){
 		return; //TypedArray::Validate threw an error
 	}
+	if(!checkNotMapped(band, data, (size_t) w * h * GDALGetDataTypeSizeBytes(band->get()->GetRasterDataType()))) return;
+
+	if(async) {
+		RasterBandPixelsWorker *worker = new RasterBandPixelsWorker(new Nan::Callback(callback), band, GF_Write, data);
+		worker->setBlock(x, y);
+		worker->SaveToPersistent("band", parent);
+		worker->SaveToPersistent("array", obj);
+		worker->queue();
+		return;
+	}
 
-	CPLErr err = band->get()->WriteBlock(x, y, data);
+	CPLErr err;
+	{
+		DatasetSyncLock lock(band->uid);
+		MappingSync<GDALRasterBand> sync(band->get(), ptr_manager.hasMappings(band->uid));
+		err = band->get()->WriteBlock(x, y, data);
+	}
 
 	if(err) {
 		NODE_THROW_CPLERR(err);
@@ -458,5 +748,85 @@ NAN_METHOD(RasterBandPixels::writeBlock)
 	return;
 }
 
+/**
+ * Maps the whole band into memory, returning a [TypedArray](https://developer.mozilla.org/en-US/docs/Web/API/ArrayBufferView#Typed_array_subclasses)
+ * of `size.x * size.y` values in row-major order that views the band's file
+ * directly: random access costs a memory load instead of a call into GDAL.
+ *
+ * Only bands stored raw, uncompressed and in native byte order can be mapped
+ * (e.g. untiled, uncompressed GeoTIFF with one band or band interleaving,
+ * ENVI, EHdr). Other bands throw.
+ *
+ * Writes to a `"r+"` mapping go to the file. A `"r"` mapping is a private
+ * copy: writes to it are allowed but never reach the file. While a dataset has
+ * mappings, reads and writes through its other methods bypass GDAL's block
+ * cache so both views stay consistent, and a mapped array can't be passed to
+ * `read()` / `write()` on the same dataset.
+ *
+ * The array is detached (its length becomes 0) when the dataset is closed.
+ * Only supported on Linux.
+ *
+ * @example
+ * ```
+ * var data = band.pixels.map();
+ * var value = data[y * band.size.x + x];```
+ *
+ * @method map
+ * @throws Error
+ * @param {String} [mode="r"] `"r"` or `"r+"`
+ * @return {TypedArray}
+ */
+NAN_METHOD(RasterBandPixels::map)
+{
+	Nan::HandleScope scope;
+
+	Local<Object> parent = Nan::GetPrivate(info.This(), Nan::New("parent_").ToLocalChecked()).ToLocalChecked().As<Object>();
+	RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(parent);
+	if (!band->isAlive()) {
+		Nan::ThrowError("RasterBand object has already been destroyed");
+		return;
+	}
+
+	std::string mode = "r";
+	NODE_ARG_OPT_STR(0, "mode", mode);
+
+	GDALRWFlag flag;
+	if (mode == "r") {
+		flag = GF_Read;
+	} else if (mode == "r+") {
+		flag = GF_Write;
+	} else {
+		Nan::ThrowError("Invalid mode, must be \"r\" or \"r+\"");
+		return;
+	}
+
+	CPLErrorReset();
+	VirtualMem *mem;
+	{
+		DatasetSyncLock lock(band->uid);
+		mem = ptr_manager.createMapping(band->uid, band->get(), flag);
+	}
+	if (!mem) {
+		if (CPLGetLastErrorType() == CE_None) {
+			Nan::ThrowError("Error mapping band into memory");
+		} else {
+			NODE_THROW_LAST_CPLERR();
+		}
+		return;
+	}
+
+	info.GetReturnValue().Set(mem->array());
+}
+
+/**
+ * @readOnly
+ * @attribute band
+ * @type {gdal.RasterBand}
+ */
+NAN_GETTER(RasterBandPixels::bandGetter)
+{
+	Nan::HandleScope scope;
+	info.GetReturnValue().Set(Nan::GetPrivate(info.This(), Nan::New("parent_").ToLocalChecked()).ToLocalChecked());
+}
 
-}
\ No newline at end of file
+}
@@ -34,10 +34,22 @@ public:
 	static NAN_METHOD(write);
 	static NAN_METHOD(readBlock);
 	static NAN_METHOD(writeBlock);
+	static NAN_METHOD(readAsync);
+	static NAN_METHOD(writeAsync);
+	static NAN_METHOD(readBlockAsync);
+	static NAN_METHOD(writeBlockAsync);
+	static NAN_METHOD(map);
+
+	static NAN_GETTER(bandGetter);
 	
 	RasterBandPixels();
 private:
 	~RasterBandPixels();
+
+	static void doRead(NAN_METHOD_ARGS_TYPE info, bool async);
+	static void doWrite(NAN_METHOD_ARGS_TYPE info, bool async);
+	static void doReadBlock(NAN_METHOD_ARGS_TYPE info, bool async);
+	static void doWriteBlock(NAN_METHOD_ARGS_TYPE info, bool async);
 };
 
 }
@@ -3,6 +3,7 @@
 
 // node
 #include <node.h>
+#include <node_buffer.h>
 
 // nan
 #pragma GCC diagnostic push
@@ -10,6 +11,10 @@
 #include <nan.h>
 #pragma GCC diagnostic pop
 
+// gdal
+#include <cpl_atomic_ops.h>
+#include <cpl_vsi.h>
+
 // ogr
 #include <ogr_api.h>
 #include <ogrsf_frmts.h>
@@ -18,12 +23,74 @@
 #include "gdal_common.hpp"
 #include "gdal_driver.hpp"
 #include "gdal_dataset.hpp"
+#include "utils/dataset_pool.hpp"
+#include "utils/dataset_cache.hpp"
+#include "utils/buffer_path.hpp"
 
 using namespace v8;
 using namespace node;
 
 namespace node_gdal {
 
+	// Opens a dataset on the libuv threadpool; only wrapping the result
+	// (and registering it with the PtrManager) happens on the main thread.
+	class OpenWorker : public Nan::AsyncWorker {
+	public:
+		OpenWorker(Nan::Callback *callback, std::string path, std::string mode)
+			: Nan::AsyncWorker(callback), path(path), mode(mode), ds(NULL)
+			#if GDAL_VERSION_MAJOR < 2
+			, ogr_ds(NULL)
+			#endif
+		{}
+
+		void Execute()
+		{
+			#if GDAL_VERSION_MAJOR < 2
+				GDALAccess access = (mode == "r+") ? GA_Update : GA_ReadOnly;
+				ogr_ds = OGRSFDriverRegistrar::Open(path.c_str(), static_cast<int>(access));
+				if(!ogr_ds) {
+					ds = (GDALDataset*) GDALOpen(path.c_str(), access);
+				}
+				if(!ogr_ds && !ds) {
+					SetErrorMessage("Error opening dataset");
+				}
+			#else
+				unsigned int flags = (mode == "r+") ? GDAL_OF_UPDATE : GDAL_OF_READONLY;
+				ds = (GDALDataset*) GDALOpenEx(path.c_str(), flags, NULL, NULL, NULL);
+				if(!ds) {
+					SetErrorMessage("Error opening dataset");
+				}
+			#endif
+		}
+
+		void HandleOKCallback()
+		{
+			Nan::HandleScope scope;
+
+			Local<Value> result;
+			#if GDAL_VERSION_MAJOR < 2
+			if(ogr_ds) {
+				result = Dataset::New(ogr_ds);
+			} else {
+				result = Dataset::New(ds);
+			}
+			#else
+			result = Dataset::New(ds);
+			#endif
+
+			Local<Value> argv[] = { Nan::Null(), result };
+			callback->Call(2, argv, async_resource);
+		}
+
+	private:
+		std::string path;
+		std::string mode;
+		GDALDataset *ds;
+		#if GDAL_VERSION_MAJOR < 2
+		OGRDataSource *ogr_ds;
+		#endif
+	};
+
 	static NAN_METHOD(open)
 	{
 		Nan::HandleScope scope;
@@ -33,6 +100,7 @@ namespace node_gdal {
 
 		NODE_ARG_STR(0, "path", path);
 		NODE_ARG_OPT_STR(1, "mode", mode);
+		if (refuseBufferPath(path)) return;
 
 		#if GDAL_VERSION_MAJOR < 2
 			GDALAccess access = GA_ReadOnly;
@@ -76,6 +144,192 @@ namespace node_gdal {
 		return;
 	}
 
+	static NAN_METHOD(openAsync)
+	{
+		Nan::HandleScope scope;
+
+		std::string path;
+		std::string mode = "r";
+		Local<Function> callback;
+
+		NODE_ARG_STR(0, "path", path);
+		NODE_ARG_OPT_STR(1, "mode", mode);
+		NODE_ARG_CALLBACK(2, "callback", callback);
+		if (refuseBufferPath(path)) return;
+
+		if (mode != "r" && mode != "r+") {
+			Nan::ThrowError("Invalid open mode. Must be \"r\" or \"r+\"");
+			return;
+		}
+
+		Nan::AsyncQueueWorker(new OpenWorker(new Nan::Callback(callback), path, mode));
+	}
+
+	static NAN_METHOD(openPool)
+	{
+		Nan::HandleScope scope;
+
+		std::string path;
+		int size;
+
+		NODE_ARG_STR(0, "path", path);
+		NODE_ARG_INT(1, "size", size);
+		if (refuseBufferPath(path)) return;
+
+		if (size < 1) {
+			Nan::ThrowRangeError("Pool size must be at least 1");
+			return;
+		}
+
+		#if GDAL_VERSION_MAJOR < 2
+		GDALDataset *ds = (GDALDataset*) GDALOpen(path.c_str(), GA_ReadOnly);
+		#else
+		GDALDataset *ds = (GDALDataset*) GDALOpenEx(path.c_str(), GDAL_OF_RASTER | GDAL_OF_READONLY, NULL, NULL, NULL);
+		#endif
+		if (!ds) {
+			Nan::ThrowError("Error opening dataset");
+			return;
+		}
+
+		Local<Value> result = Dataset::New(ds);
+		Dataset *wrapped = Nan::ObjectWrap::Unwrap<Dataset>(result.As<Object>());
+
+		// the extra handles are opened by the first reads that need them
+		ptr_manager.createPool(wrapped->uid, path.c_str(), size);
+
+		info.GetReturnValue().Set(result);
+	}
+
+	static NAN_METHOD(openBuffer)
+	{
+		Nan::HandleScope scope;
+
+		Local<Object> buffer;
+		std::string hint = "";
+
+		NODE_ARG_OBJECT(0, "buffer", buffer);
+		NODE_ARG_OPT_STR(1, "hint", hint);
+
+		if (!Buffer::HasInstance(buffer)) {
+			Nan::ThrowTypeError("buffer must be a Buffer");
+			return;
+		}
+
+		// the file name only matters to drivers that look at the extension,
+		// so the hint may be a file name ("tile.png") or an extension (".png")
+		std::string filename = CPLGetFilename(hint.c_str());
+		if (filename.empty() || filename[0] == '.') filename = "buffer" + filename;
+
+		static volatile int counter = 0;
+		CPLString path;
+		path.Printf("%s%d/%s", BUFFER_PATH_PREFIX, CPLAtomicInc(&counter), filename.c_str());
+
+		// the file points into the Buffer's memory; it is never copied or freed by GDAL
+		VSILFILE *fp = VSIFileFromMemBuffer(path, (GByte*) Buffer::Data(buffer), Buffer::Length(buffer), FALSE);
+		if (!fp) {
+			NODE_THROW_LAST_CPLERR();
+			return;
+		}
+		VSIFCloseL(fp);
+
+		Local<Value> result;
+		#if GDAL_VERSION_MAJOR < 2
+			OGRDataSource *ogr_ds = OGRSFDriverRegistrar::Open(path, FALSE);
+			GDALDataset *ds = ogr_ds ? NULL : (GDALDataset*) GDALOpen(path, GA_ReadOnly);
+			if (!ogr_ds && !ds) {
+				VSIUnlink(path);
+				Nan::ThrowError("Error opening dataset");
+				return;
+			}
+			result = ogr_ds ? Dataset::New(ogr_ds) : Dataset::New(ds);
+		#else
+			GDALDataset *ds = (GDALDataset*) GDALOpenEx(path, GDAL_OF_READONLY, NULL, NULL, NULL);
+			if (!ds) {
+				VSIUnlink(path);
+				Nan::ThrowError("Error opening dataset");
+				return;
+			}
+			result = Dataset::New(ds);
+		#endif
+
+		Dataset *wrapped = Nan::ObjectWrap::Unwrap<Dataset>(result.As<Object>());
+		ptr_manager.attachBuffer(wrapped->uid, buffer, path);
+
+		info.GetReturnValue().Set(result);
+	}
+
+	static NAN_METHOD(openCached)
+	{
+		Nan::HandleScope scope;
+
+		std::string path;
+		NODE_ARG_STR(0, "path", path);
+		if (refuseBufferPath(path)) return;
+
+		CPLErrorReset();
+		CachedDataset *ds = CachedDataset::Open(path.c_str());
+		if (!ds) {
+			if (CPLGetLastErrorType() == CE_None) {
+				Nan::ThrowError("Error opening dataset");
+			} else {
+				NODE_THROW_LAST_CPLERR();
+			}
+			return;
+		}
+
+		info.GetReturnValue().Set(Dataset::New(ds));
+	}
+
+	static NAN_METHOD(getDatasetCacheStats)
+	{
+		Nan::HandleScope scope;
+
+		#ifndef BUNDLED_GDAL
+		// the counters are added by deps/libgdal/patches/gcore_gdalproxypool.diff
+		Nan::ThrowError("Dataset cache statistics require the bundled GDAL");
+		return;
+		#else
+		GIntBig hits, misses, evictions;
+		int open, max;
+		GDALGetDatasetPoolStats(&hits, &misses, &evictions, &open, &max);
+
+		Local<Object> result = Nan::New<Object>();
+		result->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>((double) hits));
+		result->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>((double) misses));
+		result->Set(Nan::New("evictions").ToLocalChecked(), Nan::New<Number>((double) evictions));
+		result->Set(Nan::New("open").ToLocalChecked(), Nan::New<Integer>(open));
+		result->Set(Nan::New("max").ToLocalChecked(), Nan::New<Integer>(max));
+
+		info.GetReturnValue().Set(result);
+		#endif
+	}
+
+	static NAN_METHOD(getBlockCacheStats)
+	{
+		Nan::HandleScope scope;
+
+		Local<Object> result = Nan::New<Object>();
+		result->Set(Nan::New("used").ToLocalChecked(), Nan::New<Number>((double) GDALGetCacheUsed64()));
+		result->Set(Nan::New("max").ToLocalChecked(), Nan::New<Number>((double) GDALGetCacheMax64()));
+
+		info.GetReturnValue().Set(result);
+	}
+
+	static NAN_METHOD(setBlockCacheMax)
+	{
+		Nan::HandleScope scope;
+
+		double max;
+		NODE_ARG_DOUBLE(0, "max", max);
+		if (max < 0) {
+			Nan::ThrowRangeError("Cache size must not be negative");
+			return;
+		}
+
+		// blocks over the new limit are flushed right away
+		GDALSetCacheMax64((GIntBig) max);
+	}
+
 	static NAN_METHOD(setConfigOption)
 	{
 		Nan::HandleScope scope;
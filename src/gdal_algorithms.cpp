@@ -4,6 +4,16 @@
 #include "gdal_dataset.hpp"
 #include "gdal_rasterband.hpp"
 #include "utils/number_list.hpp"
+#include "utils/dataset_worker.hpp"
+#include "utils/band_calc.hpp"
+#include "utils/zonal_stats.hpp"
+#include "utils/mosaic_builder.hpp"
+
+// gdal
+#include <cpl_multiproc.h>
+
+#include <string>
+#include <vector>
 
 namespace node_gdal {
 
@@ -14,22 +24,266 @@ void Algorithms::Initialize(Local<Object> target)
 	Nan::SetMethod(target, "sieveFilter", sieveFilter);
 	Nan::SetMethod(target, "checksumImage", checksumImage);
 	Nan::SetMethod(target, "polygonize", polygonize);
+	Nan::SetMethod(target, "calc", calc);
+	Nan::SetMethod(target, "zonalStats", zonalStats);
+	Nan::SetMethod(target, "buildVRT", buildVRT);
+
+	Nan::SetMethod(target, "fillNodataAsync", fillNodataAsync);
+	Nan::SetMethod(target, "contourGenerateAsync", contourGenerateAsync);
+	Nan::SetMethod(target, "sieveFilterAsync", sieveFilterAsync);
+	Nan::SetMethod(target, "checksumImageAsync", checksumImageAsync);
+	Nan::SetMethod(target, "polygonizeAsync", polygonizeAsync);
+	Nan::SetMethod(target, "calcAsync", calcAsync);
+	Nan::SetMethod(target, "zonalStatsAsync", zonalStatsAsync);
+	Nan::SetMethod(target, "buildVRTAsync", buildVRTAsync);
 }
 
-/**
- * Fill raster regions by interpolation from edges.
- *
- * @throws Error
- * @method fillNodata
- * @static
- * @for gdal
- * @param {Object} options
- * @param {gdal.RasterBand} options.src This band to be updated in-place.
- * @param {gdal.RasterBand} [options.mask] Mask band
- * @param {Number} options.searchDist The maximum distance (in pixels) that the algorithm will search out for values to interpolate.
- * @param {integer} [options.smoothingIterations=0] The number of 3x3 average filter smoothing iterations to run after the interpolation to dampen artifacts.
- */
-NAN_METHOD(Algorithms::fillNodata)
+// Each algorithm is parsed into a job that can run either immediately (sync
+// methods) or on the libuv threadpool (async methods). Jobs only hold raw GDAL
+// pointers; the async path keeps the JS objects owning them alive.
+
+// Runs an algorithm job on the libuv threadpool while holding the locks of
+// every dataset it touches
+template<class Job>
+class AlgorithmWorker : public DatasetProgressWorker {
+public:
+	AlgorithmWorker(Nan::Callback *callback, const Job &job)
+		: DatasetProgressWorker(callback), job(job)
+	{}
+
+	void addDependency(const char *key, Local<Value> obj, long uid)
+	{
+		SaveToPersistent(key, obj);
+		addDataset(uid);
+	}
+
+protected:
+	void Run()
+	{
+		if(job.run(ProgressFunc, this)) {
+			SetCPLErrorMessage();
+		}
+	}
+
+	Local<Value> GetResult()
+	{
+		return job.result();
+	}
+
+private:
+	Job job;
+};
+
+// Reads the (progress, cancel token, callback) arguments following the regular
+// arguments of an async algorithm method. Returns NULL with a JS exception pending on error.
+template<class Job>
+static AlgorithmWorker<Job>* createWorker(NAN_METHOD_ARGS_TYPE info, const Job &job, int argc)
+{
+	if(info.Length() > argc && !info[argc]->IsNull() && !info[argc]->IsUndefined() && !info[argc]->IsFunction()){
+		Nan::ThrowTypeError("progress must be a function");
+		return NULL;
+	}
+	if(info.Length() > argc + 1 && !info[argc + 1]->IsNull() && !info[argc + 1]->IsUndefined() && !info[argc + 1]->IsInt32Array()){
+		Nan::ThrowTypeError("cancel token must be a gdal.CancelToken");
+		return NULL;
+	}
+	if(info.Length() < argc + 3 || !info[argc + 2]->IsFunction()){
+		Nan::ThrowTypeError("callback must be a function");
+		return NULL;
+	}
+
+	AlgorithmWorker<Job> *worker = new AlgorithmWorker<Job>(new Nan::Callback(info[argc + 2].As<Function>()), job);
+	if(info[argc]->IsFunction()) worker->setProgressCallback(info[argc].As<Function>());
+	if(info[argc + 1]->IsInt32Array()) worker->setCancelToken(info[argc + 1].As<Object>());
+	return worker;
+}
+
+struct FillNodataJob {
+	GDALRasterBand *src;
+	GDALRasterBand *mask;
+	double search_dist;
+	int smooth_iterations;
+
+	CPLErr run(GDALProgressFunc pfnProgress, void *pProgressArg)
+	{
+		return GDALFillNodata(src, mask, search_dist, 0, smooth_iterations, NULL, pfnProgress, pProgressArg);
+	}
+	Local<Value> result()
+	{
+		return Nan::Undefined();
+	}
+};
+
+struct ContourGenerateJob {
+	GDALRasterBand *src;
+	OGRLayer *dst;
+	double interval;
+	double base;
+	std::vector<double> fixed_levels;
+	int use_nodata;
+	double nodata;
+	int id_field;
+	int elev_field;
+
+	CPLErr run(GDALProgressFunc pfnProgress, void *pProgressArg)
+	{
+		return GDALContourGenerate(src, interval, base, fixed_levels.size(), fixed_levels.empty() ? NULL : &fixed_levels[0], use_nodata, nodata, dst, id_field, elev_field, pfnProgress, pProgressArg);
+	}
+	Local<Value> result()
+	{
+		return Nan::Undefined();
+	}
+};
+
+struct SieveFilterJob {
+	GDALRasterBand *src;
+	GDALRasterBand *dst;
+	GDALRasterBand *mask;
+	int threshold;
+	int connectedness;
+
+	CPLErr run(GDALProgressFunc pfnProgress, void *pProgressArg)
+	{
+		return GDALSieveFilter(src, mask, dst, threshold, connectedness, NULL, pfnProgress, pProgressArg);
+	}
+	Local<Value> result()
+	{
+		return Nan::Undefined();
+	}
+};
+
+// GDALChecksumImage() has no progress hook; async jobs can only be cancelled before they start
+struct ChecksumImageJob {
+	GDALRasterBand *src;
+	int x, y, w, h;
+	int checksum;
+
+	CPLErr run(GDALProgressFunc, void *)
+	{
+		checksum = GDALChecksumImage(src, x, y, w, h);
+		return CE_None;
+	}
+	Local<Value> result()
+	{
+		return Nan::New<Integer>(checksum);
+	}
+};
+
+struct PolygonizeJob {
+	GDALRasterBand *src;
+	GDALRasterBand *mask;
+	OGRLayer *dst;
+	int pix_val_field;
+	int connectedness;
+	bool use_floats;
+
+	CPLErr run(GDALProgressFunc pfnProgress, void *pProgressArg)
+	{
+		CPLErr err;
+		char** papszOptions = NULL;
+
+		if(connectedness == 8) {
+			papszOptions = CSLSetNameValue(papszOptions, "8CONNECTED", "8");
+		}
+
+		if(use_floats){
+			err = GDALFPolygonize(src, mask, reinterpret_cast<OGRLayerH>(dst), pix_val_field, papszOptions, pfnProgress, pProgressArg);
+		} else {
+			err = GDALPolygonize(src, mask, reinterpret_cast<OGRLayerH>(dst), pix_val_field, papszOptions, pfnProgress, pProgressArg);
+		}
+
+		if(papszOptions) CSLDestroy(papszOptions);
+		return err;
+	}
+	Local<Value> result()
+	{
+		return Nan::Undefined();
+	}
+};
+
+struct CalcJob {
+	CalcExpression expression;
+	std::vector<GDALRasterBand*> inputs;
+	GDALRasterBand *dst;
+	bool set_nodata;
+	bool dst_has_nodata;
+	double dst_nodata;
+	int threads;
+
+	CPLErr run(GDALProgressFunc pfnProgress, void *pProgressArg)
+	{
+		if(set_nodata) {
+			CPLErr err = dst->SetNoDataValue(dst_nodata);
+			if(err) return err;
+		}
+		return calculateBands(expression, inputs, dst, dst_has_nodata, dst_nodata, threads, pfnProgress, pProgressArg);
+	}
+	Local<Value> result()
+	{
+		return Nan::Undefined();
+	}
+};
+
+struct ZonalStatsJob {
+	OGRLayer *layer;
+	GDALRasterBand *band;
+	ZonalStatsOptions options;
+	bool stat_count, stat_sum, stat_min, stat_max, stat_mean;
+	std::vector<ZoneStats> zones;
+
+	CPLErr run(GDALProgressFunc pfnProgress, void *pProgressArg)
+	{
+		return computeZonalStats(layer, band, options, zones, pfnProgress, pProgressArg);
+	}
+	Local<Value> result()
+	{
+		Nan::EscapableHandleScope scope;
+
+		Local<Array> results = Nan::New<Array>(zones.size());
+		for(size_t i = 0; i < zones.size(); i++) {
+			const ZoneStats &zone = zones[i];
+			Local<Object> obj = Nan::New<Object>();
+			obj->Set(Nan::New("fid").ToLocalChecked(), Nan::New<Number>((double) zone.fid));
+			if(stat_count) obj->Set(Nan::New("count").ToLocalChecked(), Nan::New<Number>((double) zone.count));
+			if(stat_sum) obj->Set(Nan::New("sum").ToLocalChecked(), Nan::New<Number>(zone.sum));
+			if(zone.count) {
+				if(stat_min) obj->Set(Nan::New("min").ToLocalChecked(), Nan::New<Number>(zone.min));
+				if(stat_max) obj->Set(Nan::New("max").ToLocalChecked(), Nan::New<Number>(zone.max));
+				if(stat_mean) obj->Set(Nan::New("mean").ToLocalChecked(), Nan::New<Number>(zone.sum / zone.count));
+			} else {
+				if(stat_min) obj->Set(Nan::New("min").ToLocalChecked(), Nan::Null());
+				if(stat_max) obj->Set(Nan::New("max").ToLocalChecked(), Nan::Null());
+				if(stat_mean) obj->Set(Nan::New("mean").ToLocalChecked(), Nan::Null());
+			}
+			if(options.histogram) {
+				Local<Array> histogram = Nan::New<Array>(zone.histogram.size());
+				for(size_t b = 0; b < zone.histogram.size(); b++) {
+					histogram->Set(b, Nan::New<Number>((double) zone.histogram[b]));
+				}
+				obj->Set(Nan::New("histogram").ToLocalChecked(), histogram);
+			}
+			results->Set(i, obj);
+		}
+		return scope.Escape(results);
+	}
+};
+
+struct BuildVRTJob {
+	std::vector<std::string> files;
+	MosaicOptions options;
+	GDALDataset *ds;
+
+	CPLErr run(GDALProgressFunc pfnProgress, void *pProgressArg)
+	{
+		return buildMosaic(files, options, &ds, pfnProgress, pProgressArg);
+	}
+	Local<Value> result()
+	{
+		return Dataset::New(ds);
+	}
+};
+
+static void doFillNodata(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -46,7 +300,24 @@ NAN_METHOD(Algorithms::fillNodata)
 	NODE_DOUBLE_FROM_OBJ(obj, "searchDist", search_dist);
 	NODE_INT_FROM_OBJ_OPT(obj, "smoothIterations", smooth_iterations)
 
-	CPLErr err = GDALFillNodata(src->get(), mask ? mask->get() : NULL, search_dist, 0, smooth_iterations, NULL, NULL, NULL);
+	FillNodataJob job;
+	job.src = src->get();
+	job.mask = mask ? mask->get() : NULL;
+	job.search_dist = search_dist;
+	job.smooth_iterations = smooth_iterations;
+
+	if(async) {
+		AlgorithmWorker<FillNodataJob> *worker = createWorker(info, job, 1);
+		if(!worker) return;
+		worker->addDependency("src", obj->Get(Nan::New("src").ToLocalChecked()), src->uid);
+		if(mask) worker->addDependency("mask", obj->Get(Nan::New("mask").ToLocalChecked()), mask->uid);
+		worker->queue();
+		return;
+	}
+
+	DatasetSyncLock lock(src->uid);
+	if(mask) lock.add(mask->uid);
+	CPLErr err = job.run(NULL, NULL);
 
 	if(err) {
 		NODE_THROW_CPLERR(err);
@@ -57,28 +328,24 @@ NAN_METHOD(Algorithms::fillNodata)
 }
 
 /**
- * Create vector contours from raster DEM.
- *
- * This algorithm will generate contour vectors for the input raster band on the
- * requested set of contour levels. The vector contours are written to the passed
- * in vector layer. Also, a NODATA value may be specified to identify pixels
- * that should not be considered in contour line generation.
+ * Fill raster regions by interpolation from edges.
  *
  * @throws Error
- * @method contourGenerate
+ * @method fillNodata
  * @static
  * @for gdal
  * @param {Object} options
- * @param {gdal.RasterBand} options.src
- * @param {gdal.Layer} options.dst
- * @param {Number} [options.offset=0] The "offset" relative to which contour intervals are applied. This is normally zero, but could be different. To generate 10m contours at 5, 15, 25, ... the offset would be 5.
- * @param {Number} [options.interval=100] The elevation interval between contours generated.
- * @param {Number[]} [options.fixedLevels] A list of fixed contour levels at which contours should be generated. Overrides interval/base options if set.
- * @param {Number} [options.nodata] The value to use as a "nodata" value. That is, a pixel value which should be ignored in generating contours as if the value of the pixel were not known.
- * @param {integer} [options.idField] A field index to indicate where a unique id should be written for each feature (contour) written.
- * @param {integer} [options.elevField] A field index to indicate where the elevation value of the contour should be written.
+ * @param {gdal.RasterBand} options.src This band to be updated in-place.
+ * @param {gdal.RasterBand} [options.mask] Mask band
+ * @param {Number} options.searchDist The maximum distance (in pixels) that the algorithm will search out for values to interpolate.
+ * @param {integer} [options.smoothingIterations=0] The number of 3x3 average filter smoothing iterations to run after the interpolation to dampen artifacts.
  */
-NAN_METHOD(Algorithms::contourGenerate)
+NAN_METHOD(Algorithms::fillNodata)
+{
+	doFillNodata(info, false);
+}
+
+static void doContourGenerate(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -87,9 +354,7 @@ NAN_METHOD(Algorithms::contourGenerate)
 	RasterBand* src;
 	Layer* dst;
 	double interval = 100, base = 0;
-	double *fixed_levels = NULL;
 	DoubleList fixed_level_array;
-	int n_fixed_levels = 0;
 	int use_nodata = 0;
 	double nodata = 0;
 	int id_field = -1, elev_field = -1;
@@ -105,9 +370,6 @@ NAN_METHOD(Algorithms::contourGenerate)
 	if(Nan::HasOwnProperty(obj, Nan::New("fixedLevels").ToLocalChecked()).FromMaybe(false)){
 		if(fixed_level_array.parse(obj->Get(Nan::New("fixedLevels").ToLocalChecked()))){
 			return; //error parsing double list
-		} else {
-			fixed_levels = fixed_level_array.get();
-			n_fixed_levels = fixed_level_array.length();
 		}
 	}
 	if(Nan::HasOwnProperty(obj, Nan::New("nodata").ToLocalChecked()).FromMaybe(false)){
@@ -117,10 +379,35 @@ NAN_METHOD(Algorithms::contourGenerate)
 			nodata = prop->NumberValue();
 		} else if(!prop->IsNull() && !prop->IsUndefined()){
 			Nan::ThrowTypeError("nodata property must be a number");
+			return;
 		}
 	}
 
-	CPLErr err = GDALContourGenerate(src->get(), interval, base, n_fixed_levels, fixed_levels, use_nodata, nodata, dst->get(), id_field, elev_field, NULL, NULL);
+	ContourGenerateJob job;
+	job.src = src->get();
+	job.dst = dst->get();
+	job.interval = interval;
+	job.base = base;
+	if(fixed_level_array.length() > 0) {
+		job.fixed_levels.assign(fixed_level_array.get(), fixed_level_array.get() + fixed_level_array.length());
+	}
+	job.use_nodata = use_nodata;
+	job.nodata = nodata;
+	job.id_field = id_field;
+	job.elev_field = elev_field;
+
+	if(async) {
+		AlgorithmWorker<ContourGenerateJob> *worker = createWorker(info, job, 1);
+		if(!worker) return;
+		worker->addDependency("src", obj->Get(Nan::New("src").ToLocalChecked()), src->uid);
+		worker->addDependency("dst", obj->Get(Nan::New("dst").ToLocalChecked()), dst->uid);
+		worker->queue();
+		return;
+	}
+
+	DatasetSyncLock lock(src->uid);
+	lock.add(dst->uid);
+	CPLErr err = job.run(NULL, NULL);
 
 	if(err) {
 		NODE_THROW_CPLERR(err);
@@ -131,20 +418,33 @@ NAN_METHOD(Algorithms::contourGenerate)
 }
 
 /**
- * Removes small raster polygons.
+ * Create vector contours from raster DEM.
+ *
+ * This algorithm will generate contour vectors for the input raster band on the
+ * requested set of contour levels. The vector contours are written to the passed
+ * in vector layer. Also, a NODATA value may be specified to identify pixels
+ * that should not be considered in contour line generation.
  *
  * @throws Error
- * @method sieveFilter
+ * @method contourGenerate
  * @static
  * @for gdal
  * @param {Object} options
  * @param {gdal.RasterBand} options.src
- * @param {gdal.RasterBand} options.dst Output raster band. It may be the same as src band to update the source in place.
- * @param {gdal.RasterBand} [options.mask] All pixels in the mask band with a value other than zero will be considered suitable for inclusion in polygons.
- * @param {Number} options.threshold Raster polygons with sizes smaller than this will be merged into their largest neighbour.
- * @param {integer} [options.connectedness=4] Either 4 indicating that diagonal pixels are not considered directly adjacent for polygon membership purposes or 8 indicating they are.
+ * @param {gdal.Layer} options.dst
+ * @param {Number} [options.offset=0] The "offset" relative to which contour intervals are applied. This is normally zero, but could be different. To generate 10m contours at 5, 15, 25, ... the offset would be 5.
+ * @param {Number} [options.interval=100] The elevation interval between contours generated.
+ * @param {Number[]} [options.fixedLevels] A list of fixed contour levels at which contours should be generated. Overrides interval/base options if set.
+ * @param {Number} [options.nodata] The value to use as a "nodata" value. That is, a pixel value which should be ignored in generating contours as if the value of the pixel were not known.
+ * @param {integer} [options.idField] A field index to indicate where a unique id should be written for each feature (contour) written.
+ * @param {integer} [options.elevField] A field index to indicate where the elevation value of the contour should be written.
  */
-NAN_METHOD(Algorithms::sieveFilter)
+NAN_METHOD(Algorithms::contourGenerate)
+{
+	doContourGenerate(info, false);
+}
+
+static void doSieveFilter(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -168,7 +468,27 @@ NAN_METHOD(Algorithms::sieveFilter)
 		return;
 	}
 
-	CPLErr err = GDALSieveFilter(src->get(), mask ? mask->get() : NULL, dst->get(), threshold, connectedness, NULL, NULL, NULL);
+	SieveFilterJob job;
+	job.src = src->get();
+	job.dst = dst->get();
+	job.mask = mask ? mask->get() : NULL;
+	job.threshold = threshold;
+	job.connectedness = connectedness;
+
+	if(async) {
+		AlgorithmWorker<SieveFilterJob> *worker = createWorker(info, job, 1);
+		if(!worker) return;
+		worker->addDependency("src", obj->Get(Nan::New("src").ToLocalChecked()), src->uid);
+		worker->addDependency("dst", obj->Get(Nan::New("dst").ToLocalChecked()), dst->uid);
+		if(mask) worker->addDependency("mask", obj->Get(Nan::New("mask").ToLocalChecked()), mask->uid);
+		worker->queue();
+		return;
+	}
+
+	DatasetSyncLock lock(src->uid);
+	lock.add(dst->uid);
+	if(mask) lock.add(mask->uid);
+	CPLErr err = job.run(NULL, NULL);
 
 	if(err) {
 		NODE_THROW_CPLERR(err);
@@ -179,20 +499,25 @@ NAN_METHOD(Algorithms::sieveFilter)
 }
 
 /**
- * Compute checksum for image region.
+ * Removes small raster polygons.
  *
  * @throws Error
- * @method checksumImage
+ * @method sieveFilter
  * @static
  * @for gdal
- * @param {gdal.RasterBand} src
- * @param {integer} [x=0]
- * @param {integer} [y=0]
- * @param {integer} [w=src.width]
- * @param {integer} [h=src.height]
- * @return integer
+ * @param {Object} options
+ * @param {gdal.RasterBand} options.src
+ * @param {gdal.RasterBand} options.dst Output raster band. It may be the same as src band to update the source in place.
+ * @param {gdal.RasterBand} [options.mask] All pixels in the mask band with a value other than zero will be considered suitable for inclusion in polygons.
+ * @param {Number} options.threshold Raster polygons with sizes smaller than this will be merged into their largest neighbour.
+ * @param {integer} [options.connectedness=4] Either 4 indicating that diagonal pixels are not considered directly adjacent for polygon membership purposes or 8 indicating they are.
  */
-NAN_METHOD(Algorithms::checksumImage)
+NAN_METHOD(Algorithms::sieveFilter)
+{
+	doSieveFilter(info, false);
+}
+
+static void doChecksumImage(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
@@ -222,9 +547,100 @@ NAN_METHOD(Algorithms::checksumImage)
 		return;
 	}
 
-	int checksum = GDALChecksumImage(src->get(), x, y, w, h);
+	ChecksumImageJob job;
+	job.src = src->get();
+	job.x = x;
+	job.y = y;
+	job.w = w;
+	job.h = h;
+	job.checksum = 0;
 
-	info.GetReturnValue().Set(Nan::New<Integer>(checksum));
+	if(async) {
+		AlgorithmWorker<ChecksumImageJob> *worker = createWorker(info, job, 5);
+		if(!worker) return;
+		worker->addDependency("src", info[0], src->uid);
+		worker->queue();
+		return;
+	}
+
+	DatasetSyncLock lock(src->uid);
+	job.run(NULL, NULL);
+
+	info.GetReturnValue().Set(job.result());
+}
+
+/**
+ * Compute checksum for image region.
+ *
+ * @throws Error
+ * @method checksumImage
+ * @static
+ * @for gdal
+ * @param {gdal.RasterBand} src
+ * @param {integer} [x=0]
+ * @param {integer} [y=0]
+ * @param {integer} [w=src.width]
+ * @param {integer} [h=src.height]
+ * @return integer
+ */
+NAN_METHOD(Algorithms::checksumImage)
+{
+	doChecksumImage(info, false);
+}
+
+static void doPolygonize(NAN_METHOD_ARGS_TYPE info, bool async)
+{
+	Nan::HandleScope scope;
+
+	Local<Object> obj;
+	RasterBand* src;
+	RasterBand* mask = NULL;
+	Layer* dst;
+	int connectedness = 4;
+	int pix_val_field = 0;
+
+	NODE_ARG_OBJECT(0, "options", obj);
+
+	NODE_WRAPPED_FROM_OBJ(obj, "src", RasterBand, src);
+	NODE_WRAPPED_FROM_OBJ(obj, "dst", Layer, dst);
+	NODE_WRAPPED_FROM_OBJ_OPT(obj, "mask", RasterBand, mask);
+	NODE_INT_FROM_OBJ_OPT(obj, "connectedness", connectedness)
+	NODE_INT_FROM_OBJ(obj, "pixValField", pix_val_field);
+
+	if(connectedness != 4 && connectedness != 8) {
+		Nan::ThrowError("connectedness must be 4 or 8");
+		return;
+	}
+
+	PolygonizeJob job;
+	job.src = src->get();
+	job.mask = mask ? mask->get() : NULL;
+	job.dst = dst->get();
+	job.pix_val_field = pix_val_field;
+	job.connectedness = connectedness;
+	job.use_floats = Nan::HasOwnProperty(obj, Nan::New("useFloats").ToLocalChecked()).FromMaybe(false) && obj->Get(Nan::New("useFloats").ToLocalChecked())->BooleanValue();
+
+	if(async) {
+		AlgorithmWorker<PolygonizeJob> *worker = createWorker(info, job, 1);
+		if(!worker) return;
+		worker->addDependency("src", obj->Get(Nan::New("src").ToLocalChecked()), src->uid);
+		worker->addDependency("dst", obj->Get(Nan::New("dst").ToLocalChecked()), dst->uid);
+		if(mask) worker->addDependency("mask", obj->Get(Nan::New("mask").ToLocalChecked()), mask->uid);
+		worker->queue();
+		return;
+	}
+
+	DatasetSyncLock lock(src->uid);
+	lock.add(dst->uid);
+	if(mask) lock.add(mask->uid);
+	CPLErr err = job.run(NULL, NULL);
+
+	if(err) {
+		NODE_THROW_CPLERR(err);
+		return;
+	}
+
+	return;
 }
 
 /**
@@ -246,40 +662,106 @@ NAN_METHOD(Algorithms::checksumImage)
  * @param {Boolean} [options.useFloats=false] Use floating point buffers instead of int buffers.
  */
 NAN_METHOD(Algorithms::polygonize)
+{
+	doPolygonize(info, false);
+}
+
+static void doCalc(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 
 	Local<Object> obj;
-	RasterBand* src;
-	RasterBand* mask = NULL;
-	Layer* dst;
-	int connectedness = 4;
-	int pix_val_field = 0;
-	char** papszOptions = NULL;
+	Local<Object> inputs_obj;
+	RasterBand* dst;
+	std::string expression;
+	int threads = CPLGetNumCPUs();
 
 	NODE_ARG_OBJECT(0, "options", obj);
 
-	NODE_WRAPPED_FROM_OBJ(obj, "src", RasterBand, src);
-	NODE_WRAPPED_FROM_OBJ(obj, "dst", Layer, dst);
-	NODE_WRAPPED_FROM_OBJ_OPT(obj, "mask", RasterBand, mask);
-	NODE_INT_FROM_OBJ_OPT(obj, "connectedness", connectedness)
-	NODE_INT_FROM_OBJ(obj, "pixValField", pix_val_field);
+	NODE_WRAPPED_FROM_OBJ(obj, "dst", RasterBand, dst);
+	NODE_STR_FROM_OBJ(obj, "expression", expression);
+	NODE_INT_FROM_OBJ_OPT(obj, "threads", threads);
 
-	if(connectedness == 8) {
-		papszOptions = CSLSetNameValue(papszOptions, "8CONNECTED", "8");
-	} else if (connectedness != 4) {
-		Nan::ThrowError("connectedness must be 4 or 8");
+	Local<Value> inputs_val = obj->Get(Nan::New("inputs").ToLocalChecked());
+	if(!inputs_val->IsObject() || inputs_val->IsNull()) {
+		Nan::ThrowTypeError("Property \"inputs\" must be an object mapping names to RasterBand objects");
+		return;
+	}
+	inputs_obj = inputs_val.As<Object>();
+
+	if(threads < 1) {
+		Nan::ThrowRangeError("threads must be greater than 0");
+		return;
+	}
+
+	CalcJob job;
+	job.dst = dst->get();
+	job.threads = threads;
+
+	int width = job.dst->GetXSize();
+	int height = job.dst->GetYSize();
+
+	std::vector<std::string> names;
+	std::vector<RasterBand*> bands;
+	Local<Array> keys = Nan::GetOwnPropertyNames(inputs_obj).ToLocalChecked();
+	for(unsigned int i = 0; i < keys->Length(); i++) {
+		Local<Value> key = keys->Get(i);
+		Local<Value> val = inputs_obj->Get(key);
+		std::string name = *Nan::Utf8String(key);
+		if(!val->IsObject() || !Nan::New(RasterBand::constructor)->HasInstance(val)) {
+			Nan::ThrowTypeError(("Input \"" + name + "\" must be a RasterBand object").c_str());
+			return;
+		}
+		RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(val.As<Object>());
+		if(!band->isAlive()) {
+			Nan::ThrowError(("Input \"" + name + "\": RasterBand object has already been destroyed").c_str());
+			return;
+		}
+		if(band->get()->GetXSize() != width || band->get()->GetYSize() != height) {
+			Nan::ThrowError(("Input \"" + name + "\" must have the same size as the destination band").c_str());
+			return;
+		}
+		names.push_back(name);
+		bands.push_back(band);
+		job.inputs.push_back(band->get());
+	}
+
+	std::string error;
+	if(!job.expression.compile(expression, names, error)) {
+		Nan::ThrowError(("Invalid expression: " + error).c_str());
+		return;
+	}
+
+	int has_nodata = 0;
+	job.dst_nodata = job.dst->GetNoDataValue(&has_nodata);
+	job.dst_has_nodata = has_nodata;
+	job.set_nodata = false;
+	Local<Value> nodata = obj->Get(Nan::New("nodata").ToLocalChecked());
+	if(nodata->IsNumber()) {
+		job.dst_nodata = nodata->NumberValue();
+		job.dst_has_nodata = true;
+		job.set_nodata = true;
+	} else if(!nodata->IsNull() && !nodata->IsUndefined()) {
+		Nan::ThrowTypeError("Property \"nodata\" must be a number");
 		return;
 	}
 
-	CPLErr err;
-	if(Nan::HasOwnProperty(obj, Nan::New("useFloats").ToLocalChecked()).FromMaybe(false) && obj->Get(Nan::New("useFloats").ToLocalChecked())->BooleanValue()){
-		err = GDALFPolygonize(src->get(), mask ? mask->get() : NULL, reinterpret_cast<OGRLayerH>(dst->get()), pix_val_field, papszOptions, NULL, NULL);
-	} else {
-		err = GDALPolygonize(src->get(), mask ? mask->get() : NULL, reinterpret_cast<OGRLayerH>(dst->get()), pix_val_field, papszOptions, NULL, NULL);
+	if(async) {
+		AlgorithmWorker<CalcJob> *worker = createWorker(info, job, 1);
+		if(!worker) return;
+		worker->addDependency("dst", obj->Get(Nan::New("dst").ToLocalChecked()), dst->uid);
+		for(size_t i = 0; i < bands.size(); i++) {
+			worker->addDependency(("input:" + names[i]).c_str(), inputs_obj->Get(keys->Get(i)), bands[i]->uid);
+		}
+		worker->queue();
+		return;
 	}
 
-	if(papszOptions) CSLDestroy(papszOptions);
+	DatasetSyncLock lock(dst->uid);
+	for(size_t i = 0; i < bands.size(); i++) {
+		lock.add(bands[i]->uid);
+	}
+	CPLErr err = job.run(NULL, NULL);
 
 	if(err) {
 		NODE_THROW_CPLERR(err);
@@ -289,4 +771,342 @@ NAN_METHOD(Algorithms::polygonize)
 	return;
 }
 
+/**
+ * Evaluates a pixel-wise expression over a set of named bands and writes the
+ * result to a destination band.
+ *
+ * The expression is compiled once and applied to whole chunks of scanlines at
+ * a time, with chunks spread across several threads. It supports numbers, the
+ * input names, `+ - * / % ^`, comparisons (`< <= > >= == !=`), `&& || !`
+ * (yielding 1 or 0), parentheses and the functions `abs sqrt exp log log10
+ * floor ceil round isnan sin cos tan min max pow atan2` and `where(cond, a, b)`.
+ * Values are computed as doubles and converted to the destination band's type.
+ *
+ * A pixel is nodata in the result if it is nodata in any input band or if the
+ * expression yields NaN (e.g. `0 / 0`).
+ *
+ * @example
+ * ```
+ * gdal.calc({
+ *     inputs: {red: ds.bands.get(3), nir: ds.bands.get(4)},
+ *     dst: ndvi.bands.get(1),
+ *     expression: '(nir - red) / (nir + red)',
+ *     nodata: -9999
+ * });```
+ *
+ * @throws Error
+ * @method calc
+ * @static
+ * @for gdal
+ * @param {Object} options
+ * @param {Object} options.inputs An object mapping the names used in the expression to {{#crossLink "gdal.RasterBand"}}RasterBand{{/crossLink}} objects. All bands must have the size of the destination band.
+ * @param {gdal.RasterBand} options.dst
+ * @param {String} options.expression
+ * @param {Number} [options.nodata] Value to write for nodata pixels; it is also set as the destination band's nodata value. Defaults to the destination band's nodata value. If the band has none, no nodata value is set and nodata pixels are written as NaN, or as 0 in integer bands: give `nodata` to tell them apart from real zeros there.
+ * @param {integer} [options.threads] Number of threads evaluating the expression. Defaults to the number of CPUs.
+ */
+NAN_METHOD(Algorithms::calc)
+{
+	doCalc(info, false);
+}
+
+static void doZonalStats(NAN_METHOD_ARGS_TYPE info, bool async)
+{
+	Nan::HandleScope scope;
+
+	Layer* layer;
+	RasterBand* band;
+	Local<Object> obj;
+
+	NODE_ARG_WRAPPED(0, "layer", Layer, layer);
+	NODE_ARG_WRAPPED(1, "band", RasterBand, band);
+
+	ZonalStatsJob job;
+	job.layer = layer->get();
+	job.band = band->get();
+	job.options.all_touched = false;
+	job.options.histogram = false;
+	job.options.hist_min = 0;
+	job.options.hist_max = 0;
+	job.options.buckets = 256;
+	job.options.threads = CPLGetNumCPUs();
+	job.stat_count = job.stat_sum = job.stat_min = job.stat_max = job.stat_mean = true;
+
+	if(info.Length() > 2 && !info[2]->IsNull() && !info[2]->IsUndefined()) {
+		NODE_ARG_OBJECT(2, "options", obj);
+		NODE_INT_FROM_OBJ_OPT(obj, "threads", job.options.threads);
+		job.options.all_touched = obj->Get(Nan::New("allTouched").ToLocalChecked())->BooleanValue();
+
+		Local<Value> stats = obj->Get(Nan::New("stats").ToLocalChecked());
+		if(stats->IsArray()) {
+			Local<Array> array = stats.As<Array>();
+			job.stat_count = job.stat_sum = job.stat_min = job.stat_max = job.stat_mean = false;
+			for(unsigned int i = 0; i < array->Length(); i++) {
+				std::string name = *Nan::Utf8String(array->Get(i));
+				if(name == "count") job.stat_count = true;
+				else if(name == "sum") job.stat_sum = true;
+				else if(name == "min") job.stat_min = true;
+				else if(name == "max") job.stat_max = true;
+				else if(name == "mean") job.stat_mean = true;
+				else if(name == "histogram") job.options.histogram = true;
+				else {
+					Nan::ThrowError(("Unknown statistic \"" + name + "\"").c_str());
+					return;
+				}
+			}
+		} else if(!stats->IsNull() && !stats->IsUndefined()) {
+			Nan::ThrowTypeError("stats must be an array of strings");
+			return;
+		}
+
+		if(job.options.histogram) {
+			Local<Value> histogram = obj->Get(Nan::New("histogram").ToLocalChecked());
+			if(histogram->IsObject()) {
+				Local<Object> range = histogram.As<Object>();
+				NODE_DOUBLE_FROM_OBJ(range, "min", job.options.hist_min);
+				NODE_DOUBLE_FROM_OBJ(range, "max", job.options.hist_max);
+				NODE_INT_FROM_OBJ_OPT(range, "buckets", job.options.buckets);
+			} else if(job.band->GetRasterDataType() == GDT_Byte) {
+				job.options.hist_max = 255;
+			} else {
+				Nan::ThrowError("histogram option ({min, max, buckets}) is required for the histogram of non-Byte bands");
+				return;
+			}
+			if(!(job.options.hist_min <= job.options.hist_max) || job.options.buckets < 1) {
+				Nan::ThrowRangeError("histogram must have min <= max and at least one bucket");
+				return;
+			}
+		}
+	}
+
+	if(job.options.threads < 1) {
+		Nan::ThrowRangeError("threads must be greater than 0");
+		return;
+	}
+
+	if(async) {
+		AlgorithmWorker<ZonalStatsJob> *worker = createWorker(info, job, 3);
+		if(!worker) return;
+		worker->addDependency("layer", info[0], layer->uid);
+		worker->addDependency("band", info[1], band->uid);
+		worker->queue();
+		return;
+	}
+
+	DatasetSyncLock lock(layer->uid);
+	lock.add(band->uid);
+	CPLErr err = job.run(NULL, NULL);
+
+	if(err) {
+		NODE_THROW_CPLERR(err);
+		return;
+	}
+
+	info.GetReturnValue().Set(job.result());
+}
+
+/**
+ * Computes statistics of the pixels of a band covered by each feature of a
+ * layer, in a single pass over the band.
+ *
+ * The band is processed in chunks of block rows spread over several threads;
+ * the features overlapping each chunk are rasterized into a zone id buffer and
+ * the chunk's pixels are accumulated into the zone they fall in. Geometries
+ * are reprojected to the raster's spatial reference when both are known.
+ * Overlapping features each count every pixel they cover. Nodata pixels are
+ * skipped.
+ *
+ * @example
+ * ```
+ * var zones = gdal.zonalStats(parcels, dem.bands.get(1), {stats: ['mean', 'max']});
+ * zones.forEach(function(zone) {
+ *     console.log(zone.fid, zone.mean, zone.max);
+ * });```
+ *
+ * @throws Error
+ * @method zonalStats
+ * @static
+ * @for gdal
+ * @param {gdal.Layer} layer
+ * @param {gdal.RasterBand} band
+ * @param {Object} [options]
+ * @param {String[]} [options.stats=["count","sum","min","max","mean"]] Any of `"count"`, `"sum"`, `"min"`, `"max"`, `"mean"` and `"histogram"`.
+ * @param {Object} [options.histogram] `{min, max, buckets}` range of the histograms, values outside of it are not counted. Defaults to 256 buckets over 0 - 255 for Byte bands and is required otherwise.
+ * @param {Boolean} [options.allTouched=false] Count every pixel touched by a geometry, not just those whose center is inside it.
+ * @param {integer} [options.threads] Defaults to the number of CPUs.
+ * @return {Object[]} One object per feature, in layer order, with its `fid` and the requested statistics. `min`, `max` and `mean` are `null` for features covering no valid pixel.
+ */
+NAN_METHOD(Algorithms::zonalStats)
+{
+	doZonalStats(info, false);
+}
+
+static void doBuildVRT(NAN_METHOD_ARGS_TYPE info, bool async)
+{
+	Nan::HandleScope scope;
+
+	Local<Array> files;
+	Local<Object> obj;
+
+	NODE_ARG_ARRAY(0, "files", files);
+
+	BuildVRTJob job;
+	job.ds = NULL;
+	job.options.resolution = MosaicOptions::AVERAGE;
+	job.options.x_res = 0;
+	job.options.y_res = 0;
+	job.options.has_src_nodata = false;
+	job.options.src_nodata = 0;
+	job.options.has_vrt_nodata = false;
+	job.options.vrt_nodata = 0;
+	job.options.threads = CPLGetNumCPUs();
+
+	for(unsigned int i = 0; i < files->Length(); i++) {
+		Local<Value> file = files->Get(i);
+		if(!file->IsString()) {
+			Nan::ThrowTypeError("files must be an array of strings");
+			return;
+		}
+		job.files.push_back(*Nan::Utf8String(file));
+	}
+	if(job.files.empty()) {
+		Nan::ThrowError("files must not be empty");
+		return;
+	}
+
+	if(info.Length() > 1 && !info[1]->IsNull() && !info[1]->IsUndefined()) {
+		NODE_ARG_OBJECT(1, "options", obj);
+		NODE_INT_FROM_OBJ_OPT(obj, "threads", job.options.threads);
+
+		std::string resolution = "average";
+		NODE_STR_FROM_OBJ_OPT(obj, "resolution", resolution);
+		if(resolution == "average") job.options.resolution = MosaicOptions::AVERAGE;
+		else if(resolution == "highest") job.options.resolution = MosaicOptions::HIGHEST;
+		else if(resolution == "lowest") job.options.resolution = MosaicOptions::LOWEST;
+		else {
+			Nan::ThrowError("resolution must be 'average', 'highest' or 'lowest'");
+			return;
+		}
+
+		bool has_x_res = Nan::HasOwnProperty(obj, Nan::New("xRes").ToLocalChecked()).FromMaybe(false);
+		bool has_y_res = Nan::HasOwnProperty(obj, Nan::New("yRes").ToLocalChecked()).FromMaybe(false);
+		if(has_x_res != has_y_res) {
+			Nan::ThrowError("xRes and yRes must be given together");
+			return;
+		}
+		if(has_x_res) {
+			NODE_DOUBLE_FROM_OBJ(obj, "xRes", job.options.x_res);
+			NODE_DOUBLE_FROM_OBJ(obj, "yRes", job.options.y_res);
+			if(!(job.options.x_res > 0 && job.options.y_res > 0)) {
+				Nan::ThrowRangeError("xRes and yRes must be greater than 0");
+				return;
+			}
+			job.options.resolution = MosaicOptions::USER;
+		}
+
+		job.options.has_src_nodata = Nan::HasOwnProperty(obj, Nan::New("srcNodata").ToLocalChecked()).FromMaybe(false);
+		job.options.has_vrt_nodata = Nan::HasOwnProperty(obj, Nan::New("vrtNodata").ToLocalChecked()).FromMaybe(false);
+		NODE_DOUBLE_FROM_OBJ_OPT(obj, "srcNodata", job.options.src_nodata);
+		NODE_DOUBLE_FROM_OBJ_OPT(obj, "vrtNodata", job.options.vrt_nodata);
+	}
+
+	if(job.options.threads < 1) {
+		Nan::ThrowRangeError("threads must be greater than 0");
+		return;
+	}
+
+	if(async) {
+		AlgorithmWorker<BuildVRTJob> *worker = createWorker(info, job, 2);
+		if(!worker) return;
+		worker->queue();
+		return;
+	}
+
+	CPLErr err = job.run(NULL, NULL);
+	if(err) {
+		NODE_THROW_CPLERR(err);
+		return;
+	}
+
+	info.GetReturnValue().Set(job.result());
+}
+
+/**
+ * Builds a mosaic of raster files as an in-memory VRT dataset, like
+ * `gdalbuildvrt`, without writing or parsing any VRT XML.
+ *
+ * The files' headers are read in parallel and must share the same spatial
+ * reference, number of bands and band types. Sources are only opened while
+ * they are read, through a pool bounding the number of open files, and an
+ * index of their extents lets reads skip the sources they don't overlap, so
+ * mosaics of thousands of files stay cheap to read from.
+ *
+ * Where files overlap, the one listed last wins. The mosaic can be saved with
+ * `gdal.drivers.get('VRT').createCopy()`.
+ *
+ * @example
+ * ```
+ * var mosaic = gdal.buildVRT(fs.readdirSync('tiles').map(function(name) {
+ *     return 'tiles/' + name;
+ * }), {resolution: 'highest'});```
+ *
+ * @throws Error
+ * @method buildVRT
+ * @static
+ * @for gdal
+ * @param {String[]} files
+ * @param {Object} [options]
+ * @param {String} [options.resolution="average"] `"average"`, `"highest"` or `"lowest"` resolution of the files.
+ * @param {Number} [options.xRes] Resolution of the mosaic, overriding `resolution`. Must be given with `yRes`.
+ * @param {Number} [options.yRes]
+ * @param {Number} [options.srcNodata] Nodata value of the files' pixels, overriding the files' own nodata values.
+ * @param {Number} [options.vrtNodata] Nodata value of the mosaic's bands. Defaults to the files' nodata value.
+ * @param {Integer} [options.threads] Number of threads reading headers. Defaults to the number of CPUs.
+ * @return {gdal.Dataset}
+ */
+NAN_METHOD(Algorithms::buildVRT)
+{
+	doBuildVRT(info, false);
+}
+
+NAN_METHOD(Algorithms::fillNodataAsync)
+{
+	doFillNodata(info, true);
+}
+
+NAN_METHOD(Algorithms::contourGenerateAsync)
+{
+	doContourGenerate(info, true);
+}
+
+NAN_METHOD(Algorithms::sieveFilterAsync)
+{
+	doSieveFilter(info, true);
+}
+
+NAN_METHOD(Algorithms::checksumImageAsync)
+{
+	doChecksumImage(info, true);
+}
+
+NAN_METHOD(Algorithms::polygonizeAsync)
+{
+	doPolygonize(info, true);
+}
+
+NAN_METHOD(Algorithms::calcAsync)
+{
+	doCalc(info, true);
+}
+
+NAN_METHOD(Algorithms::zonalStatsAsync)
+{
+	doZonalStats(info, true);
+}
+
+NAN_METHOD(Algorithms::buildVRTAsync)
+{
+	doBuildVRT(info, true);
+}
+
 } //node_gdal namespace
\ No newline at end of file
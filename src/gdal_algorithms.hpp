@@ -34,6 +34,18 @@ namespace Algorithms {
 	NAN_METHOD(sieveFilter);
 	NAN_METHOD(checksumImage);
 	NAN_METHOD(polygonize);
+	NAN_METHOD(calc);
+	NAN_METHOD(zonalStats);
+	NAN_METHOD(buildVRT);
+
+	NAN_METHOD(fillNodataAsync);
+	NAN_METHOD(contourGenerateAsync);
+	NAN_METHOD(sieveFilterAsync);
+	NAN_METHOD(checksumImageAsync);
+	NAN_METHOD(polygonizeAsync);
+	NAN_METHOD(calcAsync);
+	NAN_METHOD(zonalStatsAsync);
+	NAN_METHOD(buildVRTAsync);
 }
 }
 
@@ -308,6 +308,15 @@ NAN_SETTER(READ_ONLY_SETTER);
   }                                                                                                           \
   var = (*Nan::Utf8String(info[num]))
 
+#define NODE_ARG_CALLBACK(num, name, var)                                                                     \
+  if (info.Length() < num + 1) {                                                                              \
+    Nan::ThrowError(name " must be given"); return;                                               \
+  }                                                                                                           \
+  if (!info[num]->IsFunction()) {                                                                             \
+    Nan::ThrowTypeError(name " must be a function"); return;                                     \
+  }                                                                                                           \
+  var = info[num].As<Function>();
+
 // ----- optional argument conversion -------
 
 #define NODE_ARG_INT_OPT(num, name, var)                                                                         \
@@ -382,6 +391,26 @@ NAN_SETTER(READ_ONLY_SETTER);
     }                                                                                                          \
   }
 
+
+#define NODE_ARG_CALLBACK_OPT(num, name, var)                                                                  \
+  if (info.Length() > num) {                                                                                   \
+    if (info[num]->IsFunction()) {                                                                             \
+      var = info[num].As<Function>();                                                                          \
+    } else if(!info[num]->IsNull() && !info[num]->IsUndefined()) {                                             \
+      Nan::ThrowTypeError(name " must be a function"); return;                                     \
+    }                                                                                                          \
+  }
+
+// cancel tokens are passed to native code as the Int32Array flag held by gdal.CancelToken
+#define NODE_ARG_CANCEL_TOKEN_OPT(num, name, var)                                                              \
+  if (info.Length() > num) {                                                                                   \
+    if (info[num]->IsInt32Array()) {                                                                           \
+      var = info[num].As<Object>();                                                                            \
+    } else if(!info[num]->IsNull() && !info[num]->IsUndefined()) {                                             \
+      Nan::ThrowTypeError(name " must be a gdal.CancelToken"); return;                             \
+    }                                                                                                          \
+  }
+
 // ----- wrapped methods w/ results-------
 
 #define NODE_WRAPPED_METHOD_WITH_RESULT(klass, method, result_type, wrapped_method)                               \
@@ -7,7 +7,12 @@
 #include "gdal_layer.hpp"
 #include "gdal_geometry.hpp"
 #include "collections/dataset_bands.hpp"
+#include "collections/dataset_pixels.hpp"
 #include "collections/dataset_layers.hpp"
+#include "utils/dataset_worker.hpp"
+#include "utils/overview_builder.hpp"
+
+#include <vector>
 
 namespace node_gdal {
 
@@ -33,13 +38,18 @@ void Dataset::Initialize(Local<Object> target)
 	Nan::SetPrototypeMethod(lcons, "flush", flush);
 	Nan::SetPrototypeMethod(lcons, "close", close);
 	Nan::SetPrototypeMethod(lcons, "getMetadata", getMetadata);
+	Nan::SetPrototypeMethod(lcons, "getCacheStats", getCacheStats);
+	Nan::SetPrototypeMethod(lcons, "resetCacheStats", resetCacheStats);
 	Nan::SetPrototypeMethod(lcons, "testCapability", testCapability);
 	Nan::SetPrototypeMethod(lcons, "executeSQL", executeSQL);
+	Nan::SetPrototypeMethod(lcons, "executeSQLAsync", executeSQLAsync);
 	Nan::SetPrototypeMethod(lcons, "buildOverviews", buildOverviews);
+	Nan::SetPrototypeMethod(lcons, "buildOverviewsAsync", buildOverviewsAsync);
 
 	ATTR_DONT_ENUM(lcons, "_uid", uidGetter, READ_ONLY_SETTER);
 	ATTR(lcons, "description", descriptionGetter, READ_ONLY_SETTER);
 	ATTR(lcons, "bands", bandsGetter, READ_ONLY_SETTER);
+	ATTR(lcons, "pixels", pixelsGetter, READ_ONLY_SETTER);
 	ATTR(lcons, "layers", layersGetter, READ_ONLY_SETTER);
 	ATTR(lcons, "rasterSize", rasterSizeGetter, READ_ONLY_SETTER);
 	ATTR(lcons, "driver", driverGetter, READ_ONLY_SETTER);
@@ -146,6 +156,9 @@ NAN_METHOD(Dataset::New)
 		Local<Value> bands = DatasetBands::New(info.This());
 		Nan::SetPrivate(info.This(), Nan::New("bands_").ToLocalChecked(), bands);
 
+		Local<Value> pixels = DatasetPixels::New(info.This());
+		Nan::SetPrivate(info.This(), Nan::New("pixels_").ToLocalChecked(), pixels);
+
 		Local<Value> layers = DatasetLayers::New(info.This());
 		Nan::SetPrivate(info.This(), Nan::New("layers_").ToLocalChecked(), layers);
 
@@ -226,6 +239,8 @@ NAN_METHOD(Dataset::getMetadata)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		info.GetReturnValue().Set(Nan::New<Object>());
@@ -239,6 +254,75 @@ NAN_METHOD(Dataset::getMetadata)
 	info.GetReturnValue().Set(MajorObject::getMetadata(raw, domain.empty() ? NULL : domain.c_str()));
 }
 
+/**
+ * Returns the block cache counters of the dataset's bands, summed. See
+ * {{#crossLink "gdal.RasterBand/getCacheStats:method"}}RasterBand.getCacheStats(){{/crossLink}}.
+ *
+ * @throws Error
+ * @method getCacheStats
+ * @return {Object} `{hits, misses, evictions, bytes_decoded}`
+ */
+NAN_METHOD(Dataset::getCacheStats)
+{
+	Nan::HandleScope scope;
+	Dataset *ds = Nan::ObjectWrap::Unwrap<Dataset>(info.This());
+
+	if(!ds->isAlive()){
+		Nan::ThrowError("Dataset object has already been destroyed");
+		return;
+	}
+
+	#ifndef BUNDLED_GDAL
+	Nan::ThrowError("Block cache statistics require the bundled GDAL");
+	return;
+	#else
+	GDALDataset* raw = ds->getDataset();
+	GIntBig hits = 0, misses = 0, evictions = 0, bytes_decoded = 0;
+	for (int i = 1; i <= raw->GetRasterCount(); i++) {
+		GIntBig band_hits, band_misses, band_evictions, band_bytes_decoded;
+		raw->GetRasterBand(i)->GetBlockCacheStats(&band_hits, &band_misses, &band_evictions, &band_bytes_decoded);
+		hits += band_hits;
+		misses += band_misses;
+		evictions += band_evictions;
+		bytes_decoded += band_bytes_decoded;
+	}
+
+	Local<Object> result = Nan::New<Object>();
+	result->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>((double) hits));
+	result->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>((double) misses));
+	result->Set(Nan::New("evictions").ToLocalChecked(), Nan::New<Number>((double) evictions));
+	result->Set(Nan::New("bytes_decoded").ToLocalChecked(), Nan::New<Number>((double) bytes_decoded));
+
+	info.GetReturnValue().Set(result);
+	#endif
+}
+
+/**
+ * Resets the block cache counters of all of the dataset's bands.
+ *
+ * @throws Error
+ * @method resetCacheStats
+ */
+NAN_METHOD(Dataset::resetCacheStats)
+{
+	Nan::HandleScope scope;
+	Dataset *ds = Nan::ObjectWrap::Unwrap<Dataset>(info.This());
+
+	if(!ds->isAlive()){
+		Nan::ThrowError("Dataset object has already been destroyed");
+		return;
+	}
+
+	#ifndef BUNDLED_GDAL
+	Nan::ThrowError("Block cache statistics require the bundled GDAL");
+	#else
+	GDALDataset* raw = ds->getDataset();
+	for (int i = 1; i <= raw->GetRasterCount(); i++) {
+		raw->GetRasterBand(i)->ResetBlockCacheStats();
+	}
+	#endif
+}
+
 /**
  * Determines if the dataset supports the indicated operation.
  *
@@ -256,6 +340,8 @@ NAN_METHOD(Dataset::testCapability)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR >= 2
 		GDALDataset *raw = ds->getDataset();
 	#else
@@ -288,6 +374,8 @@ NAN_METHOD(Dataset::getGCPProjection)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		info.GetReturnValue().Set(Nan::Null());
@@ -302,6 +390,9 @@ NAN_METHOD(Dataset::getGCPProjection)
 /**
  * Closes the dataset to further operations.
  *
+ * If async operations are still running on the dataset, it's detached
+ * immediately and the underlying file is closed once they complete.
+ *
  * @method close
  */
 NAN_METHOD(Dataset::close)
@@ -334,6 +425,8 @@ NAN_METHOD(Dataset::flush)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		OGRDataSource* raw = ds->getDatasource();
@@ -376,6 +469,8 @@ NAN_METHOD(Dataset::executeSQL)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR >= 2
 		GDALDataset* raw = ds->getDataset();
 	#else
@@ -407,6 +502,96 @@ NAN_METHOD(Dataset::executeSQL)
 	}
 }
 
+// Runs ExecuteSQL() for executeSQLAsync() on the libuv threadpool, holding the dataset lock
+class ExecuteSQLWorker : public DatasetWorker {
+public:
+	#if GDAL_VERSION_MAJOR >= 2
+	ExecuteSQLWorker(Nan::Callback *callback, Dataset *ds, GDALDataset *raw, std::string sql, OGRGeometry *spatial_filter, std::string sql_dialect)
+	#else
+	ExecuteSQLWorker(Nan::Callback *callback, Dataset *ds, OGRDataSource *raw, std::string sql, OGRGeometry *spatial_filter, std::string sql_dialect)
+	#endif
+		: DatasetWorker(callback, ds->uid), ds(ds), raw(raw), sql(sql),
+		  spatial_filter(spatial_filter ? spatial_filter->clone() : NULL), sql_dialect(sql_dialect), layer(NULL)
+	{}
+
+	~ExecuteSQLWorker()
+	{
+		if(spatial_filter) OGRGeometryFactory::destroyGeometry(spatial_filter);
+	}
+
+protected:
+	void Run()
+	{
+		layer = raw->ExecuteSQL(sql.c_str(), spatial_filter, sql_dialect.empty() ? NULL : sql_dialect.c_str());
+		if(!layer) {
+			SetCPLErrorMessage("Error executing SQL");
+		}
+	}
+
+	void HandleOKCallback()
+	{
+		Nan::HandleScope scope;
+
+		// the result set must go back to the dataset before it is closed
+		if(!ds->isAlive()) {
+			raw->ReleaseResultSet(layer);
+			Local<Value> argv[] = { Nan::Error("Dataset was closed before the query completed") };
+			callback->Call(1, argv, async_resource);
+			return;
+		}
+
+		Local<Value> argv[] = { Nan::Null(), Layer::New(layer, raw, true) };
+		callback->Call(2, argv, async_resource);
+	}
+
+private:
+	Dataset *ds;
+	#if GDAL_VERSION_MAJOR >= 2
+	GDALDataset *raw;
+	#else
+	OGRDataSource *raw;
+	#endif
+	std::string sql;
+	OGRGeometry *spatial_filter;
+	std::string sql_dialect;
+	OGRLayer *layer;
+};
+
+NAN_METHOD(Dataset::executeSQLAsync)
+{
+	Nan::HandleScope scope;
+	Dataset *ds = Nan::ObjectWrap::Unwrap<Dataset>(info.This());
+
+	if(!ds->isAlive()){
+		Nan::ThrowError("Dataset object has already been destroyed");
+		return;
+	}
+
+	#if GDAL_VERSION_MAJOR >= 2
+		GDALDataset* raw = ds->getDataset();
+	#else
+		OGRDataSource* raw = ds->getDatasource();
+		if (!ds->uses_ogr){
+			Nan::ThrowError("Dataset does not support executing a SQL query");
+			return;
+		}
+	#endif
+
+	std::string sql;
+	std::string sql_dialect;
+	Geometry *spatial_filter = NULL;
+	Local<Function> callback;
+
+	NODE_ARG_STR(0, "sql text", sql);
+	NODE_ARG_WRAPPED_OPT(1, "spatial filter geometry", Geometry, spatial_filter);
+	NODE_ARG_OPT_STR(2, "sql dialect", sql_dialect);
+	NODE_ARG_CALLBACK(3, "callback", callback);
+
+	ExecuteSQLWorker *worker = new ExecuteSQLWorker(new Nan::Callback(callback), ds, raw, sql, spatial_filter ? spatial_filter->get() : NULL, sql_dialect);
+	worker->SaveToPersistent("dataset", info.This());
+	worker->queue();
+}
+
 /**
  * Fetch files forming dataset.
  *
@@ -431,6 +616,8 @@ NAN_METHOD(Dataset::getFileList)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		info.GetReturnValue().Set(results);
@@ -479,6 +666,8 @@ NAN_METHOD(Dataset::getGCPs)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		info.GetReturnValue().Set(results);
@@ -534,6 +723,8 @@ NAN_METHOD(Dataset::setGCPs)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		Nan::ThrowError("Dataset does not support setting GCPs");
@@ -609,6 +800,49 @@ NAN_METHOD(Dataset::setGCPs)
  * @param {Integer[]} [bands] Note: Generation of overviews in external TIFF currently only supported when operating on all bands.
  */
 NAN_METHOD(Dataset::buildOverviews)
+{
+	doBuildOverviews(info, false);
+}
+
+// Builds overviews for buildOverviewsAsync() on the libuv threadpool, holding the dataset lock
+class BuildOverviewsWorker : public DatasetProgressWorker {
+public:
+	BuildOverviewsWorker(Nan::Callback *callback, Dataset *ds, std::string resampling, std::vector<int> &overviews, std::vector<int> &bands, bool concurrent)
+		: DatasetProgressWorker(callback, ds->uid), raw(ds->getDataset()), resampling(resampling),
+		  overviews(overviews), bands(bands), concurrent(concurrent)
+	{}
+
+protected:
+	void Run()
+	{
+		CPLErr err;
+		int *o = overviews.empty() ? NULL : &overviews[0];
+		int *b = bands.empty() ? NULL : &bands[0];
+
+		if(concurrent) {
+			err = buildOverviewsConcurrently(raw, resampling.c_str(), overviews.size(), o, bands.size(), b, ProgressFunc, this);
+		} else {
+			err = raw->BuildOverviews(resampling.c_str(), overviews.size(), o, bands.size(), b, ProgressFunc, this);
+		}
+		if(err) {
+			SetCPLErrorMessage("Error building overviews");
+		}
+	}
+
+private:
+	GDALDataset *raw;
+	std::string resampling;
+	std::vector<int> overviews;
+	std::vector<int> bands;
+	bool concurrent;
+};
+
+NAN_METHOD(Dataset::buildOverviewsAsync)
+{
+	doBuildOverviews(info, true);
+}
+
+void Dataset::doBuildOverviews(NAN_METHOD_ARGS_TYPE info, bool async)
 {
 	Nan::HandleScope scope;
 	Dataset *ds = Nan::ObjectWrap::Unwrap<Dataset>(info.This());
@@ -634,47 +868,58 @@ NAN_METHOD(Dataset::buildOverviews)
 	NODE_ARG_ARRAY(1, "overviews", overviews);
 	NODE_ARG_ARRAY_OPT(2, "bands", bands);
 
-	int *o, *b = NULL;
+	std::vector<int> o, b;
 	int n_overviews = overviews->Length();
 	int i, n_bands = 0;
 
-	o = new int[n_overviews];
 	for(i = 0; i<n_overviews; i++){
 		Local<Value> val = overviews->Get(i);
 		if(!val->IsNumber()) {
-			delete [] o;
 			Nan::ThrowError("overviews array must only contain numbers");
 			return;
 		}
-		o[i] = val->Int32Value();
+		o.push_back(val->Int32Value());
 	}
 
 	if(!bands.IsEmpty()){
 		n_bands = bands->Length();
-		b = new int[n_bands];
 		for(i = 0; i<n_bands; i++){
 			Local<Value> val = bands->Get(i);
 			if(!val->IsNumber()) {
-				delete [] o;
-				delete [] b;
 				Nan::ThrowError("band array must only contain numbers");
 				return;
 			}
-			b[i] = val->Int32Value();
-			if(b[i] > raw->GetRasterCount() || b[i] < 1) {
+			int id = val->Int32Value();
+			if(id > raw->GetRasterCount() || id < 1) {
 				//BuildOverviews prints an error but segfaults before returning
-				delete [] o;
-				delete [] b;
 				Nan::ThrowError("invalid band id");
 				return;
 			}
+			b.push_back(id);
 		}
 	}
 
-	CPLErr err = raw->BuildOverviews(resampling.c_str(), n_overviews, o, n_bands, b, NULL, NULL);
+	if(async) {
+		bool concurrent = false;
+		Local<Function> progress;
+		Local<Object> cancel_flag;
+		Local<Function> callback;
 
-	delete [] o;
-	if(b) delete [] b;
+		NODE_ARG_BOOL_OPT(3, "concurrent", concurrent);
+		NODE_ARG_CALLBACK_OPT(4, "progress", progress);
+		NODE_ARG_CANCEL_TOKEN_OPT(5, "cancel token", cancel_flag);
+		NODE_ARG_CALLBACK(6, "callback", callback);
+
+		BuildOverviewsWorker *worker = new BuildOverviewsWorker(new Nan::Callback(callback), ds, resampling, o, b, concurrent);
+		if (!progress.IsEmpty()) worker->setProgressCallback(progress);
+		if (!cancel_flag.IsEmpty()) worker->setCancelToken(cancel_flag);
+		worker->SaveToPersistent("dataset", info.This());
+		worker->queue();
+		return;
+	}
+
+	DatasetSyncLock lock(ds->uid);
+	CPLErr err = raw->BuildOverviews(resampling.c_str(), n_overviews, o.empty() ? NULL : &o[0], n_bands, b.empty() ? NULL : &b[0], NULL, NULL);
 
 	if(err) {
 		NODE_THROW_CPLERR(err);
@@ -699,6 +944,8 @@ NAN_GETTER(Dataset::descriptionGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		OGRDataSource* raw = ds->getDatasource();
@@ -732,6 +979,8 @@ NAN_GETTER(Dataset::rasterSizeGetter)
 		return;
 	}
 
+	// fixed once the dataset is opened, so no need to wait for async jobs
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		info.GetReturnValue().Set(Nan::Null());
@@ -773,6 +1022,8 @@ NAN_GETTER(Dataset::srsGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		info.GetReturnValue().Set(Nan::Null());
@@ -822,6 +1073,8 @@ NAN_GETTER(Dataset::geoTransformGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		info.GetReturnValue().Set(Nan::Null());
@@ -865,6 +1118,8 @@ NAN_GETTER(Dataset::driverGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		OGRDataSource* raw = ds->getDatasource();
@@ -887,6 +1142,8 @@ NAN_SETTER(Dataset::srsSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		Nan::ThrowError("Dataset doesnt support setting a spatial reference");
@@ -931,6 +1188,8 @@ NAN_SETTER(Dataset::geoTransformSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(ds->uid);
+
 	#if GDAL_VERSION_MAJOR < 2
 	if (ds->uses_ogr) {
 		Nan::ThrowError("Dataset doesnt support setting a geotransform");
@@ -978,6 +1237,17 @@ NAN_GETTER(Dataset::bandsGetter)
 	info.GetReturnValue().Set(Nan::GetPrivate(info.This(), Nan::New("bands_").ToLocalChecked()).ToLocalChecked());
 }
 
+/**
+ * @readOnly
+ * @attribute pixels
+ * @type {gdal.DatasetPixels}
+ */
+NAN_GETTER(Dataset::pixelsGetter)
+{
+	Nan::HandleScope scope;
+	info.GetReturnValue().Set(Nan::GetPrivate(info.This(), Nan::New("pixels_").ToLocalChecked()).ToLocalChecked());
+}
+
 /**
  * @readOnly
  * @attribute layers
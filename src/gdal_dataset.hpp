@@ -36,16 +36,21 @@ public:
 	static NAN_METHOD(toString);
 	static NAN_METHOD(flush);
 	static NAN_METHOD(getMetadata);
+	static NAN_METHOD(getCacheStats);
+	static NAN_METHOD(resetCacheStats);
 	static NAN_METHOD(getFileList);
 	static NAN_METHOD(getGCPProjection);
 	static NAN_METHOD(getGCPs);
 	static NAN_METHOD(setGCPs);
 	static NAN_METHOD(executeSQL);
+	static NAN_METHOD(executeSQLAsync);
 	static NAN_METHOD(testCapability);
 	static NAN_METHOD(buildOverviews);
+	static NAN_METHOD(buildOverviewsAsync);
 	static NAN_METHOD(close);
 
 	static NAN_GETTER(bandsGetter);
+	static NAN_GETTER(pixelsGetter);
 	static NAN_GETTER(rasterSizeGetter);
 	static NAN_GETTER(srsGetter);
 	static NAN_GETTER(driverGetter);
@@ -86,6 +91,7 @@ public:
 
 private:
 	~Dataset();
+	static void doBuildOverviews(NAN_METHOD_ARGS_TYPE info, bool async);
 	GDALDataset   *this_dataset;
 	#if GDAL_VERSION_MAJOR < 2
 	OGRDataSource *this_datasource;
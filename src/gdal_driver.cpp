@@ -3,6 +3,16 @@
 #include "gdal_driver.hpp"
 #include "gdal_dataset.hpp"
 #include "utils/string_list.hpp"
+#include "utils/buffer_path.hpp"
+#include "utils/dataset_worker.hpp"
+
+// node
+#include <node_buffer.h>
+
+// gdal
+#include <cpl_atomic_ops.h>
+#include <cpl_string.h>
+#include <cpl_vsi.h>
 
 namespace node_gdal {
 
@@ -22,8 +32,12 @@ void Driver::Initialize(Local<Object> target)
 
 	Nan::SetPrototypeMethod(lcons, "toString", toString);
 	Nan::SetPrototypeMethod(lcons, "open", open);
+	Nan::SetPrototypeMethod(lcons, "openAsync", openAsync);
 	Nan::SetPrototypeMethod(lcons, "create", create);
 	Nan::SetPrototypeMethod(lcons, "createCopy", createCopy);
+	Nan::SetPrototypeMethod(lcons, "createCopyAsync", createCopyAsync);
+	Nan::SetPrototypeMethod(lcons, "encode", encode);
+	Nan::SetPrototypeMethod(lcons, "encodeAsync", encodeAsync);
 	Nan::SetPrototypeMethod(lcons, "deleteDataset", deleteDataset);
 	Nan::SetPrototypeMethod(lcons, "rename", rename);
 	Nan::SetPrototypeMethod(lcons, "copyFiles", copyFiles);
@@ -358,6 +372,7 @@ NAN_METHOD(Driver::createCopy)
 		OGRSFDriver *raw = driver->getOGRSFDriver();
 		OGRDataSource *raw_ds = src_dataset->getDatasource();
 
+		DatasetSyncLock lock(src_dataset->uid);
 		OGRDataSource *ds = raw->CopyDataSource(raw_ds, filename.c_str(), options.get());
 
 		if (!ds) {
@@ -372,7 +387,11 @@ NAN_METHOD(Driver::createCopy)
 
 	GDALDriver *raw = driver->getGDALDriver();
 	GDALDataset *raw_ds = src_dataset->getDataset();
-	GDALDataset *ds = raw->CreateCopy(filename.c_str(), raw_ds, strict, options.get(), NULL, NULL);
+	GDALDataset *ds;
+	{
+		DatasetSyncLock lock(src_dataset->uid);
+		ds = raw->CreateCopy(filename.c_str(), raw_ds, strict, options.get(), NULL, NULL);
+	}
 
 	if (!ds) {
 		Nan::ThrowError("Error copying dataset");
@@ -382,6 +401,353 @@ NAN_METHOD(Driver::createCopy)
 	info.GetReturnValue().Set(Dataset::New(ds));
 }
 
+// Runs CreateCopy() for createCopyAsync() on the libuv threadpool, holding the source dataset lock
+class CreateCopyWorker : public DatasetProgressWorker {
+public:
+	CreateCopyWorker(Nan::Callback *callback, Driver *driver, Dataset *src, std::string filename, char **options)
+		: DatasetProgressWorker(callback, src->uid), filename(filename), options(CSLDuplicate(options)), ds(NULL)
+		#if GDAL_VERSION_MAJOR < 2
+		, ogr_driver(NULL), ogr_src(NULL), ogr_ds(NULL)
+		#endif
+	{
+		#if GDAL_VERSION_MAJOR < 2
+		if (driver->uses_ogr) {
+			ogr_driver = driver->getOGRSFDriver();
+			ogr_src = src->getDatasource();
+		}
+		#endif
+		gdal_driver = driver->getGDALDriver();
+		gdal_src = src->getDataset();
+	}
+
+	~CreateCopyWorker()
+	{
+		CSLDestroy(options);
+	}
+
+protected:
+	void Run()
+	{
+		#if GDAL_VERSION_MAJOR < 2
+		if (ogr_driver) {
+			ogr_ds = ogr_driver->CopyDataSource(ogr_src, filename.c_str(), options);
+			if (!ogr_ds) {
+				SetCPLErrorMessage("Error copying dataset.");
+			}
+			return;
+		}
+		#endif
+
+		ds = gdal_driver->CreateCopy(filename.c_str(), gdal_src, FALSE, options, ProgressFunc, this);
+		if (!ds) {
+			SetCPLErrorMessage("Error copying dataset");
+		}
+	}
+
+	Local<Value> GetResult()
+	{
+		#if GDAL_VERSION_MAJOR < 2
+		if (ogr_ds) {
+			return Dataset::New(ogr_ds);
+		}
+		#endif
+		return Dataset::New(ds);
+	}
+
+private:
+	std::string filename;
+	char **options;
+	GDALDriver *gdal_driver;
+	GDALDataset *gdal_src;
+	GDALDataset *ds;
+	#if GDAL_VERSION_MAJOR < 2
+	OGRSFDriver *ogr_driver;
+	OGRDataSource *ogr_src;
+	OGRDataSource *ogr_ds;
+	#endif
+};
+
+NAN_METHOD(Driver::createCopyAsync)
+{
+	Nan::HandleScope scope;
+	Driver *driver = Nan::ObjectWrap::Unwrap<Driver>(info.This());
+
+	if(!driver->isAlive()){
+		Nan::ThrowError("Driver object has already been destroyed");
+		return;
+	}
+
+	std::string filename;
+	Dataset* src_dataset;
+	StringList options;
+	Local<Function> progress;
+	Local<Object> cancel_flag;
+	Local<Function> callback;
+
+	NODE_ARG_STR(0, "filename", filename);
+	NODE_ARG_WRAPPED(1, "source dataset", Dataset, src_dataset);
+
+	if(!src_dataset->isAlive()){
+		Nan::ThrowError("Dataset object has already been destroyed");
+		return;
+	}
+
+	if(info.Length() > 2 && options.parse(info[2])){
+		return; //error parsing string list
+	}
+
+	NODE_ARG_CALLBACK_OPT(3, "progress", progress);
+	NODE_ARG_CANCEL_TOKEN_OPT(4, "cancel token", cancel_flag);
+	NODE_ARG_CALLBACK(5, "callback", callback);
+
+	#if GDAL_VERSION_MAJOR < 2
+	if (driver->uses_ogr != src_dataset->uses_ogr){
+		Nan::ThrowError("Driver unable to copy dataset");
+		return;
+	}
+	#endif
+
+	CreateCopyWorker *worker = new CreateCopyWorker(new Nan::Callback(callback), driver, src_dataset, filename, options.get());
+	if (!progress.IsEmpty()) worker->setProgressCallback(progress);
+	if (!cancel_flag.IsEmpty()) worker->setCancelToken(cancel_flag);
+	worker->SaveToPersistent("driver", info.This());
+	worker->SaveToPersistent("src", info[1].As<Object>());
+	worker->queue();
+}
+
+// Deletes a /vsimem directory and everything in it
+static void removeMemDirectory(const char *dir)
+{
+	char **names = VSIReadDir(dir);
+	for(char **name = names; name && *name; name++) {
+		CPLString path = CPLFormFilename(dir, *name, NULL);
+		VSIStatBufL stat;
+		if(VSIStatL(path, &stat) == 0 && VSI_ISDIR(stat.st_mode)) {
+			removeMemDirectory(path);
+		} else {
+			VSIUnlink(path);
+		}
+	}
+	CSLDestroy(names);
+	VSIRmdir(dir);
+}
+
+// Whether `name` is a sidecar of `filename` that can be left out of the
+// encoded file: the .aux.xml PAM writes when georeferencing doesn't fit the
+// format, or a world file (.wld, .tfw, .pgw...)
+static bool isOptionalSidecar(const CPLString &name, const CPLString &filename)
+{
+	if(EQUAL(name, (filename + ".aux.xml").c_str())) return true;
+	// CPLGetBasename() returns a buffer the next call overwrites
+	CPLString basename = CPLGetBasename(name);
+	if(!EQUAL(basename, CPLGetBasename(filename))) return false;
+	CPLString extension = CPLGetExtension(name);
+	return EQUAL(extension, "wld") || (!extension.empty() && (extension[extension.size() - 1] == 'w' || extension[extension.size() - 1] == 'W'));
+}
+
+// Encodes `src` with CreateCopy() into a private /vsimem directory and takes
+// ownership of the main file's memory. The directory is removed whatever
+// happens. Returns NULL (with a CPL error set) on failure, including when
+// the driver wrote other files the Buffer couldn't hold.
+static GByte* encodeDataset(GDALDriver *driver, GDALDataset *src, char **options, vsi_l_offset *length,
+                            GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	static volatile int counter = 0;
+	const char *extension = driver->GetMetadataItem(GDAL_DMD_EXTENSION);
+	CPLString dir, filename;
+	dir.Printf("/vsimem/node_gdal_encode_%d", CPLAtomicInc(&counter));
+	filename.Printf("dataset.%s", extension && extension[0] ? extension : "bin");
+	CPLString path = CPLFormFilename(dir, filename, NULL);
+	VSIMkdir(dir, 0755);
+
+	GDALDataset *ds = driver->CreateCopy(path, src, FALSE, options, pfnProgress, pProgressArg);
+	if(!ds) {
+		removeMemDirectory(dir);
+		return NULL;
+	}
+	GDALClose((GDALDatasetH) ds);
+
+	char **names = VSIReadDir(dir);
+	CPLString extra;
+	for(char **name = names; name && *name; name++) {
+		if(filename != *name && !isOptionalSidecar(*name, filename)) {
+			extra = *name;
+			break;
+		}
+	}
+	CSLDestroy(names);
+	if(!extra.empty()) {
+		removeMemDirectory(dir);
+		CPLError(CE_Failure, CPLE_NotSupported, "%s driver also wrote a .%s file, only single file formats can be encoded",
+			driver->GetDescription(), CPLGetExtension(extra));
+		return NULL;
+	}
+
+	GByte *data = VSIGetMemFileBuffer(path, length, TRUE);
+	removeMemDirectory(dir);
+	if(!data) {
+		CPLError(CE_Failure, CPLE_AppDefined, "%s driver didn't write a file that can be returned", driver->GetDescription());
+	} else if(*length > node::Buffer::kMaxLength) {
+		CPLFree(data);
+		data = NULL;
+		CPLError(CE_Failure, CPLE_AppDefined, "Encoded dataset is too large for a Buffer");
+	}
+	return data;
+}
+
+static void freeEncoded(char *data, void *)
+{
+	CPLFree(data);
+}
+
+// Wraps encoded data in a Buffer without copying it; the Buffer frees it
+static Local<Value> encodedBuffer(GByte *data, vsi_l_offset length)
+{
+	Nan::EscapableHandleScope scope;
+	return scope.Escape(Nan::NewBuffer((char *) data, (size_t) length, freeEncoded, NULL).ToLocalChecked());
+}
+
+/**
+ * Encodes a dataset in the driver's format and returns the resulting file
+ * as a Buffer, e.g. to send a PNG or JPEG tile in a response.
+ *
+ * The dataset is copied into an in-memory file whose memory is then handed
+ * to the Buffer as is, so nothing touches the disk and the data isn't copied
+ * again. Only the main file is returned: an .aux.xml or world file written
+ * next to it is dropped, and drivers writing other files (such as Shapefile)
+ * throw.
+ *
+ * @example
+ * ```
+ * var png = gdal.drivers.get('PNG').encode(tile);
+ * response.setHeader('Content-Type', 'image/png');
+ * response.end(png);```
+ *
+ * @throws Error
+ * @method encode
+ * @param {gdal.Dataset} src
+ * @param {String[]|object} [options=null] An array or object containing driver-specific dataset creation options
+ * @return {Buffer}
+ */
+NAN_METHOD(Driver::encode)
+{
+	Nan::HandleScope scope;
+	Driver *driver = Nan::ObjectWrap::Unwrap<Driver>(info.This());
+
+	if(!driver->isAlive()){
+		Nan::ThrowError("Driver object has already been destroyed");
+		return;
+	}
+
+	Dataset* src_dataset;
+	StringList options;
+
+	NODE_ARG_WRAPPED(0, "source dataset", Dataset, src_dataset);
+
+	if(info.Length() > 1 && options.parse(info[1])){
+		return; //error parsing string list
+	}
+
+	#if GDAL_VERSION_MAJOR < 2
+	if (driver->uses_ogr || src_dataset->uses_ogr){
+		Nan::ThrowError("Driver unable to encode dataset");
+		return;
+	}
+	#endif
+
+	GByte *data;
+	vsi_l_offset length = 0;
+	{
+		DatasetSyncLock lock(src_dataset->uid);
+		data = encodeDataset(driver->getGDALDriver(), src_dataset->getDataset(), options.get(), &length, NULL, NULL);
+	}
+	if (!data) {
+		NODE_THROW_LAST_CPLERR();
+		return;
+	}
+
+	info.GetReturnValue().Set(encodedBuffer(data, length));
+}
+
+// Encodes a dataset for encodeAsync() on the libuv threadpool, holding the source dataset lock
+class EncodeWorker : public DatasetProgressWorker {
+public:
+	EncodeWorker(Nan::Callback *callback, Driver *driver, Dataset *src, char **options)
+		: DatasetProgressWorker(callback, src->uid), options(CSLDuplicate(options)),
+		  gdal_driver(driver->getGDALDriver()), gdal_src(src->getDataset()), data(NULL), length(0)
+	{}
+
+	~EncodeWorker()
+	{
+		CSLDestroy(options);
+		CPLFree(data);
+	}
+
+protected:
+	void Run()
+	{
+		data = encodeDataset(gdal_driver, gdal_src, options, &length, ProgressFunc, this);
+		if (!data) {
+			SetCPLErrorMessage("Error encoding dataset");
+		}
+	}
+
+	Local<Value> GetResult()
+	{
+		GByte *result = data;
+		data = NULL;
+		return encodedBuffer(result, length);
+	}
+
+private:
+	char **options;
+	GDALDriver *gdal_driver;
+	GDALDataset *gdal_src;
+	GByte *data;
+	vsi_l_offset length;
+};
+
+NAN_METHOD(Driver::encodeAsync)
+{
+	Nan::HandleScope scope;
+	Driver *driver = Nan::ObjectWrap::Unwrap<Driver>(info.This());
+
+	if(!driver->isAlive()){
+		Nan::ThrowError("Driver object has already been destroyed");
+		return;
+	}
+
+	Dataset* src_dataset;
+	StringList options;
+	Local<Function> progress;
+	Local<Object> cancel_flag;
+	Local<Function> callback;
+
+	NODE_ARG_WRAPPED(0, "source dataset", Dataset, src_dataset);
+
+	if(info.Length() > 1 && options.parse(info[1])){
+		return; //error parsing string list
+	}
+
+	NODE_ARG_CALLBACK_OPT(2, "progress", progress);
+	NODE_ARG_CANCEL_TOKEN_OPT(3, "cancel token", cancel_flag);
+	NODE_ARG_CALLBACK(4, "callback", callback);
+
+	#if GDAL_VERSION_MAJOR < 2
+	if (driver->uses_ogr || src_dataset->uses_ogr){
+		Nan::ThrowError("Driver unable to encode dataset");
+		return;
+	}
+	#endif
+
+	EncodeWorker *worker = new EncodeWorker(new Nan::Callback(callback), driver, src_dataset, options.get());
+	if (!progress.IsEmpty()) worker->setProgressCallback(progress);
+	if (!cancel_flag.IsEmpty()) worker->setCancelToken(cancel_flag);
+	worker->SaveToPersistent("driver", info.This());
+	worker->SaveToPersistent("src", info[0].As<Object>());
+	worker->queue();
+}
+
 /**
  * Copy the files of a dataset.
  *
@@ -505,6 +871,7 @@ NAN_METHOD(Driver::open)
 
 	NODE_ARG_STR(0, "path", path);
 	NODE_ARG_OPT_STR(1, "mode", mode);
+	if (refuseBufferPath(path)) return;
 
 	if (mode == "r+") {
 		access = GA_Update;
@@ -537,4 +904,98 @@ NAN_METHOD(Driver::open)
 	info.GetReturnValue().Set(Dataset::New(ds));
 }
 
-} // namespace node_gdal
\ No newline at end of file
+// Performs the driver probe / header parsing for openAsync() on the libuv threadpool
+class DriverOpenWorker : public Nan::AsyncWorker {
+public:
+	DriverOpenWorker(Nan::Callback *callback, Driver *driver, std::string path, GDALAccess access)
+		: Nan::AsyncWorker(callback), path(path), access(access), ds(NULL)
+		#if GDAL_VERSION_MAJOR < 2
+		, ogr_driver(NULL), ogr_ds(NULL)
+		#endif
+	{
+		#if GDAL_VERSION_MAJOR < 2
+		if (driver->uses_ogr) {
+			ogr_driver = driver->getOGRSFDriver();
+		}
+		#endif
+		gdal_driver = driver->getGDALDriver();
+	}
+
+	void Execute()
+	{
+		#if GDAL_VERSION_MAJOR < 2
+		if (ogr_driver) {
+			ogr_ds = ogr_driver->Open(path.c_str(), static_cast<int>(access));
+			if (!ogr_ds) {
+				SetErrorMessage("Error opening dataset");
+			}
+			return;
+		}
+		#endif
+
+		GDALOpenInfo *open_info = new GDALOpenInfo(path.c_str(), access);
+		ds = gdal_driver->pfnOpen(open_info);
+		delete open_info;
+		if (!ds) {
+			SetErrorMessage("Error opening dataset");
+		}
+	}
+
+	void HandleOKCallback()
+	{
+		Nan::HandleScope scope;
+
+		Local<Value> result;
+		#if GDAL_VERSION_MAJOR < 2
+		if (ogr_ds) {
+			result = Dataset::New(ogr_ds);
+		} else {
+			result = Dataset::New(ds);
+		}
+		#else
+		result = Dataset::New(ds);
+		#endif
+
+		Local<Value> argv[] = { Nan::Null(), result };
+		callback->Call(2, argv, async_resource);
+	}
+
+private:
+	std::string path;
+	GDALAccess access;
+	GDALDriver *gdal_driver;
+	GDALDataset *ds;
+	#if GDAL_VERSION_MAJOR < 2
+	OGRSFDriver *ogr_driver;
+	OGRDataSource *ogr_ds;
+	#endif
+};
+
+NAN_METHOD(Driver::openAsync)
+{
+	Nan::HandleScope scope;
+	Driver *driver = Nan::ObjectWrap::Unwrap<Driver>(info.This());
+
+	std::string path;
+	std::string mode = "r";
+	GDALAccess access = GA_ReadOnly;
+	Local<Function> callback;
+
+	NODE_ARG_STR(0, "path", path);
+	NODE_ARG_OPT_STR(1, "mode", mode);
+	NODE_ARG_CALLBACK(2, "callback", callback);
+	if (refuseBufferPath(path)) return;
+
+	if (mode == "r+") {
+		access = GA_Update;
+	} else if (mode != "r") {
+		Nan::ThrowError("Invalid open mode. Must be \"r\" or \"r+\"");
+		return;
+	}
+
+	DriverOpenWorker *worker = new DriverOpenWorker(new Nan::Callback(callback), driver, path, access);
+	worker->SaveToPersistent("driver", info.This());
+	Nan::AsyncQueueWorker(worker);
+}
+
+} // namespace node_gdal
@@ -35,8 +35,12 @@ public:
 	static Local<Value> New(GDALDriver *driver);
 	static NAN_METHOD(toString);
 	static NAN_METHOD(open);
+	static NAN_METHOD(openAsync);
 	static NAN_METHOD(create);
 	static NAN_METHOD(createCopy);
+	static NAN_METHOD(createCopyAsync);
+	static NAN_METHOD(encode);
+	static NAN_METHOD(encodeAsync);
 	static NAN_METHOD(deleteDataset);
 	static NAN_METHOD(rename);
 	static NAN_METHOD(copyFiles);
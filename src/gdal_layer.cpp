@@ -9,6 +9,7 @@
 #include "gdal_geometry.hpp"
 #include "collections/layer_features.hpp"
 #include "collections/layer_fields.hpp"
+#include "utils/dataset_worker.hpp"
 
 #include <stdlib.h>
 #include <sstream>
@@ -201,7 +202,24 @@ NAN_METHOD(Layer::toString)
  * @throws Error
  * @method flush
  */
-NODE_WRAPPED_METHOD_WITH_OGRERR_RESULT(Layer, syncToDisk, SyncToDisk);
+NAN_METHOD(Layer::syncToDisk)
+{
+	Nan::HandleScope scope;
+
+	Layer *layer = Nan::ObjectWrap::Unwrap<Layer>(info.This());
+	if (!layer->isAlive()) {
+		Nan::ThrowError("Layer object has already been destroyed");
+		return;
+	}
+
+	DatasetSyncLock lock(layer->uid);
+	int err = layer->this_->SyncToDisk();
+	if (err) {
+		NODE_THROW_OGRERR(err);
+		return;
+	}
+	return;
+}
 
 /**
  * Determines if the dataset supports the indicated operation.
@@ -210,7 +228,21 @@ NODE_WRAPPED_METHOD_WITH_OGRERR_RESULT(Layer, syncToDisk, SyncToDisk);
  * @param {string} capability (see {{#crossLink "Constants (OLC)"}}capability list{{/crossLink}})
  * @return {Boolean}
  */
-NODE_WRAPPED_METHOD_WITH_RESULT_1_STRING_PARAM(Layer, testCapability, Boolean, TestCapability, "capability");
+NAN_METHOD(Layer::testCapability)
+{
+	Nan::HandleScope scope;
+	std::string capability;
+	NODE_ARG_STR(0, "capability", capability);
+
+	Layer *layer = Nan::ObjectWrap::Unwrap<Layer>(info.This());
+	if (!layer->isAlive()) {
+		Nan::ThrowError("Layer object has already been destroyed");
+		return;
+	}
+
+	DatasetSyncLock lock(layer->uid);
+	info.GetReturnValue().Set(Nan::New<Boolean>(layer->this_->TestCapability(capability.c_str())));
+}
 
 /**
  * Fetch the extent of this layer.
@@ -230,6 +262,8 @@ NAN_METHOD(Layer::getExtent)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	int force = 1;
 	NODE_ARG_BOOL_OPT(0, "force", force);
 
@@ -268,6 +302,8 @@ NAN_METHOD(Layer::getSpatialFilter)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	info.GetReturnValue().Set(Geometry::New(layer->this_->GetSpatialFilter(), false));
 }
 
@@ -297,6 +333,8 @@ NAN_METHOD(Layer::setSpatialFilter)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	if(info.Length() == 1) {
 		Geometry *filter = NULL;
 		NODE_ARG_WRAPPED_OPT(0, "filter", Geometry, filter);
@@ -354,6 +392,8 @@ NAN_METHOD(Layer::setAttributeFilter)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	std::string filter = "";
 	NODE_ARG_OPT_STR(0, "filter", filter);
 
@@ -384,6 +424,8 @@ NAN_METHOD(Layer::getLayerDefn)
 		return;
 	}
 
+	DatasetSyncLock lock(layer->uid);
+
 	info.GetReturnValue().Set(FeatureDefn::New(layer->this_->GetLayerDefn(), false));
 }*/
 
@@ -411,6 +453,8 @@ NAN_GETTER(Layer::srsGetter)
 		Nan::ThrowError("Layer object has already been destroyed");
 		return;
 	}
+
+	DatasetSyncLock lock(layer->uid);
 	info.GetReturnValue().Set(SpatialReference::New(layer->this_->GetSpatialRef(), false));
 }
 
@@ -427,6 +471,8 @@ NAN_GETTER(Layer::nameGetter)
 		Nan::ThrowError("Layer object has already been destroyed");
 		return;
 	}
+
+	DatasetSyncLock lock(layer->uid);
 	info.GetReturnValue().Set(SafeString::New(layer->this_->GetName()));
 }
 
@@ -443,6 +489,8 @@ NAN_GETTER(Layer::geomColumnGetter)
 		Nan::ThrowError("Layer object has already been destroyed");
 		return;
 	}
+
+	DatasetSyncLock lock(layer->uid);
 	info.GetReturnValue().Set(SafeString::New(layer->this_->GetGeometryColumn()));
 }
 
@@ -459,6 +507,8 @@ NAN_GETTER(Layer::fidColumnGetter)
 		Nan::ThrowError("Layer object has already been destroyed");
 		return;
 	}
+
+	DatasetSyncLock lock(layer->uid);
 	info.GetReturnValue().Set(SafeString::New(layer->this_->GetFIDColumn()));
 }
 
@@ -475,6 +525,8 @@ NAN_GETTER(Layer::geomTypeGetter)
 		Nan::ThrowError("Layer object has already been destroyed");
 		return;
 	}
+
+	DatasetSyncLock lock(layer->uid);
 	info.GetReturnValue().Set(Nan::New<Integer>(layer->this_->GetGeomType()));
 }
 
@@ -6,9 +6,12 @@
 #include "gdal_dataset.hpp"
 #include "collections/rasterband_overviews.hpp"
 #include "collections/rasterband_pixels.hpp"
+#include "utils/band_stats.hpp"
+#include "utils/dataset_worker.hpp"
 
 #include <limits>
 #include <cpl_port.h>
+#include <cpl_multiproc.h>
 
 namespace node_gdal {
 
@@ -33,13 +36,16 @@ void RasterBand::Initialize(Local<Object> target)
 	Nan::SetPrototypeMethod(lcons, "getMaskFlags", getMaskFlags);
 	Nan::SetPrototypeMethod(lcons, "createMaskBand", createMaskBand);
 	Nan::SetPrototypeMethod(lcons, "getMetadata", getMetadata);
+	Nan::SetPrototypeMethod(lcons, "getCacheStats", getCacheStats);
+	Nan::SetPrototypeMethod(lcons, "resetCacheStats", resetCacheStats);
+	Nan::SetPrototypeMethod(lcons, "getHistogram", getHistogram);
+	Nan::SetPrototypeMethod(lcons, "getHistogramAsync", getHistogramAsync);
 
 	// unimplemented methods
 	//Nan::SetPrototypeMethod(lcons, "buildOverviews", buildOverviews);
 	//Nan::SetPrototypeMethod(lcons, "rasterIO", rasterIO);
 	//Nan::SetPrototypeMethod(lcons, "getColorTable", getColorTable);
 	//Nan::SetPrototypeMethod(lcons, "setColorTable", setColorTable);
-	//Nan::SetPrototypeMethod(lcons, "getHistogram", getHistogram);
 	//Nan::SetPrototypeMethod(lcons, "getDefaultHistogram", getDefaultHistogram);
 	//Nan::SetPrototypeMethod(lcons, "setDefaultHistogram", setDefaultHistogram);
 
@@ -181,7 +187,20 @@ NAN_METHOD(RasterBand::toString)
  *
  * @method flush
  */
-NODE_WRAPPED_METHOD(RasterBand, flush, FlushCache);
+NAN_METHOD(RasterBand::flush)
+{
+	Nan::HandleScope scope;
+
+	RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(info.This());
+	if (!band->isAlive()) {
+		Nan::ThrowError("RasterBand object has already been destroyed");
+		return;
+	}
+
+	DatasetSyncLock lock(band->uid);
+	band->this_->FlushCache();
+	return;
+}
 
 /**
  * Return the status flags of the mask band associated with the band.
@@ -197,7 +216,19 @@ NODE_WRAPPED_METHOD(RasterBand, flush, FlushCache);
  * @method getMaskFlags
  * @return {Integer} Mask flags
  */
-NODE_WRAPPED_METHOD_WITH_RESULT(RasterBand, getMaskFlags, Integer, GetMaskFlags);
+NAN_METHOD(RasterBand::getMaskFlags)
+{
+	Nan::HandleScope scope;
+
+	RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(info.This());
+	if (!band->isAlive()) {
+		Nan::ThrowError("RasterBand object has already been destroyed");
+		return;
+	}
+
+	DatasetSyncLock lock(band->uid);
+	info.GetReturnValue().Set(Nan::New<Integer>(band->this_->GetMaskFlags()));
+}
 // TODO: expose GMF constants in API
 // ({{#crossLink "Constants (GMF)"}}see flags{{/crossLink}})
 
@@ -208,7 +239,26 @@ NODE_WRAPPED_METHOD_WITH_RESULT(RasterBand, getMaskFlags, Integer, GetMaskFlags)
  * @method createMaskBand
  * @param {Integer} flags Mask flags
  */
-NODE_WRAPPED_METHOD_WITH_CPLERR_RESULT_1_INTEGER_PARAM(RasterBand, createMaskBand, CreateMaskBand, "mask flags");
+NAN_METHOD(RasterBand::createMaskBand)
+{
+	Nan::HandleScope scope;
+	int flags;
+	NODE_ARG_INT(0, "mask flags", flags);
+
+	RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(info.This());
+	if (!band->isAlive()) {
+		Nan::ThrowError("RasterBand object has already been destroyed");
+		return;
+	}
+
+	DatasetSyncLock lock(band->uid);
+	int err = band->this_->CreateMaskBand(flags);
+	if (err) {
+		NODE_THROW_CPLERR(err);
+		return;
+	}
+	return;
+}
 // TODO: expose GMF constants in API
 // ({{#crossLink "Constants (GMF)"}}see flags{{/crossLink}})
 
@@ -228,6 +278,8 @@ NAN_METHOD(RasterBand::getMaskBand)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	GDALRasterBand *mask_band = band->this_->GetMaskBand();
 
 	if(!mask_band) {
@@ -259,6 +311,8 @@ NAN_METHOD(RasterBand::fill)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int err = band->this_->Fill(real, imaginary);
 
 	if (err) {
@@ -317,6 +371,8 @@ NAN_METHOD(RasterBand::getStatistics)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	pushStatsErrorHandler();
 	CPLErr err = band->this_->GetStatistics(approx, force, &min, &max, &mean, &std_dev);
 	popStatsErrorHandler();
@@ -348,6 +404,10 @@ NAN_METHOD(RasterBand::getStatistics)
  * argument can be set to `true` in which case overviews, or a subset of image tiles
  * may be used in computing the statistics.
  *
+ * The band is scanned on several threads, like
+ * {{#crossLink "gdal.RasterBand/getHistogram:method"}}getHistogram(){{/crossLink}},
+ * and the statistics are stored on the band as GDAL would.
+ *
  * @throws Error
  * @method computeStatistics
  * @param {Boolean} allow_approximation If `true` statistics may be computed based on overviews or a subset of all tiles.
@@ -356,7 +416,6 @@ NAN_METHOD(RasterBand::getStatistics)
 NAN_METHOD(RasterBand::computeStatistics)
 {
 	Nan::HandleScope scope;
-	double min, max, mean, std_dev;
 	int approx;
 	NODE_ARG_BOOL(0, "allow approximation", approx);
 
@@ -366,8 +425,11 @@ NAN_METHOD(RasterBand::computeStatistics)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
+	BandStats stats;
 	pushStatsErrorHandler();
-	CPLErr err = band->this_->ComputeStatistics(approx, &min, &max, &mean, &std_dev, NULL, NULL);
+	CPLErr err = computeBandStatistics(band->this_, approx, CPLGetNumCPUs(), stats, NULL, NULL);
 	popStatsErrorHandler();
 	if (!stats_file_err.empty()){
 		Nan::ThrowError(stats_file_err.c_str());
@@ -377,10 +439,10 @@ NAN_METHOD(RasterBand::computeStatistics)
 	}
 
 	Local<Object> result = Nan::New<Object>();
-	result->Set(Nan::New("min").ToLocalChecked(), Nan::New<Number>(min));
-	result->Set(Nan::New("max").ToLocalChecked(), Nan::New<Number>(max));
-	result->Set(Nan::New("mean").ToLocalChecked(), Nan::New<Number>(mean));
-	result->Set(Nan::New("std_dev").ToLocalChecked(), Nan::New<Number>(std_dev));
+	result->Set(Nan::New("min").ToLocalChecked(), Nan::New<Number>(stats.min));
+	result->Set(Nan::New("max").ToLocalChecked(), Nan::New<Number>(stats.max));
+	result->Set(Nan::New("mean").ToLocalChecked(), Nan::New<Number>(stats.mean));
+	result->Set(Nan::New("std_dev").ToLocalChecked(), Nan::New<Number>(stats.std_dev));
 
 	info.GetReturnValue().Set(result);
 }
@@ -412,6 +474,8 @@ NAN_METHOD(RasterBand::setStatistics)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	CPLErr err = band->this_->SetStatistics(min, max, mean, std_dev);
 
 	if (err) {
@@ -421,6 +485,270 @@ NAN_METHOD(RasterBand::setStatistics)
 	return;
 }
 
+/**
+ * Returns block cache counters of the band since it was opened or the
+ * counters were last reset.
+ *
+ * `hits` and `misses` count block lookups in GDAL's raster block cache,
+ * `bytes_decoded` the block data read from the file (cache misses plus
+ * {{#crossLink "gdal.RasterBandPixels/readBlock:method"}}readBlock(){{/crossLink}},
+ * which bypasses the cache) and `evictions` the blocks of this band dropped
+ * to make room for others. Only available with the bundled GDAL.
+ *
+ * @example
+ * ```
+ * var stats = band.getCacheStats();
+ * var hit_rate = stats.hits / (stats.hits + stats.misses);```
+ *
+ * @throws Error
+ * @method getCacheStats
+ * @return {Object} `{hits, misses, evictions, bytes_decoded}`
+ */
+NAN_METHOD(RasterBand::getCacheStats)
+{
+	Nan::HandleScope scope;
+
+	RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(info.This());
+	if (!band->isAlive()) {
+		Nan::ThrowError("RasterBand object has already been destroyed");
+		return;
+	}
+
+	#ifndef BUNDLED_GDAL
+	Nan::ThrowError("Block cache statistics require the bundled GDAL");
+	return;
+	#else
+	GIntBig hits, misses, evictions, bytes_decoded;
+	band->this_->GetBlockCacheStats(&hits, &misses, &evictions, &bytes_decoded);
+
+	Local<Object> result = Nan::New<Object>();
+	result->Set(Nan::New("hits").ToLocalChecked(), Nan::New<Number>((double) hits));
+	result->Set(Nan::New("misses").ToLocalChecked(), Nan::New<Number>((double) misses));
+	result->Set(Nan::New("evictions").ToLocalChecked(), Nan::New<Number>((double) evictions));
+	result->Set(Nan::New("bytes_decoded").ToLocalChecked(), Nan::New<Number>((double) bytes_decoded));
+
+	info.GetReturnValue().Set(result);
+	#endif
+}
+
+/**
+ * Resets the band's block cache counters to zero.
+ *
+ * @throws Error
+ * @method resetCacheStats
+ */
+NAN_METHOD(RasterBand::resetCacheStats)
+{
+	Nan::HandleScope scope;
+
+	RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(info.This());
+	if (!band->isAlive()) {
+		Nan::ThrowError("RasterBand object has already been destroyed");
+		return;
+	}
+
+	#ifndef BUNDLED_GDAL
+	Nan::ThrowError("Block cache statistics require the bundled GDAL");
+	#else
+	band->this_->ResetBlockCacheStats();
+	#endif
+}
+
+static Local<Value> histogramResult(const BandStats &stats)
+{
+	Nan::EscapableHandleScope scope;
+
+	Local<Array> buckets = Nan::New<Array>(stats.buckets.size());
+	for(size_t i = 0; i < stats.buckets.size(); i++) {
+		buckets->Set(i, Nan::New<Number>((double) stats.buckets[i]));
+	}
+
+	Local<Object> statistics = Nan::New<Object>();
+	statistics->Set(Nan::New("count").ToLocalChecked(), Nan::New<Number>((double) stats.count));
+	statistics->Set(Nan::New("min").ToLocalChecked(), Nan::New<Number>(stats.min));
+	statistics->Set(Nan::New("max").ToLocalChecked(), Nan::New<Number>(stats.max));
+	statistics->Set(Nan::New("mean").ToLocalChecked(), Nan::New<Number>(stats.mean));
+	statistics->Set(Nan::New("std_dev").ToLocalChecked(), Nan::New<Number>(stats.std_dev));
+
+	Local<Object> result = Nan::New<Object>();
+	result->Set(Nan::New("min").ToLocalChecked(), Nan::New<Number>(stats.hist_min));
+	result->Set(Nan::New("max").ToLocalChecked(), Nan::New<Number>(stats.hist_max));
+	result->Set(Nan::New("buckets").ToLocalChecked(), buckets);
+	result->Set(Nan::New("statistics").ToLocalChecked(), statistics);
+
+	if(!stats.percentiles.empty()) {
+		Local<Array> percentiles = Nan::New<Array>(stats.percentiles.size());
+		for(size_t i = 0; i < stats.percentiles.size(); i++) {
+			percentiles->Set(i, Nan::New<Number>(stats.percentiles[i]));
+		}
+		result->Set(Nan::New("percentiles").ToLocalChecked(), percentiles);
+	}
+
+	return scope.Escape(result);
+}
+
+// Computes a histogram for getHistogramAsync() on the libuv threadpool, holding the dataset lock
+class HistogramWorker : public DatasetProgressWorker {
+public:
+	HistogramWorker(Nan::Callback *callback, RasterBand *band, const BandStatsOptions &options)
+		: DatasetProgressWorker(callback, band->uid), raw(band->get()), options(options)
+	{}
+
+protected:
+	void Run()
+	{
+		if(computeBandStats(raw, options, stats, ProgressFunc, this)) {
+			SetCPLErrorMessage("Error computing histogram");
+		}
+	}
+
+	Local<Value> GetResult()
+	{
+		return histogramResult(stats);
+	}
+
+private:
+	GDALRasterBand *raw;
+	BandStatsOptions options;
+	BandStats stats;
+};
+
+/**
+ * Computes a histogram of the band, along with its statistics and optionally
+ * percentiles, skipping nodata pixels.
+ *
+ * The band is scanned in chunks of block rows spread over several threads.
+ * 8 and 16 bit bands are read once and their percentiles are exact; other
+ * types are read twice unless `min` and `max` are given, and their
+ * percentiles are interpolated within a histogram bucket.
+ *
+ * @example
+ * ```
+ * // 2% - 98% contrast stretch
+ * var h = band.getHistogram({approximate: true, percentiles: [2, 98]});
+ * var low = h.percentiles[0], high = h.percentiles[1];```
+ *
+ * @throws Error
+ * @method getHistogram
+ * @param {Object} [options]
+ * @param {Boolean} [options.approximate=false] Use the smallest overview GDAL would use for approximate statistics, when there is one.
+ * @param {Number} [options.min] Lower bound of the histogram. Must be given along with `max`; the range of the data is used by default.
+ * @param {Number} [options.max] Upper bound of the histogram (inclusive).
+ * @param {Integer} [options.buckets=256]
+ * @param {Boolean} [options.includeOutOfRange=false] Count values outside `[min, max]` in the first and last bucket.
+ * @param {Number[]} [options.percentiles] Percentiles to compute, between 0 and 100.
+ * @param {Integer} [options.threads] Defaults to the number of CPUs.
+ * @return {Object} An object with the histogram's `min`, `max` and `buckets` (an array of counts), the `statistics` of the pixels (`count`, `min`, `max`, `mean` and `std_dev`) and, if requested, the `percentiles` in the order they were given.
+ */
+NAN_METHOD(RasterBand::getHistogram)
+{
+	doGetHistogram(info, false);
+}
+
+NAN_METHOD(RasterBand::getHistogramAsync)
+{
+	doGetHistogram(info, true);
+}
+
+void RasterBand::doGetHistogram(NAN_METHOD_ARGS_TYPE info, bool async)
+{
+	Nan::HandleScope scope;
+
+	RasterBand *band = Nan::ObjectWrap::Unwrap<RasterBand>(info.This());
+	if (!band->isAlive()) {
+		Nan::ThrowError("RasterBand object has already been destroyed");
+		return;
+	}
+
+	BandStatsOptions options;
+	options.approximate = false;
+	options.histogram = true;
+	options.has_range = false;
+	options.min = 0;
+	options.max = 0;
+	options.buckets = 256;
+	options.include_out_of_range = false;
+	options.threads = CPLGetNumCPUs();
+
+	Local<Object> obj;
+	if (info.Length() > 0 && !info[0]->IsNull() && !info[0]->IsUndefined()) {
+		NODE_ARG_OBJECT(0, "options", obj);
+
+		bool has_min = Nan::HasOwnProperty(obj, Nan::New("min").ToLocalChecked()).FromMaybe(false);
+		bool has_max = Nan::HasOwnProperty(obj, Nan::New("max").ToLocalChecked()).FromMaybe(false);
+		if (has_min != has_max) {
+			Nan::ThrowError("min and max must be given together");
+			return;
+		}
+		NODE_DOUBLE_FROM_OBJ_OPT(obj, "min", options.min);
+		NODE_DOUBLE_FROM_OBJ_OPT(obj, "max", options.max);
+		NODE_INT_FROM_OBJ_OPT(obj, "buckets", options.buckets);
+		NODE_INT_FROM_OBJ_OPT(obj, "threads", options.threads);
+		options.has_range = has_min;
+		options.approximate = obj->Get(Nan::New("approximate").ToLocalChecked())->BooleanValue();
+		options.include_out_of_range = obj->Get(Nan::New("includeOutOfRange").ToLocalChecked())->BooleanValue();
+
+		if (options.has_range && !(options.min <= options.max)) {
+			Nan::ThrowRangeError("min must not be greater than max");
+			return;
+		}
+		if (options.buckets < 1) {
+			Nan::ThrowRangeError("buckets must be greater than 0");
+			return;
+		}
+		if (options.threads < 1) {
+			Nan::ThrowRangeError("threads must be greater than 0");
+			return;
+		}
+
+		Local<Value> percentiles = obj->Get(Nan::New("percentiles").ToLocalChecked());
+		if (percentiles->IsArray()) {
+			Local<Array> array = percentiles.As<Array>();
+			for (unsigned int i = 0; i < array->Length(); i++) {
+				Local<Value> val = array->Get(i);
+				if (!val->IsNumber() || val->NumberValue() < 0 || val->NumberValue() > 100) {
+					Nan::ThrowRangeError("percentiles must be numbers between 0 and 100");
+					return;
+				}
+				options.percentiles.push_back(val->NumberValue());
+			}
+		} else if (!percentiles->IsNull() && !percentiles->IsUndefined()) {
+			Nan::ThrowTypeError("percentiles must be an array");
+			return;
+		}
+	}
+
+	if (async) {
+		Local<Function> progress;
+		Local<Object> cancel_flag;
+		Local<Function> callback;
+
+		NODE_ARG_CALLBACK_OPT(1, "progress", progress);
+		NODE_ARG_CANCEL_TOKEN_OPT(2, "cancel token", cancel_flag);
+		NODE_ARG_CALLBACK(3, "callback", callback);
+
+		HistogramWorker *worker = new HistogramWorker(new Nan::Callback(callback), band, options);
+		if (!progress.IsEmpty()) worker->setProgressCallback(progress);
+		if (!cancel_flag.IsEmpty()) worker->setCancelToken(cancel_flag);
+		worker->SaveToPersistent("band", info.This());
+		worker->queue();
+		return;
+	}
+
+	BandStats stats;
+	CPLErr err;
+	{
+		DatasetSyncLock lock(band->uid);
+		err = computeBandStats(band->this_, options, stats, NULL, NULL);
+	}
+	if (err) {
+		NODE_THROW_CPLERR(err);
+		return;
+	}
+
+	info.GetReturnValue().Set(histogramResult(stats));
+}
+
 /**
  * Returns band metadata
  *
@@ -440,6 +768,8 @@ NAN_METHOD(RasterBand::getMetadata)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	info.GetReturnValue().Set(MajorObject::getMetadata(band->this_, domain.empty() ? NULL : domain.c_str()));
 }
 
@@ -517,6 +847,8 @@ NAN_GETTER(RasterBand::descriptionGetter) {
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	info.GetReturnValue().Set(SafeString::New(band->this_->GetDescription()));
 }
 
@@ -536,6 +868,9 @@ NAN_GETTER(RasterBand::sizeGetter)
 		return;
 	}
 
+	// GDAL doesn't change a band's size after it is opened, so this doesn't
+	// wait for async jobs on the dataset like most accessors
+
 	Local<Object> result = Nan::New<Object>();
 	result->Set(Nan::New("x").ToLocalChecked(), Nan::New<Integer>(band->this_->GetXSize()));
 	result->Set(Nan::New("y").ToLocalChecked(), Nan::New<Integer>(band->this_->GetYSize()));
@@ -558,6 +893,8 @@ NAN_GETTER(RasterBand::blockSizeGetter)
 		return;
 	}
 
+	// fixed once the band is opened, like size
+
 	int x, y;
 	band->this_->GetBlockSize(&x, &y);
 
@@ -583,6 +920,8 @@ NAN_GETTER(RasterBand::minimumGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int success = 0;
 	double result = band->this_->GetMinimum(&success);
 	info.GetReturnValue().Set(Nan::New<Number>(result));
@@ -604,6 +943,8 @@ NAN_GETTER(RasterBand::maximumGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int success = 0;
 	double result = band->this_->GetMaximum(&success);
 	info.GetReturnValue().Set(Nan::New<Number>(result));
@@ -624,6 +965,8 @@ NAN_GETTER(RasterBand::offsetGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int success = 0;
 	double result = band->this_->GetOffset(&success);
 	info.GetReturnValue().Set(Nan::New<Number>(result));
@@ -644,6 +987,8 @@ NAN_GETTER(RasterBand::scaleGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int success = 0;
 	double result = band->this_->GetScale(&success);
 	info.GetReturnValue().Set(Nan::New<Number>(result));
@@ -664,6 +1009,8 @@ NAN_GETTER(RasterBand::noDataValueGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	int success = 0;
 	double result = band->this_->GetNoDataValue(&success);
 
@@ -694,6 +1041,8 @@ NAN_GETTER(RasterBand::unitTypeGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	const char *result = band->this_->GetUnitType();
 	info.GetReturnValue().Set(SafeString::New(result));
 }
@@ -714,6 +1063,8 @@ NAN_GETTER(RasterBand::dataTypeGetter)
 		return;
 	}
 
+	// fixed once the band is opened, like size
+
 	GDALDataType type = band->this_->GetRasterDataType();
 
 	if(type == GDT_Unknown) return;
@@ -736,6 +1087,8 @@ NAN_GETTER(RasterBand::readOnlyGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	GDALAccess result = band->this_->GetAccess();
 	info.GetReturnValue().Set(result == GA_Update ? Nan::False() : Nan::True());
 }
@@ -760,6 +1113,8 @@ NAN_GETTER(RasterBand::hasArbitraryOverviewsGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	bool result = band->this_->HasArbitraryOverviews();
 	info.GetReturnValue().Set(Nan::New<Boolean>(result));
 }
@@ -779,6 +1134,8 @@ NAN_GETTER(RasterBand::categoryNamesGetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	char ** names = band->this_->GetCategoryNames();
 
 	Local<Array> results = Nan::New<Array>();
@@ -808,6 +1165,8 @@ NAN_GETTER(RasterBand::colorInterpretationGetter)
 		Nan::ThrowError("RasterBand object has already been destroyed");
 		return;
 	}
+
+	DatasetSyncLock lock(band->uid);
 	GDALColorInterp interp = band->this_->GetColorInterpretation();
 	if(interp == GCI_Undefined) return;
 	else info.GetReturnValue().Set(SafeString::New(GDALGetColorInterpretationName(interp)));
@@ -822,6 +1181,8 @@ NAN_SETTER(RasterBand::unitTypeSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	if (!value->IsString()) {
 		Nan::ThrowError("Unit type must be a string");
 		return;
@@ -842,6 +1203,8 @@ NAN_SETTER(RasterBand::noDataValueSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	double input;
 
 	if (value->IsNull() || value -> IsUndefined()){
@@ -868,6 +1231,8 @@ NAN_SETTER(RasterBand::scaleSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	if (!value->IsNumber()) {
 		Nan::ThrowError("Scale must be a number");
 		return;
@@ -888,6 +1253,8 @@ NAN_SETTER(RasterBand::offsetSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	if (!value->IsNumber()) {
 		Nan::ThrowError("Offset must be a number");
 		return;
@@ -908,6 +1275,8 @@ NAN_SETTER(RasterBand::categoryNamesSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	if(!value->IsArray()){
 		Nan::ThrowError("Category names must be an array");
 		return;
@@ -948,6 +1317,8 @@ NAN_SETTER(RasterBand::colorInterpretationSetter)
 		return;
 	}
 
+	DatasetSyncLock lock(band->uid);
+
 	GDALColorInterp ci = GCI_Undefined;
 
 	if (value->IsString()) {
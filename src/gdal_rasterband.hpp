@@ -38,13 +38,16 @@ public:
 	static NAN_METHOD(getMaskFlags);
 	static NAN_METHOD(createMaskBand);
 	static NAN_METHOD(getMetadata);
+	static NAN_METHOD(getCacheStats);
+	static NAN_METHOD(resetCacheStats);
+	static NAN_METHOD(getHistogram);
+	static NAN_METHOD(getHistogramAsync);
 
 	// unimplemented methods
 	//static NAN_METHOD(getColorTable);
 	//static NAN_METHOD(setColorTable);
 	//static NAN_METHOD(rasterIO);
 	//static NAN_METHOD(buildOverviews);
-	//static NAN_METHOD(getHistogram);
 	//static NAN_METHOD(getDefaultHistogram);
 	//static NAN_METHOD(setDefaultHistogram);
 
@@ -92,6 +95,7 @@ public:
 	long uid;
 private:
 	~RasterBand();
+	static void doGetHistogram(NAN_METHOD_ARGS_TYPE info, bool async);
 	GDALRasterBand *this_;
 	GDALDataset *parent_ds;
 };
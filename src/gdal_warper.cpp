@@ -3,6 +3,9 @@
 #include "gdal_common.hpp"
 #include "gdal_spatial_reference.hpp"
 #include "gdal_dataset.hpp"
+#include "utils/dataset_worker.hpp"
+#include "utils/string_list.hpp"
+#include "utils/tile_generator.hpp"
 
 namespace node_gdal {
 
@@ -10,7 +13,10 @@ namespace node_gdal {
 void Warper::Initialize(Local<Object> target)
 {
 	Nan::SetMethod(target, "reprojectImage", reprojectImage);
+	Nan::SetMethod(target, "reprojectImageAsync", reprojectImageAsync);
 	Nan::SetMethod(target, "suggestedWarpOutput", suggestedWarpOutput);
+	Nan::SetMethod(target, "generateTiles", generateTiles);
+	Nan::SetMethod(target, "generateTilesAsync", generateTilesAsync);
 }
 
 /**
@@ -194,6 +200,53 @@ CPLErr GDALReprojectImageMulti( GDALDatasetH hSrcDS, const char *pszSrcWKT,
     return eErr;
 }
 
+// Parses the options object shared by reprojectImage() and reprojectImageAsync().
+// On success the WKT strings are set and owned by the caller; on error they are
+// left NULL and a JS exception is pending.
+static void parseReprojectOptions(Local<Object> obj, WarpOptions &options, char **s_srs_wkt, char **t_srs_wkt, double &maxError)
+{
+	SpatialReference* s_srs;
+	SpatialReference* t_srs;
+	char *s_wkt, *t_wkt;
+
+	*s_srs_wkt = NULL;
+	*t_srs_wkt = NULL;
+
+	if(options.parse(obj)){
+		return; // error parsing options object
+	}
+	if(!options.get()->hDstDS){
+		Nan::ThrowTypeError("dst Dataset must be provided");
+		return;
+	}
+
+	NODE_WRAPPED_FROM_OBJ(obj, "s_srs", SpatialReference, s_srs);
+	NODE_WRAPPED_FROM_OBJ(obj, "t_srs", SpatialReference, t_srs);
+	NODE_DOUBLE_FROM_OBJ_OPT(obj, "maxError", maxError);
+
+	if(s_srs->get()->exportToWkt(&s_wkt)){
+		Nan::ThrowError("Error converting s_srs to WKT");
+		return;
+	}
+	if(t_srs->get()->exportToWkt(&t_wkt)){
+		CPLFree(s_wkt);
+		Nan::ThrowError("Error converting t_srs to WKT");
+		return;
+	}
+
+	*s_srs_wkt = s_wkt;
+	*t_srs_wkt = t_wkt;
+}
+
+static CPLErr runReprojectImage(GDALWarpOptions *opts, bool multi, const char *s_srs_wkt, const char *t_srs_wkt, double maxError, GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	if(multi){
+		return GDALReprojectImageMulti(opts->hSrcDS, s_srs_wkt, opts->hDstDS, t_srs_wkt, opts->eResampleAlg, opts->dfWarpMemoryLimit, maxError, pfnProgress, pProgressArg, opts);
+	} else {
+		return GDALReprojectImage(opts->hSrcDS, s_srs_wkt, opts->hDstDS, t_srs_wkt, opts->eResampleAlg, opts->dfWarpMemoryLimit, maxError, pfnProgress, pProgressArg, opts);
+	}
+}
+
 /**
  * Reprojects a dataset.
  *
@@ -224,51 +277,25 @@ NAN_METHOD(Warper::reprojectImage)
 	Nan::HandleScope scope;
 
 	Local<Object> obj;
-	Local<Value> prop;
 
 	WarpOptions options;
-	GDALWarpOptions* opts;
-	std::string s_srs_str;
-	std::string t_srs_str;
-	SpatialReference* s_srs;
-	SpatialReference* t_srs;
+	char *s_srs_wkt, *t_srs_wkt;
 	double maxError = 0;
 
 	NODE_ARG_OBJECT(0, "Warp options", obj);
 
-	if(options.parse(obj)){
-		return; // error parsing options object
-	} else {
-		opts = options.get();
-	}
-	if(!opts->hDstDS){
-		Nan::ThrowTypeError("dst Dataset must be provided");
-		return;
-	}
-
-	NODE_WRAPPED_FROM_OBJ(obj, "s_srs", SpatialReference, s_srs);
-	NODE_WRAPPED_FROM_OBJ(obj, "t_srs", SpatialReference, t_srs);
-	NODE_DOUBLE_FROM_OBJ_OPT(obj, "maxError", maxError);
-
-	char *s_srs_wkt, *t_srs_wkt;
-	if(s_srs->get()->exportToWkt(&s_srs_wkt)){
-		Nan::ThrowError("Error converting s_srs to WKT");
-		return;
-	}
-	if(t_srs->get()->exportToWkt(&t_srs_wkt)){
-		CPLFree(s_srs_wkt);
-		Nan::ThrowError("Error converting t_srs to WKT");
+	parseReprojectOptions(obj, options, &s_srs_wkt, &t_srs_wkt, maxError);
+	if(!s_srs_wkt){
 		return;
 	}
 
 	CPLErr err;
-
-	if(options.useMultithreading()){
-		err = GDALReprojectImageMulti(opts->hSrcDS, s_srs_wkt, opts->hDstDS, t_srs_wkt, opts->eResampleAlg, opts->dfWarpMemoryLimit, maxError, NULL, NULL, opts);
-	} else {
-		err = GDALReprojectImage(opts->hSrcDS, s_srs_wkt, opts->hDstDS, t_srs_wkt, opts->eResampleAlg, opts->dfWarpMemoryLimit, maxError, NULL, NULL, opts);
+	{
+		DatasetSyncLock lock(Nan::ObjectWrap::Unwrap<Dataset>(obj->Get(Nan::New("src").ToLocalChecked()).As<Object>())->uid);
+		lock.add(Nan::ObjectWrap::Unwrap<Dataset>(obj->Get(Nan::New("dst").ToLocalChecked()).As<Object>())->uid);
+		err = runReprojectImage(options.get(), options.useMultithreading(), s_srs_wkt, t_srs_wkt, maxError, NULL, NULL);
 	}
-	
+
 	CPLFree(s_srs_wkt);
 	CPLFree(t_srs_wkt);
 
@@ -280,6 +307,76 @@ NAN_METHOD(Warper::reprojectImage)
 	return;
 }
 
+// Runs the whole warp (transformer setup, chunking and kernel) for
+// reprojectImageAsync() on the libuv threadpool, holding the src and dst dataset locks
+class ReprojectImageWorker : public DatasetProgressWorker {
+public:
+	ReprojectImageWorker(Nan::Callback *callback, WarpOptions &options, char *s_srs_wkt, char *t_srs_wkt, double maxError)
+		: DatasetProgressWorker(callback), opts(GDALCloneWarpOptions(options.get())), multi(options.useMultithreading()),
+		  s_srs_wkt(s_srs_wkt), t_srs_wkt(t_srs_wkt), maxError(maxError)
+	{}
+
+	~ReprojectImageWorker()
+	{
+		// the clone owns its band lists, nodata arrays and cutline but not the datasets
+		GDALDestroyWarpOptions(opts);
+		CPLFree(s_srs_wkt);
+		CPLFree(t_srs_wkt);
+	}
+
+protected:
+	void Run()
+	{
+		CPLErr err = runReprojectImage(opts, multi, s_srs_wkt, t_srs_wkt, maxError, ProgressFunc, this);
+		if(err) {
+			SetCPLErrorMessage("Error reprojecting image");
+		}
+	}
+
+private:
+	GDALWarpOptions *opts;
+	bool multi;
+	char *s_srs_wkt;
+	char *t_srs_wkt;
+	double maxError;
+};
+
+NAN_METHOD(Warper::reprojectImageAsync)
+{
+	Nan::HandleScope scope;
+
+	Local<Object> obj;
+	Local<Function> progress;
+	Local<Object> cancel_flag;
+	Local<Function> callback;
+
+	WarpOptions options;
+	char *s_srs_wkt, *t_srs_wkt;
+	double maxError = 0;
+
+	NODE_ARG_OBJECT(0, "Warp options", obj);
+	NODE_ARG_CALLBACK_OPT(1, "progress", progress);
+	NODE_ARG_CANCEL_TOKEN_OPT(2, "cancel token", cancel_flag);
+	NODE_ARG_CALLBACK(3, "callback", callback);
+
+	parseReprojectOptions(obj, options, &s_srs_wkt, &t_srs_wkt, maxError);
+	if(!s_srs_wkt){
+		return;
+	}
+
+	Local<Object> src = obj->Get(Nan::New("src").ToLocalChecked()).As<Object>();
+	Local<Object> dst = obj->Get(Nan::New("dst").ToLocalChecked()).As<Object>();
+
+	ReprojectImageWorker *worker = new ReprojectImageWorker(new Nan::Callback(callback), options, s_srs_wkt, t_srs_wkt, maxError);
+	worker->addDataset(Nan::ObjectWrap::Unwrap<Dataset>(src)->uid);
+	worker->addDataset(Nan::ObjectWrap::Unwrap<Dataset>(dst)->uid);
+	if (!progress.IsEmpty()) worker->setProgressCallback(progress);
+	if (!cancel_flag.IsEmpty()) worker->setCancelToken(cancel_flag);
+	worker->SaveToPersistent("src", src);
+	worker->SaveToPersistent("dst", dst);
+	worker->queue();
+}
+
 /**
  * Used to determine the bounds and resolution of the output virtual file which
  * should be large enough to include all the input image.
@@ -351,6 +448,7 @@ NAN_METHOD(Warper::suggestedWarpOutput)
 
 
 
+	DatasetSyncLock lock(ds->uid);
 	void *hTransformArg;
 	void *hGenTransformArg = GDALCreateGenImgProjTransformer(ds->getDataset(), s_srs_wkt, NULL, t_srs_wkt, TRUE, 1000.0, 0 );
 	
@@ -414,4 +512,260 @@ NAN_METHOD(Warper::suggestedWarpOutput)
 }
 
 
+// Parses the options object shared by generateTiles() and generateTilesAsync().
+// Returns non-zero with a JS exception pending on error.
+static int parseTileOptions(Local<Object> obj, TileOptions &options)
+{
+	options.min_zoom = 0;
+	options.max_zoom = -1;
+	options.tile_size = 256;
+	options.resampling = GRA_Bilinear;
+	options.tms = false;
+	options.skip_empty = true;
+	options.threads = CPLGetNumCPUs();
+
+	std::string format = "PNG";
+	std::string scheme = "xyz";
+
+	Local<String> sym = Nan::New("dir").ToLocalChecked();
+	if(!Nan::HasOwnProperty(obj, sym).FromMaybe(false) || !obj->Get(sym)->IsString()){
+		Nan::ThrowTypeError("dir must be a string");
+		return 1;
+	}
+	options.dir = *Nan::Utf8String(obj->Get(sym));
+
+	sym = Nan::New("maxZoom").ToLocalChecked();
+	if(!Nan::HasOwnProperty(obj, sym).FromMaybe(false) || !obj->Get(sym)->IsNumber()){
+		Nan::ThrowTypeError("maxZoom must be a number");
+		return 1;
+	}
+	options.max_zoom = obj->Get(sym)->Int32Value();
+
+	Local<Value> val = obj->Get(Nan::New("minZoom").ToLocalChecked());
+	if(!val->IsUndefined()){
+		if(!val->IsNumber()){
+			Nan::ThrowTypeError("minZoom must be a number");
+			return 1;
+		}
+		options.min_zoom = val->Int32Value();
+	}
+	val = obj->Get(Nan::New("tileSize").ToLocalChecked());
+	if(!val->IsUndefined()){
+		if(!val->IsNumber()){
+			Nan::ThrowTypeError("tileSize must be a number");
+			return 1;
+		}
+		options.tile_size = val->Int32Value();
+	}
+	val = obj->Get(Nan::New("threads").ToLocalChecked());
+	if(!val->IsUndefined()){
+		if(!val->IsNumber()){
+			Nan::ThrowTypeError("threads must be a number");
+			return 1;
+		}
+		options.threads = val->Int32Value();
+	}
+	val = obj->Get(Nan::New("format").ToLocalChecked());
+	if(!val->IsUndefined()){
+		if(!val->IsString()){
+			Nan::ThrowTypeError("format must be a string");
+			return 1;
+		}
+		format = *Nan::Utf8String(val);
+	}
+	val = obj->Get(Nan::New("scheme").ToLocalChecked());
+	if(!val->IsUndefined()){
+		if(!val->IsString()){
+			Nan::ThrowTypeError("scheme must be a string");
+			return 1;
+		}
+		scheme = *Nan::Utf8String(val);
+	}
+	val = obj->Get(Nan::New("skipEmpty").ToLocalChecked());
+	if(!val->IsUndefined()){
+		options.skip_empty = val->BooleanValue();
+	}
+
+	if(options.min_zoom < 0 || options.max_zoom > 24 || options.min_zoom > options.max_zoom){
+		Nan::ThrowRangeError("Zoom levels must satisfy 0 <= minZoom <= maxZoom <= 24");
+		return 1;
+	}
+	if(options.tile_size < 1 || options.tile_size > 4096){
+		Nan::ThrowRangeError("tileSize must be between 1 and 4096");
+		return 1;
+	}
+	if(options.threads < 1){
+		Nan::ThrowRangeError("threads must be greater than 0");
+		return 1;
+	}
+
+	if(format != "PNG" && format != "JPEG"){
+		Nan::ThrowError("format must be 'PNG' or 'JPEG'");
+		return 1;
+	}
+	options.driver = GetGDALDriverManager()->GetDriverByName(format.c_str());
+	if(!options.driver){
+		Nan::ThrowError("Tile format driver is not available");
+		return 1;
+	}
+
+	if(scheme != "xyz" && scheme != "tms"){
+		Nan::ThrowError("scheme must be 'xyz' or 'tms'");
+		return 1;
+	}
+	options.tms = scheme == "tms";
+
+	val = obj->Get(Nan::New("resampling").ToLocalChecked());
+	if(!val->IsUndefined() && !val->IsNull()){
+		WarpOptions warp_options;
+		if(warp_options.parseResamplingAlg(val)){
+			return 1; // error parsing resampling algorithm
+		}
+		options.resampling = warp_options.get()->eResampleAlg;
+	}
+
+	StringList creation_options;
+	if(creation_options.parse(obj->Get(Nan::New("creationOptions").ToLocalChecked()))){
+		return 1; // error parsing string list
+	}
+	for(char **item = creation_options.get(); item && *item; item++){
+		options.creation_options.push_back(*item);
+	}
+
+	return 0;
+}
+
+static Local<Value> tileResult(const TileResult &result)
+{
+	Nan::EscapableHandleScope scope;
+
+	Local<Object> obj = Nan::New<Object>();
+	obj->Set(Nan::New("written").ToLocalChecked(), Nan::New<Number>((double) result.written));
+	obj->Set(Nan::New("skipped").ToLocalChecked(), Nan::New<Number>((double) result.skipped));
+
+	return scope.Escape(obj);
+}
+
+// Renders a tile pyramid for generateTilesAsync() on the libuv threadpool, holding the src dataset lock
+class GenerateTilesWorker : public DatasetProgressWorker {
+public:
+	GenerateTilesWorker(Nan::Callback *callback, Dataset *src, const TileOptions &options)
+		: DatasetProgressWorker(callback, src->uid), raw(src->getDataset()), options(options)
+	{}
+
+protected:
+	void Run()
+	{
+		if(node_gdal::generateTiles(raw, options, result, ProgressFunc, this)) {
+			SetCPLErrorMessage("Error generating tiles");
+		}
+	}
+
+	Local<Value> GetResult()
+	{
+		return tileResult(result);
+	}
+
+private:
+	GDALDataset *raw;
+	TileOptions options;
+	TileResult result;
+};
+
+static void doGenerateTiles(NAN_METHOD_ARGS_TYPE info, bool async)
+{
+	Nan::HandleScope scope;
+
+	Dataset *src;
+	Local<Object> obj;
+	TileOptions options;
+
+	NODE_ARG_WRAPPED(0, "src", Dataset, src);
+	NODE_ARG_OBJECT(1, "options", obj);
+
+	if(!src->getDataset()){
+		Nan::ThrowError("src must be a raster dataset");
+		return;
+	}
+	if(parseTileOptions(obj, options)){
+		return;
+	}
+
+	if(async){
+		Local<Function> progress;
+		Local<Object> cancel_flag;
+		Local<Function> callback;
+
+		NODE_ARG_CALLBACK_OPT(2, "progress", progress);
+		NODE_ARG_CANCEL_TOKEN_OPT(3, "cancel token", cancel_flag);
+		NODE_ARG_CALLBACK(4, "callback", callback);
+
+		GenerateTilesWorker *worker = new GenerateTilesWorker(new Nan::Callback(callback), src, options);
+		if (!progress.IsEmpty()) worker->setProgressCallback(progress);
+		if (!cancel_flag.IsEmpty()) worker->setCancelToken(cancel_flag);
+		worker->SaveToPersistent("src", info[0].As<Object>());
+		worker->queue();
+		return;
+	}
+
+	TileResult result;
+	CPLErr err;
+	{
+		DatasetSyncLock lock(src->uid);
+		err = node_gdal::generateTiles(src->getDataset(), options, result, NULL, NULL);
+	}
+	if(err){
+		NODE_THROW_CPLERR(err);
+		return;
+	}
+
+	info.GetReturnValue().Set(tileResult(result));
+}
+
+/**
+ * Renders a Web Mercator (EPSG:3857) tile pyramid of a dataset to
+ * `dir/{z}/{x}/{y}.png` (or `.jpg`), like gdal2tiles.
+ *
+ * Tiles are rendered in parallel: worker threads take the next tile as soon
+ * as they finish one, warp it from the overview closest to its resolution and
+ * encode it in memory before writing it out. Sources that can't be reopened
+ * by filename (such as MEM datasets) are read by one thread at a time.
+ *
+ * The first band (or the first three, for RGB sources) is used, along with
+ * the alpha band if there is one. PNG tiles are transparent where the source
+ * has no data.
+ *
+ * @example
+ * ```
+ * var result = gdal.generateTiles(ds, {dir: 'tiles', minZoom: 0, maxZoom: 8});
+ * console.log(result.written + ' tiles written');```
+ *
+ * @throws Error
+ * @method generateTiles
+ * @static
+ * @for gdal
+ * @param {gdal.Dataset} src Must have a geotransform and a spatial reference.
+ * @param {Object} options
+ * @param {String} options.dir Output directory, created if needed.
+ * @param {Integer} options.maxZoom
+ * @param {Integer} [options.minZoom=0]
+ * @param {Integer} [options.tileSize=256]
+ * @param {String} [options.format="PNG"] `"PNG"` or `"JPEG"`
+ * @param {String} [options.resampling="Bilinear"] Resampling algorithm ({{#crossLink "Constants (GRA)"}}available options{{/crossLink}})
+ * @param {String} [options.scheme="xyz"] `"xyz"` numbers rows from the top (as web maps do), `"tms"` from the bottom.
+ * @param {string[]|object} [options.creationOptions] Creation options for the tile driver.
+ * @param {Boolean} [options.skipEmpty=true] Don't write tiles the source doesn't cover.
+ * @param {Integer} [options.threads] Defaults to the number of CPUs.
+ * @return {Object} An object with the number of tiles `written` and `skipped`.
+ */
+NAN_METHOD(Warper::generateTiles)
+{
+	doGenerateTiles(info, false);
+}
+
+NAN_METHOD(Warper::generateTilesAsync)
+{
+	doGenerateTiles(info, true);
+}
+
 } //node_gdal namespace
\ No newline at end of file
@@ -30,7 +30,10 @@ namespace Warper {
 	void Initialize(Local<Object> target);
 
 	NAN_METHOD(reprojectImage);
+	NAN_METHOD(reprojectImageAsync);
 	NAN_METHOD(suggestedWarpOutput);
+	NAN_METHOD(generateTiles);
+	NAN_METHOD(generateTilesAsync);
 
 }
 }
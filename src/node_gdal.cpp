@@ -60,6 +60,7 @@
 
 //collections
 #include "collections/dataset_bands.hpp"
+#include "collections/dataset_pixels.hpp"
 #include "collections/dataset_layers.hpp"
 #include "collections/layer_features.hpp"
 #include "collections/feature_fields.hpp"
@@ -221,6 +222,13 @@ namespace node_gdal {
 		{
 
 			Nan::SetMethod(target, "open", open);
+			Nan::SetMethod(target, "openAsync", openAsync);
+			Nan::SetMethod(target, "openPool", openPool);
+			Nan::SetMethod(target, "openCached", openCached);
+			Nan::SetMethod(target, "openBuffer", openBuffer);
+			Nan::SetMethod(target, "getDatasetCacheStats", getDatasetCacheStats);
+			Nan::SetMethod(target, "getBlockCacheStats", getBlockCacheStats);
+			Nan::SetMethod(target, "setBlockCacheMax", setBlockCacheMax);
 			Nan::SetMethod(target, "setConfigOption", setConfigOption);
 			Nan::SetMethod(target, "getConfigOption", getConfigOption);
 			Nan::SetMethod(target, "decToDMS", decToDMS);
@@ -251,6 +259,7 @@ namespace node_gdal {
 			CoordinateTransformation::Initialize(target);
 
 			DatasetBands::Initialize(target);
+			DatasetPixels::Initialize(target);
 			DatasetLayers::Initialize(target);
 			LayerFeatures::Initialize(target);
 			FeatureFields::Initialize(target);
@@ -1139,6 +1148,22 @@ namespace node_gdal {
 			 */
 			target->Set(Nan::New("version").ToLocalChecked(), Nan::New(GDAL_RELEASE_NAME).ToLocalChecked());
 
+			/**
+			 * Whether the binding was built against the bundled GDAL (as opposed
+			 * to a shared GDAL library). Cache statistics are only available with
+			 * the bundled GDAL.
+			 *
+			 * @final
+			 * @for gdal
+			 * @property gdal.bundled
+			 * @type {Boolean}
+			 */
+			#ifdef BUNDLED_GDAL
+			target->Set(Nan::New("bundled").ToLocalChecked(), Nan::True());
+			#else
+			target->Set(Nan::New("bundled").ToLocalChecked(), Nan::False());
+			#endif
+
 			/**
 			 * Details about the last error that occurred. The property
 			 * will be null or an object containing three properties: "number",
@@ -0,0 +1,139 @@
+#include "band_calc.hpp"
+#include "chunk_scan.hpp"
+
+#include <math.h>
+#include <algorithm>
+
+namespace node_gdal {
+
+struct BandCalc : public ChunkScan {
+	const CalcExpression *expression;
+	const std::vector<GDALRasterBand*> *inputs;
+	std::vector<int> has_nodata;
+	std::vector<double> nodata;
+	GDALRasterBand *dst;
+	// value written for nodata pixels, and whether NaN results are replaced
+	// by it (NaN has no integer equivalent)
+	double fill;
+	bool replace_nan;
+
+	int width;
+	int height;
+	int chunk_rows;
+};
+
+static void propagateNodata(BandCalc *calc, const std::vector<const double*> &in, size_t n, double *out)
+{
+	double fill = calc->fill;
+
+	if(calc->replace_nan) {
+		for(size_t i = 0; i < n; i++) {
+			if(out[i] != out[i]) out[i] = fill;
+		}
+	}
+	for(size_t k = 0; k < in.size(); k++) {
+		if(!calc->has_nodata[k]) continue;
+		const double *values = in[k];
+		double nodata = calc->nodata[k];
+		if(nodata != nodata) {
+			for(size_t i = 0; i < n; i++) {
+				if(values[i] != values[i]) out[i] = fill;
+			}
+		} else {
+			for(size_t i = 0; i < n; i++) {
+				if(values[i] == nodata) out[i] = fill;
+			}
+		}
+	}
+}
+
+static void calculateChunks(void *arg)
+{
+	BandCalc *calc = (BandCalc *) arg;
+	const std::vector<GDALRasterBand*> &inputs = *calc->inputs;
+	size_t n_inputs = inputs.size();
+	size_t max_pixels = (size_t) calc->width * calc->chunk_rows;
+
+	// [output | input 1 .. input n | expression stack]
+	std::vector<double> buffer(max_pixels * (1 + n_inputs + calc->expression->stackDepth()));
+	std::vector<const double*> in(n_inputs);
+
+	CPLErrorReset();
+	GIntBig chunk;
+	while(true) {
+		calc->lock();
+		if(!calc->next(chunk)) {
+			calc->unlock();
+			return;
+		}
+		int y = (int) chunk * calc->chunk_rows;
+		int rows = std::min(calc->chunk_rows, calc->height - y);
+		size_t n = (size_t) calc->width * rows;
+		double *out = &buffer[0];
+		bool failed = false;
+
+		for(size_t k = 0; k < n_inputs; k++) {
+			double *data = out + (k + 1) * n;
+			in[k] = data;
+			if(inputs[k]->RasterIO(GF_Read, 0, y, calc->width, rows, data, calc->width, rows, GDT_Float64, 0, 0, NULL)) {
+				calc->failWithLastError();
+				failed = true;
+				break;
+			}
+		}
+		calc->unlock();
+		if(failed) return;
+
+		calc->expression->evaluate(in.empty() ? NULL : &in[0], n, out, out + (1 + n_inputs) * n);
+		propagateNodata(calc, in, n, out);
+
+		calc->lock();
+		if(!calc->failed()) {
+			if(calc->dst->RasterIO(GF_Write, 0, y, calc->width, rows, out, calc->width, rows, GDT_Float64, 0, 0, NULL)) {
+				calc->failWithLastError();
+			} else {
+				calc->done();
+			}
+		}
+		calc->unlock();
+	}
+}
+
+CPLErr calculateBands(const CalcExpression &expression,
+                      const std::vector<GDALRasterBand*> &inputs,
+                      GDALRasterBand *dst, bool dst_has_nodata, double dst_nodata,
+                      int n_threads,
+                      GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	BandCalc calc;
+	calc.expression = &expression;
+	calc.inputs = &inputs;
+	calc.dst = dst;
+	GDALDataType type = dst->GetRasterDataType();
+	bool floating = type == GDT_Float32 || type == GDT_Float64 || type == GDT_CFloat32 || type == GDT_CFloat64;
+	calc.fill = dst_has_nodata ? dst_nodata : (floating ? NAN : 0);
+	calc.replace_nan = dst_has_nodata || !floating;
+	calc.width = dst->GetXSize();
+	calc.height = dst->GetYSize();
+	if(pfnProgress) calc.pfnProgress = pfnProgress;
+	calc.pProgressArg = pProgressArg;
+
+	for(size_t k = 0; k < inputs.size(); k++) {
+		int has_nodata = 0;
+		double nodata = inputs[k]->GetNoDataValue(&has_nodata);
+		calc.has_nodata.push_back(has_nodata);
+		calc.nodata.push_back(nodata);
+	}
+
+	calc.chunk_rows = chunkRows(dst);
+	calc.n_chunks = (calc.height + calc.chunk_rows - 1) / calc.chunk_rows;
+
+	calc.run(calculateChunks, &calc, n_threads);
+	CPLErr err = calc.error();
+	if(err) return err;
+
+	calc.pfnProgress(1.0, NULL, calc.pProgressArg);
+	return CE_None;
+}
+
+}
@@ -0,0 +1,37 @@
+#ifndef __BAND_CALC_H__
+#define __BAND_CALC_H__
+
+// gdal
+#include <gdal_priv.h>
+
+#include <vector>
+
+#include "calc_expression.hpp"
+
+namespace node_gdal {
+
+// Evaluates a compiled expression over the input bands and writes the result
+// to `dst`, one chunk of whole scanlines (at least a row of destination
+// blocks) at a time.
+//
+// Chunks are spread over `n_threads` threads. Every read and write goes
+// through GDAL under a shared mutex, since the bands may belong to the same
+// dataset; decoding the inputs' blocks is therefore serial, but evaluating the
+// expression runs in parallel.
+//
+// A pixel is nodata in the output if it is nodata in any input, or if the
+// expression yields NaN. Nodata pixels are written as `dst_nodata` when
+// `dst_has_nodata` is set, and otherwise as NaN, or 0 in integer bands.
+//
+// Must be called with the locks of every dataset involved held. All bands
+// must have the size of `dst`.
+
+CPLErr calculateBands(const CalcExpression &expression,
+                      const std::vector<GDALRasterBand*> &inputs,
+                      GDALRasterBand *dst, bool dst_has_nodata, double dst_nodata,
+                      int n_threads,
+                      GDALProgressFunc pfnProgress, void *pProgressArg);
+
+}
+
+#endif
@@ -0,0 +1,445 @@
+#include "band_stats.hpp"
+#include "chunk_scan.hpp"
+
+#include <math.h>
+#include <limits>
+#include <algorithm>
+
+namespace node_gdal {
+
+struct Accumulator {
+	GUIntBig count;
+	double min;
+	double max;
+	double sum;
+	double sum_sq;
+	std::vector<GUIntBig> bins;
+
+	Accumulator(size_t n_bins = 0)
+		: count(0), min(INFINITY), max(-INFINITY), sum(0), sum_sq(0), bins(n_bins, 0)
+	{}
+
+	void merge(const Accumulator &other)
+	{
+		count += other.count;
+		min = std::min(min, other.min);
+		max = std::max(max, other.max);
+		sum += other.sum;
+		sum_sq += other.sum_sq;
+		for(size_t i = 0; i < bins.size(); i++) bins[i] += other.bins[i];
+	}
+};
+
+// Maps values to histogram buckets over [min, max]. Out of range values are
+// dropped, or counted in the first / last bucket.
+struct BucketRange {
+	double min;
+	double max;
+	double scale;
+	int n;
+	bool include_out_of_range;
+
+	void set(double range_min, double range_max, int buckets, bool include)
+	{
+		min = range_min;
+		max = range_max;
+		n = buckets;
+		scale = range_max > range_min ? buckets / (range_max - range_min) : 0;
+		include_out_of_range = include;
+	}
+
+	inline int index(double v) const
+	{
+		if(v < min || v > max) {
+			if(!include_out_of_range) return -1;
+			return v < min ? 0 : n - 1;
+		}
+		int i = (int) ((v - min) * scale);
+		return i < n ? i : n - 1;
+	}
+};
+
+struct BandScan : public ChunkScan {
+	GDALRasterBand *band;
+	GDALDataType type;
+	int type_size;
+	int width;
+	int height;
+	int chunk_rows;
+	int n_threads;
+
+	bool has_nodata;
+	double nodata;
+
+	// what the kernels accumulate
+	bool count_values;
+	int value_offset;
+	bool moments;
+	bool bucketize;
+	BucketRange range;
+
+	// guarded by the scan's lock
+	Accumulator total;
+};
+
+// counts every value of an 8 or 16 bit band
+template<typename T>
+static void countValues(const T *data, size_t n, int offset, GUIntBig *bins)
+{
+	for(size_t i = 0; i < n; i++) bins[(int) data[i] + offset]++;
+}
+
+// min / max / sum / sum of squares of integer data without nodata; four
+// independent lanes break the dependency chains of the reductions so they
+// can be vectorized and pipelined
+template<typename T>
+static void accumulateMoments(const T *data, size_t n, Accumulator &acc)
+{
+	double min[4] = {acc.min, acc.min, acc.min, acc.min};
+	double max[4] = {acc.max, acc.max, acc.max, acc.max};
+	double sum[4] = {0, 0, 0, 0};
+	double sum_sq[4] = {0, 0, 0, 0};
+
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		for(int k = 0; k < 4; k++) {
+			double v = data[i + k];
+			min[k] = v < min[k] ? v : min[k];
+			max[k] = v > max[k] ? v : max[k];
+			sum[k] += v;
+			sum_sq[k] += v * v;
+		}
+	}
+	for(; i < n; i++) {
+		double v = data[i];
+		min[0] = v < min[0] ? v : min[0];
+		max[0] = v > max[0] ? v : max[0];
+		sum[0] += v;
+		sum_sq[0] += v * v;
+	}
+
+	for(int k = 0; k < 4; k++) {
+		acc.min = std::min(acc.min, min[k]);
+		acc.max = std::max(acc.max, max[k]);
+		acc.sum += sum[k];
+		acc.sum_sq += sum_sq[k];
+	}
+	acc.count += n;
+}
+
+// general case: skips nodata and NaN, accumulates moments and / or buckets
+template<typename T>
+static void accumulateValues(const BandScan *scan, const T *data, size_t n, Accumulator &acc)
+{
+	bool has_nodata = scan->has_nodata;
+	double nodata = scan->nodata;
+
+	for(size_t i = 0; i < n; i++) {
+		double v = data[i];
+		if(v != v || (has_nodata && v == nodata)) continue;
+		if(scan->moments) {
+			acc.min = v < acc.min ? v : acc.min;
+			acc.max = v > acc.max ? v : acc.max;
+			acc.sum += v;
+			acc.sum_sq += v * v;
+			acc.count++;
+		}
+		if(scan->bucketize) {
+			int b = scan->range.index(v);
+			if(b >= 0) acc.bins[b]++;
+		}
+	}
+}
+
+template<typename T>
+static void accumulate(const BandScan *scan, const void *data, size_t n, Accumulator &acc)
+{
+	const T *values = (const T *) data;
+	if(scan->count_values) {
+		countValues(values, n, scan->value_offset, &acc.bins[0]);
+	} else if(scan->moments && !scan->bucketize && !scan->has_nodata && !std::numeric_limits<T>::has_quiet_NaN) {
+		accumulateMoments(values, n, acc);
+	} else {
+		accumulateValues(scan, values, n, acc);
+	}
+}
+
+static void scanChunks(void *arg)
+{
+	BandScan *scan = (BandScan *) arg;
+	std::vector<GByte> buffer((size_t) scan->width * scan->chunk_rows * scan->type_size);
+	Accumulator acc(scan->total.bins.size());
+
+	CPLErrorReset();
+	GIntBig chunk;
+	while(true) {
+		scan->lock();
+		if(!scan->next(chunk)) {
+			scan->unlock();
+			break;
+		}
+		int y = (int) chunk * scan->chunk_rows;
+		int rows = std::min(scan->chunk_rows, scan->height - y);
+		size_t n = (size_t) scan->width * rows;
+		if(scan->band->RasterIO(GF_Read, 0, y, scan->width, rows, &buffer[0], scan->width, rows, scan->type, 0, 0, NULL)) {
+			scan->failWithLastError();
+			scan->unlock();
+			break;
+		}
+		scan->unlock();
+
+		switch(scan->type) {
+			case GDT_Byte:    accumulate<GByte>(scan, &buffer[0], n, acc); break;
+			case GDT_UInt16:  accumulate<GUInt16>(scan, &buffer[0], n, acc); break;
+			case GDT_Int16:   accumulate<GInt16>(scan, &buffer[0], n, acc); break;
+			case GDT_UInt32:  accumulate<GUInt32>(scan, &buffer[0], n, acc); break;
+			case GDT_Int32:   accumulate<GInt32>(scan, &buffer[0], n, acc); break;
+			case GDT_Float32: accumulate<float>(scan, &buffer[0], n, acc); break;
+			case GDT_Float64: accumulate<double>(scan, &buffer[0], n, acc); break;
+			default: break;
+		}
+
+		scan->lock();
+		scan->done();
+		scan->unlock();
+	}
+
+	scan->lock();
+	scan->total.merge(acc);
+	scan->unlock();
+}
+
+// runs one pass over the band, accumulating into scan->total
+static CPLErr runScan(BandScan *scan)
+{
+	scan->reset();
+	scan->run(scanChunks, scan, scan->n_threads);
+	return scan->error();
+}
+
+// value at (fractional) rank `r` of the sorted pixels, given `value(k)` for
+// integer ranks
+template<typename F>
+static double interpolateRank(double r, F value)
+{
+	GUIntBig lo = (GUIntBig) floor(r);
+	GUIntBig hi = (GUIntBig) ceil(r);
+	double a = value(lo);
+	if(hi == lo) return a;
+	return a + (value(hi) - a) * (r - lo);
+}
+
+static void setMoments(BandStats &stats, const Accumulator &acc)
+{
+	stats.count = acc.count;
+	if(acc.count == 0) {
+		stats.min = stats.max = stats.mean = stats.std_dev = NAN;
+		return;
+	}
+	stats.min = acc.min;
+	stats.max = acc.max;
+	stats.mean = acc.sum / acc.count;
+	stats.std_dev = sqrt(std::max(0.0, acc.sum_sq / acc.count - stats.mean * stats.mean));
+}
+
+// 8 and 16 bit bands: everything follows from the count of each value
+static void summarizeValues(const std::vector<GUIntBig> &bins, int offset, const BandStatsOptions &options, BandStats &stats)
+{
+	Accumulator acc;
+	for(size_t i = 0; i < bins.size(); i++) {
+		if(!bins[i]) continue;
+		double v = (double) i - offset;
+		acc.count += bins[i];
+		acc.min = std::min(acc.min, v);
+		acc.max = std::max(acc.max, v);
+		acc.sum += v * bins[i];
+		acc.sum_sq += v * v * bins[i];
+	}
+	setMoments(stats, acc);
+	if(!options.histogram) return;
+
+	BucketRange range;
+	if(options.has_range) {
+		range.set(options.min, options.max, options.buckets, options.include_out_of_range);
+	} else {
+		range.set(acc.count ? acc.min : 0, acc.count ? acc.max : 0, options.buckets, false);
+	}
+	stats.hist_min = range.min;
+	stats.hist_max = range.max;
+	stats.buckets.assign(options.buckets, 0);
+	for(size_t i = 0; i < bins.size(); i++) {
+		if(!bins[i]) continue;
+		int b = range.index((double) i - offset);
+		if(b >= 0) stats.buckets[b] += bins[i];
+	}
+
+	for(size_t p = 0; p < options.percentiles.size(); p++) {
+		if(acc.count == 0) {
+			stats.percentiles.push_back(NAN);
+			continue;
+		}
+		double r = options.percentiles[p] / 100 * (acc.count - 1);
+		stats.percentiles.push_back(interpolateRank(r, [&](GUIntBig k) {
+			GUIntBig seen = 0;
+			for(size_t i = 0; i < bins.size(); i++) {
+				seen += bins[i];
+				if(seen > k) return (double) i - offset;
+			}
+			return acc.max;
+		}));
+	}
+}
+
+// other types: percentiles are interpolated within the bucket holding each rank
+static void bucketPercentiles(const BandStatsOptions &options, BandStats &stats)
+{
+	GUIntBig total = 0;
+	for(size_t i = 0; i < stats.buckets.size(); i++) total += stats.buckets[i];
+	double width = (stats.hist_max - stats.hist_min) / stats.buckets.size();
+
+	for(size_t p = 0; p < options.percentiles.size(); p++) {
+		if(total == 0) {
+			stats.percentiles.push_back(NAN);
+			continue;
+		}
+		double r = options.percentiles[p] / 100 * (total - 1);
+		stats.percentiles.push_back(interpolateRank(r, [&](GUIntBig k) {
+			GUIntBig seen = 0;
+			for(size_t i = 0; i < stats.buckets.size(); i++) {
+				if(seen + stats.buckets[i] > k) {
+					return stats.hist_min + width * (i + (k - seen + 0.5) / stats.buckets[i]);
+				}
+				seen += stats.buckets[i];
+			}
+			return stats.hist_max;
+		}));
+	}
+}
+
+CPLErr computeBandStats(GDALRasterBand *band, const BandStatsOptions &options, BandStats &stats,
+                        GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	GDALRasterBand *src = band;
+	if(options.approximate) {
+		GDALRasterBand *overview = band->GetRasterSampleOverview(GDALSTAT_APPROX_NUMSAMPLES);
+		if(overview) src = overview;
+	}
+
+	GDALDataType type = src->GetRasterDataType();
+	switch(type) {
+		case GDT_Byte:
+		case GDT_UInt16:
+		case GDT_Int16:
+		case GDT_UInt32:
+		case GDT_Int32:
+		case GDT_Float32:
+		case GDT_Float64:
+			break;
+		default:
+			CPLError(CE_Failure, CPLE_NotSupported, "Unsupported band data type: %s", GDALGetDataTypeName(type));
+			return CE_Failure;
+	}
+
+	BandScan scan;
+	scan.band = src;
+	scan.type = type;
+	scan.type_size = GDALGetDataTypeSize(type) / 8;
+	scan.width = src->GetXSize();
+	scan.height = src->GetYSize();
+	scan.n_threads = options.threads;
+	int has_nodata = 0;
+	// overviews inherit the nodata value of the full resolution band
+	scan.nodata = band->GetNoDataValue(&has_nodata);
+	scan.has_nodata = has_nodata;
+	scan.count_values = false;
+	scan.value_offset = 0;
+	scan.moments = false;
+	scan.bucketize = false;
+	if(pfnProgress) scan.pfnProgress = pfnProgress;
+	scan.pProgressArg = pProgressArg;
+	scan.chunk_rows = chunkRows(src);
+	scan.n_chunks = (scan.height + scan.chunk_rows - 1) / scan.chunk_rows;
+
+	CPLErr err;
+	if(type == GDT_Byte || type == GDT_UInt16 || type == GDT_Int16) {
+		scan.count_values = true;
+		scan.value_offset = type == GDT_Int16 ? 32768 : 0;
+		scan.total = Accumulator(type == GDT_Byte ? 256 : 65536);
+
+		err = runScan(&scan);
+		if(err) return err;
+
+		std::vector<GUIntBig> &bins = scan.total.bins;
+		double nodata_bin = scan.nodata + scan.value_offset;
+		if(scan.has_nodata && nodata_bin == floor(nodata_bin) && nodata_bin >= 0 && nodata_bin < bins.size()) {
+			bins[(size_t) nodata_bin] = 0;
+		}
+		summarizeValues(bins, scan.value_offset, options, stats);
+	} else {
+		scan.moments = true;
+		if(options.histogram && options.has_range) {
+			scan.bucketize = true;
+			scan.range.set(options.min, options.max, options.buckets, options.include_out_of_range);
+			scan.total = Accumulator(options.buckets);
+		} else if(options.histogram) {
+			scan.progress_span = 0.5;
+		}
+
+		err = runScan(&scan);
+		if(err) return err;
+		setMoments(stats, scan.total);
+
+		if(options.histogram && !options.has_range) {
+			// second pass over the range of the data
+			scan.moments = false;
+			scan.bucketize = true;
+			scan.range.set(stats.count ? stats.min : 0, stats.count ? stats.max : 0, options.buckets, false);
+			scan.total = Accumulator(options.buckets);
+			scan.progress_base = 0.5;
+			if(stats.count) {
+				err = runScan(&scan);
+				if(err) return err;
+			}
+		}
+
+		if(options.histogram) {
+			stats.hist_min = scan.range.min;
+			stats.hist_max = scan.range.max;
+			stats.buckets = scan.total.bins;
+			bucketPercentiles(options, stats);
+		}
+	}
+
+	scan.pfnProgress(1.0, NULL, scan.pProgressArg);
+	return CE_None;
+}
+
+CPLErr computeBandStatistics(GDALRasterBand *band, bool approximate, int threads, BandStats &stats,
+                             GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	if(approximate && band->HasArbitraryOverviews()) {
+		// GDAL samples these by reading the band at a reduced resolution
+		stats.count = 0;
+		return band->ComputeStatistics(TRUE, &stats.min, &stats.max, &stats.mean, &stats.std_dev, pfnProgress, pProgressArg);
+	}
+
+	BandStatsOptions options;
+	options.approximate = approximate;
+	options.histogram = false;
+	options.has_range = false;
+	options.min = 0;
+	options.max = 0;
+	options.buckets = 1;
+	options.include_out_of_range = false;
+	options.threads = threads;
+
+	CPLErr err = computeBandStats(band, options, stats, pfnProgress, pProgressArg);
+	if(err) return err;
+	if(stats.count == 0) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Failed to compute statistics, no valid pixels found in sampling.");
+		return CE_Failure;
+	}
+	return band->SetStatistics(stats.min, stats.max, stats.mean, stats.std_dev);
+}
+
+}
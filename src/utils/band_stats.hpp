@@ -0,0 +1,73 @@
+#ifndef __BAND_STATS_H__
+#define __BAND_STATS_H__
+
+// gdal
+#include <gdal_priv.h>
+
+#include <vector>
+
+namespace node_gdal {
+
+struct BandStatsOptions {
+	// read the smallest overview GDAL's own approximate statistics would use
+	bool approximate;
+	// compute the histogram and percentiles, not just the statistics
+	bool histogram;
+	// histogram range; the range of the data when unset
+	bool has_range;
+	double min;
+	double max;
+	int buckets;
+	bool include_out_of_range;
+	// 0 - 100
+	std::vector<double> percentiles;
+	int threads;
+};
+
+struct BandStats {
+	GUIntBig count;
+	double min;
+	double max;
+	double mean;
+	double std_dev;
+
+	// only set when the histogram is computed
+	double hist_min;
+	double hist_max;
+	std::vector<GUIntBig> buckets;
+	std::vector<double> percentiles;
+};
+
+// Computes statistics, a histogram and percentiles of a band, skipping nodata
+// pixels (and NaN).
+//
+// The band is split into chunks of whole block rows that are spread over a
+// CPL worker pool. Reads go through GDAL under a shared mutex; the per-type
+// kernels (plain loops the compiler can vectorize) run in parallel on private
+// accumulators that are merged at the end.
+//
+// 8 and 16 bit bands are scanned once, counting every possible value, which
+// also makes their percentiles exact. Other types take a second pass for the
+// histogram unless its range is given, and their percentiles are interpolated
+// within a histogram bucket.
+//
+// Must be called with the dataset lock held.
+
+CPLErr computeBandStats(GDALRasterBand *band, const BandStatsOptions &options, BandStats &stats,
+                        GDALProgressFunc pfnProgress, void *pProgressArg);
+
+// Computes the statistics of a band with computeBandStats() and stores them
+// on the band like GDALRasterBand::ComputeStatistics() does. Fails when the
+// band has no valid pixels.
+//
+// Bands with arbitrary overviews (e.g. WMS) are left to GDAL when
+// `approximate` is set; `stats.count` isn't set then.
+//
+// Must be called with the dataset lock held.
+
+CPLErr computeBandStatistics(GDALRasterBand *band, bool approximate, int threads, BandStats &stats,
+                             GDALProgressFunc pfnProgress, void *pProgressArg);
+
+}
+
+#endif
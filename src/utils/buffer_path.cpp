@@ -0,0 +1,25 @@
+#include "buffer_path.hpp"
+
+// nan
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+namespace node_gdal {
+
+const char * const BUFFER_PATH_PREFIX = "/vsimem/node_gdal_buffer_";
+
+bool isBufferPath(const std::string &path)
+{
+	return path.find(BUFFER_PATH_PREFIX) != std::string::npos;
+}
+
+bool refuseBufferPath(const std::string &path)
+{
+	if(!isBufferPath(path)) return false;
+	Nan::ThrowError("Files of datasets opened with gdal.openBuffer() can't be opened again");
+	return true;
+}
+
+}
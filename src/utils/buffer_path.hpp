@@ -0,0 +1,21 @@
+#ifndef __BUFFER_PATH_H__
+#define __BUFFER_PATH_H__
+
+#include <string>
+
+namespace node_gdal {
+
+// Datasets opened with gdal.openBuffer() read a /vsimem file pointing into a
+// Buffer that only that dataset keeps alive: no other handle may open it,
+// whether through gdal.open(), a driver or a mosaic.
+extern const char * const BUFFER_PATH_PREFIX;
+
+// whether `path` is, or goes through, one of those files (e.g. /vsizip/...)
+bool isBufferPath(const std::string &path);
+
+// throws and returns true if `path` is one of those files
+bool refuseBufferPath(const std::string &path);
+
+}
+
+#endif
@@ -0,0 +1,393 @@
+#include "calc_expression.hpp"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+namespace node_gdal {
+
+// Recursive descent parser emitting the program in postfix order.
+//
+//   or      := and ('||' and)*
+//   and     := compare ('&&' compare)*
+//   compare := sum (('<' | '<=' | '>' | '>=' | '==' | '!=') sum)?
+//   sum     := product (('+' | '-') product)*
+//   product := unary (('*' | '/' | '%') unary)*
+//   unary   := ('-' | '+' | '!') unary | power
+//   power   := primary ('^' unary)?
+//   primary := number | name | function '(' or (',' or)* ')' | '(' or ')'
+
+class CalcExpression::Parser {
+public:
+	Parser(const std::string &source, const std::vector<std::string> &names, std::vector<Op> &program)
+		: source(source), names(names), program(program), pos(0)
+	{}
+
+	bool parse(std::string &err)
+	{
+		if(!parseOr()) {
+			err = error;
+			return false;
+		}
+		skipSpace();
+		if(pos < source.size()) {
+			err = "Unexpected '" + source.substr(pos, 1) + "' at position " + position();
+			return false;
+		}
+		return true;
+	}
+
+private:
+	const std::string &source;
+	const std::vector<std::string> &names;
+	std::vector<Op> &program;
+	size_t pos;
+	std::string error;
+
+	std::string position()
+	{
+		char str[32];
+		snprintf(str, sizeof(str), "%d", (int) pos);
+		return str;
+	}
+
+	bool fail(const std::string &message)
+	{
+		if(error.empty()) error = message + " at position " + position();
+		return false;
+	}
+
+	void emit(OpCode code, int var = 0, double value = 0)
+	{
+		Op op;
+		op.code = code;
+		op.var = var;
+		op.value = value;
+		program.push_back(op);
+	}
+
+	void skipSpace()
+	{
+		while(pos < source.size() && isspace((unsigned char) source[pos])) pos++;
+	}
+
+	// consumes `token` if it is next in the input
+	bool accept(const char *token)
+	{
+		skipSpace();
+		size_t len = strlen(token);
+		if(source.compare(pos, len, token) != 0) return false;
+		// don't mistake "<=" for "<", or "&&" for "&"
+		if(len == 1 && pos + 1 < source.size() && source[pos + 1] == '=' && strchr("<>=!", token[0])) return false;
+		pos += len;
+		return true;
+	}
+
+	bool parseOr()
+	{
+		if(!parseAnd()) return false;
+		while(accept("||")) {
+			if(!parseAnd()) return false;
+			emit(OP_OR);
+		}
+		return true;
+	}
+
+	bool parseAnd()
+	{
+		if(!parseCompare()) return false;
+		while(accept("&&")) {
+			if(!parseCompare()) return false;
+			emit(OP_AND);
+		}
+		return true;
+	}
+
+	bool parseCompare()
+	{
+		if(!parseSum()) return false;
+
+		OpCode code;
+		if(accept("<=")) code = OP_LE;
+		else if(accept(">=")) code = OP_GE;
+		else if(accept("==")) code = OP_EQ;
+		else if(accept("!=")) code = OP_NE;
+		else if(accept("<")) code = OP_LT;
+		else if(accept(">")) code = OP_GT;
+		else return true;
+
+		if(!parseSum()) return false;
+		emit(code);
+		return true;
+	}
+
+	bool parseSum()
+	{
+		if(!parseProduct()) return false;
+		while(true) {
+			OpCode code;
+			if(accept("+")) code = OP_ADD;
+			else if(accept("-")) code = OP_SUB;
+			else return true;
+			if(!parseProduct()) return false;
+			emit(code);
+		}
+	}
+
+	bool parseProduct()
+	{
+		if(!parseUnary()) return false;
+		while(true) {
+			OpCode code;
+			if(accept("*")) code = OP_MUL;
+			else if(accept("/")) code = OP_DIV;
+			else if(accept("%")) code = OP_MOD;
+			else return true;
+			if(!parseUnary()) return false;
+			emit(code);
+		}
+	}
+
+	bool parseUnary()
+	{
+		if(accept("-")) {
+			if(!parseUnary()) return false;
+			emit(OP_NEG);
+			return true;
+		}
+		if(accept("+")) return parseUnary();
+		if(accept("!")) {
+			if(!parseUnary()) return false;
+			emit(OP_NOT);
+			return true;
+		}
+		return parsePower();
+	}
+
+	bool parsePower()
+	{
+		if(!parsePrimary()) return false;
+		if(accept("^")) {
+			// right associative, and binds tighter than unary minus on its left: -2^2 == -4
+			if(!parseUnary()) return false;
+			emit(OP_POW);
+		}
+		return true;
+	}
+
+	bool parsePrimary()
+	{
+		skipSpace();
+		if(pos >= source.size()) return fail("Unexpected end of expression");
+
+		char c = source[pos];
+		if(isdigit((unsigned char) c) || c == '.') {
+			const char *start = source.c_str() + pos;
+			char *end;
+			double value = strtod(start, &end);
+			if(end == start) return fail("Invalid number");
+			pos += end - start;
+			emit(OP_CONST, 0, value);
+			return true;
+		}
+		if(isalpha((unsigned char) c) || c == '_') {
+			size_t start = pos;
+			while(pos < source.size() && (isalnum((unsigned char) source[pos]) || source[pos] == '_')) pos++;
+			std::string name = source.substr(start, pos - start);
+			if(accept("(")) return parseCall(name, start);
+
+			std::vector<std::string>::const_iterator it = std::find(names.begin(), names.end(), name);
+			if(it == names.end()) {
+				pos = start;
+				return fail("Unknown input '" + name + "'");
+			}
+			emit(OP_VAR, it - names.begin());
+			return true;
+		}
+		if(accept("(")) {
+			if(!parseOr()) return false;
+			if(!accept(")")) return fail("Expected ')'");
+			return true;
+		}
+		return fail("Unexpected '" + source.substr(pos, 1) + "'");
+	}
+
+	bool parseCall(const std::string &name, size_t start)
+	{
+		static const struct {
+			const char *name;
+			int argc;
+			OpCode code;
+		} functions[] = {
+			{"abs", 1, OP_ABS}, {"sqrt", 1, OP_SQRT}, {"exp", 1, OP_EXP}, {"log", 1, OP_LOG},
+			{"log10", 1, OP_LOG10}, {"floor", 1, OP_FLOOR}, {"ceil", 1, OP_CEIL}, {"round", 1, OP_ROUND},
+			{"isnan", 1, OP_ISNAN}, {"sin", 1, OP_SIN}, {"cos", 1, OP_COS}, {"tan", 1, OP_TAN},
+			{"min", 2, OP_MIN}, {"max", 2, OP_MAX}, {"pow", 2, OP_POW}, {"atan2", 2, OP_ATAN2},
+			{"where", 3, OP_WHERE}
+		};
+
+		int argc = 0;
+		if(!accept(")")) {
+			do {
+				if(!parseOr()) return false;
+				argc++;
+			} while(accept(","));
+			if(!accept(")")) return fail("Expected ')'");
+		}
+
+		for(size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+			if(name != functions[i].name) continue;
+			if(argc != functions[i].argc) {
+				pos = start;
+				char str[16];
+				snprintf(str, sizeof(str), "%d", functions[i].argc);
+				return fail(name + "() takes " + str + " argument(s)");
+			}
+			emit(functions[i].code);
+			return true;
+		}
+
+		pos = start;
+		return fail("Unknown function '" + name + "'");
+	}
+};
+
+CalcExpression::CalcExpression()
+	: program(), depth(0)
+{}
+
+bool CalcExpression::compile(const std::string &source, const std::vector<std::string> &names, std::string &error)
+{
+	program.clear();
+	depth = 0;
+
+	Parser parser(source, names, program);
+	if(!parser.parse(error)) {
+		program.clear();
+		return false;
+	}
+
+	int top = 0;
+	for(size_t i = 0; i < program.size(); i++) {
+		switch(program[i].code) {
+			case OP_CONST:
+			case OP_VAR:
+				top++;
+				break;
+			case OP_NEG: case OP_NOT: case OP_ABS: case OP_SQRT: case OP_EXP: case OP_LOG:
+			case OP_LOG10: case OP_FLOOR: case OP_CEIL: case OP_ROUND: case OP_ISNAN:
+			case OP_SIN: case OP_COS: case OP_TAN:
+				break;
+			case OP_WHERE:
+				top -= 2;
+				break;
+			default:
+				top--;
+				break;
+		}
+		depth = std::max(depth, top);
+	}
+	return true;
+}
+
+int CalcExpression::stackDepth() const
+{
+	return depth;
+}
+
+template<class F>
+static inline void apply(const double *a, double *r, size_t n, F f)
+{
+	for(size_t i = 0; i < n; i++) r[i] = f(a[i]);
+}
+
+template<class F>
+static inline void apply(const double *a, const double *b, double *r, size_t n, F f)
+{
+	for(size_t i = 0; i < n; i++) r[i] = f(a[i], b[i]);
+}
+
+// Stack slots point either at an input array (variables are never copied) or
+// at their own row of the scratch buffer, which is where results are written.
+void CalcExpression::evaluate(const double * const *inputs, size_t n, double *out, double *scratch) const
+{
+	std::vector<const double*> slots(depth);
+	int top = 0;
+
+	for(size_t k = 0; k < program.size(); k++) {
+		const Op &op = program[k];
+
+		if(op.code == OP_CONST) {
+			double *r = scratch + top * n;
+			std::fill(r, r + n, op.value);
+			slots[top++] = r;
+			continue;
+		}
+		if(op.code == OP_VAR) {
+			slots[top++] = inputs[op.var];
+			continue;
+		}
+		if(op.code == OP_WHERE) {
+			const double *c = slots[top - 3], *a = slots[top - 2], *b = slots[top - 1];
+			double *r = scratch + (top - 3) * n;
+			for(size_t i = 0; i < n; i++) r[i] = c[i] != 0 ? a[i] : b[i];
+			slots[top - 3] = r;
+			top -= 2;
+			continue;
+		}
+
+		const double *a = slots[top - 1];
+		double *r = scratch + (top - 1) * n;
+		switch(op.code) {
+			case OP_NEG:   apply(a, r, n, [](double x) { return -x; }); break;
+			case OP_NOT:   apply(a, r, n, [](double x) { return x == 0 ? 1.0 : 0.0; }); break;
+			case OP_ABS:   apply(a, r, n, [](double x) { return fabs(x); }); break;
+			case OP_SQRT:  apply(a, r, n, [](double x) { return sqrt(x); }); break;
+			case OP_EXP:   apply(a, r, n, [](double x) { return exp(x); }); break;
+			case OP_LOG:   apply(a, r, n, [](double x) { return log(x); }); break;
+			case OP_LOG10: apply(a, r, n, [](double x) { return log10(x); }); break;
+			case OP_FLOOR: apply(a, r, n, [](double x) { return floor(x); }); break;
+			case OP_CEIL:  apply(a, r, n, [](double x) { return ceil(x); }); break;
+			case OP_ROUND: apply(a, r, n, [](double x) { return floor(x + 0.5); }); break;
+			case OP_ISNAN: apply(a, r, n, [](double x) { return x != x ? 1.0 : 0.0; }); break;
+			case OP_SIN:   apply(a, r, n, [](double x) { return sin(x); }); break;
+			case OP_COS:   apply(a, r, n, [](double x) { return cos(x); }); break;
+			case OP_TAN:   apply(a, r, n, [](double x) { return tan(x); }); break;
+			default: {
+				const double *b = a;
+				a = slots[top - 2];
+				r = scratch + (top - 2) * n;
+				switch(op.code) {
+					case OP_ADD:   apply(a, b, r, n, [](double x, double y) { return x + y; }); break;
+					case OP_SUB:   apply(a, b, r, n, [](double x, double y) { return x - y; }); break;
+					case OP_MUL:   apply(a, b, r, n, [](double x, double y) { return x * y; }); break;
+					case OP_DIV:   apply(a, b, r, n, [](double x, double y) { return x / y; }); break;
+					case OP_MOD:   apply(a, b, r, n, [](double x, double y) { return fmod(x, y); }); break;
+					case OP_POW:   apply(a, b, r, n, [](double x, double y) { return pow(x, y); }); break;
+					case OP_MIN:   apply(a, b, r, n, [](double x, double y) { return y < x ? y : x; }); break;
+					case OP_MAX:   apply(a, b, r, n, [](double x, double y) { return y > x ? y : x; }); break;
+					case OP_ATAN2: apply(a, b, r, n, [](double x, double y) { return atan2(x, y); }); break;
+					case OP_LT:    apply(a, b, r, n, [](double x, double y) { return x < y ? 1.0 : 0.0; }); break;
+					case OP_LE:    apply(a, b, r, n, [](double x, double y) { return x <= y ? 1.0 : 0.0; }); break;
+					case OP_GT:    apply(a, b, r, n, [](double x, double y) { return x > y ? 1.0 : 0.0; }); break;
+					case OP_GE:    apply(a, b, r, n, [](double x, double y) { return x >= y ? 1.0 : 0.0; }); break;
+					case OP_EQ:    apply(a, b, r, n, [](double x, double y) { return x == y ? 1.0 : 0.0; }); break;
+					case OP_NE:    apply(a, b, r, n, [](double x, double y) { return x != y ? 1.0 : 0.0; }); break;
+					case OP_AND:   apply(a, b, r, n, [](double x, double y) { return x != 0 && y != 0 ? 1.0 : 0.0; }); break;
+					case OP_OR:    apply(a, b, r, n, [](double x, double y) { return x != 0 || y != 0 ? 1.0 : 0.0; }); break;
+					default: break;
+				}
+				slots[top - 2] = r;
+				top--;
+				continue;
+			}
+		}
+		slots[top - 1] = r;
+	}
+
+	if(top == 1 && slots[0] != out) memcpy(out, slots[0], n * sizeof(double));
+}
+
+}
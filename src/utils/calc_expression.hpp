@@ -0,0 +1,56 @@
+#ifndef __NODE_GDAL_CALC_EXPRESSION_H__
+#define __NODE_GDAL_CALC_EXPRESSION_H__
+
+#include <string>
+#include <vector>
+
+namespace node_gdal {
+
+// An arithmetic expression over named variables, e.g. "(b4 - b3) / (b4 + b3)".
+//
+// The expression is parsed once into a stack program. Each instruction of the
+// program is then applied to a whole array of pixels at a time, so evaluating
+// a chunk costs one tight loop per operator rather than one tree walk per
+// pixel. Comparisons and logical operators yield 1 or 0.
+//
+// A compiled expression is immutable and can be evaluated from several
+// threads at once, each with its own scratch buffer.
+
+class CalcExpression {
+public:
+	CalcExpression();
+
+	// returns false and fills `error` if the expression is invalid or refers to
+	// a name that isn't in `names`
+	bool compile(const std::string &source, const std::vector<std::string> &names, std::string &error);
+
+	// number of doubles of scratch space evaluate() needs per pixel
+	int stackDepth() const;
+
+	// inputs[i] holds the `n` values of names[i]; writes `n` results to `out`
+	void evaluate(const double * const *inputs, size_t n, double *out, double *scratch) const;
+
+private:
+	enum OpCode {
+		OP_CONST, OP_VAR,
+		OP_NEG, OP_NOT, OP_ABS, OP_SQRT, OP_EXP, OP_LOG, OP_LOG10, OP_FLOOR, OP_CEIL, OP_ROUND,
+		OP_ISNAN, OP_SIN, OP_COS, OP_TAN,
+		OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_POW, OP_MIN, OP_MAX, OP_ATAN2,
+		OP_LT, OP_LE, OP_GT, OP_GE, OP_EQ, OP_NE, OP_AND, OP_OR,
+		OP_WHERE
+	};
+	struct Op {
+		OpCode code;
+		int var;
+		double value;
+	};
+
+	class Parser;
+
+	std::vector<Op> program;
+	int depth;
+};
+
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "chunk_scan.hpp"
+
+// gdal
+#include <cpl_worker_thread_pool.h>
+
+#include <algorithm>
+
+namespace node_gdal {
+
+static const GIntBig MIN_CHUNK_PIXELS = 65536;
+
+void lockMutex(CPLMutex *mutex)
+{
+	while(!CPLAcquireMutex(mutex, 1000.0)) {}
+}
+
+int chunkRows(GDALRasterBand *band)
+{
+	int block_x, block_y;
+	band->GetBlockSize(&block_x, &block_y);
+	GIntBig row_pixels = (GIntBig) band->GetXSize() * block_y;
+	int blocks_per_chunk = (int) std::max((GIntBig) 1, MIN_CHUNK_PIXELS / std::max((GIntBig) 1, row_pixels));
+	return (int) std::max((GIntBig) 1, std::min((GIntBig) band->GetYSize(), (GIntBig) block_y * blocks_per_chunk));
+}
+
+void runJobs(CPLThreadFunc job, const std::vector<void*> &args, int n_threads)
+{
+	n_threads = std::min(n_threads, (int) args.size());
+	CPLWorkerThreadPool pool;
+	if(n_threads > 1 && pool.Setup(n_threads, NULL, NULL)) {
+		pool.SubmitJobs(job, args);
+		pool.WaitCompletion();
+		return;
+	}
+	for(size_t i = 0; i < args.size(); i++) {
+		job(args[i]);
+	}
+}
+
+ChunkScan::ChunkScan()
+	: n_chunks(0), pfnProgress(GDALDummyProgress), pProgressArg(NULL), progress_base(0), progress_span(1),
+	  mutex(CPLCreateMutex()), next_chunk(0), done_chunks(0), err(CE_None), err_no(CPLE_None)
+{
+	// created locked
+	CPLReleaseMutex(mutex);
+}
+
+ChunkScan::~ChunkScan()
+{
+	CPLDestroyMutex(mutex);
+}
+
+void ChunkScan::lock()
+{
+	lockMutex(mutex);
+}
+
+void ChunkScan::unlock()
+{
+	CPLReleaseMutex(mutex);
+}
+
+bool ChunkScan::next(GIntBig &chunk)
+{
+	if(err || next_chunk >= n_chunks) return false;
+	chunk = next_chunk++;
+	return true;
+}
+
+void ChunkScan::done()
+{
+	double complete = progress_base + progress_span * ++done_chunks / n_chunks;
+	if(!err && !pfnProgress(complete, NULL, pProgressArg)) {
+		fail(CPLE_UserInterrupt, "User terminated");
+	}
+}
+
+void ChunkScan::fail(int err_no, const char *msg)
+{
+	if(err) return;
+	err = CE_Failure;
+	this->err_no = err_no;
+	error_msg = msg;
+}
+
+void ChunkScan::failWithLastError()
+{
+	fail(CPLGetLastErrorNo(), CPLGetLastErrorMsg());
+}
+
+void ChunkScan::reset()
+{
+	next_chunk = 0;
+	done_chunks = 0;
+}
+
+void ChunkScan::run(CPLThreadFunc worker, void *arg, int n_threads)
+{
+	n_threads = (int) std::max((GIntBig) 1, std::min((GIntBig) n_threads, n_chunks));
+	runJobs(worker, std::vector<void*>(n_threads, arg), n_threads);
+}
+
+CPLErr ChunkScan::error()
+{
+	if(err) CPLError(err, err_no, "%s", error_msg.c_str());
+	return err;
+}
+
+}
@@ -0,0 +1,80 @@
+#ifndef __CHUNK_SCAN_H__
+#define __CHUNK_SCAN_H__
+
+// gdal
+#include <gdal_priv.h>
+#include <cpl_multiproc.h>
+
+#include <string>
+#include <vector>
+
+namespace node_gdal {
+
+// Acquires `mutex`, however long it takes: CPLAcquireMutex() gives up after
+// its timeout, while every holder here only keeps it for a block or a chunk.
+void lockMutex(CPLMutex *mutex);
+
+// Rows per chunk when scanning `band` in chunks of whole block rows. Chunks
+// are grown to at least 65536 pixels, so small blocks don't turn into one
+// mutex round trip per block.
+int chunkRows(GDALRasterBand *band);
+
+// Runs `job` for every argument on up to `n_threads` threads of a CPL worker
+// pool, or one after the other on the calling thread when a single thread
+// will do or the pool can't be set up.
+void runJobs(CPLThreadFunc job, const std::vector<void*> &args, int n_threads);
+
+// The state shared by the threads working on a job split into `n_chunks`
+// chunks (block rows, tiles, files...), which they take one at a time until
+// none is left: the mutex, the chunk counters, progress and the first error.
+//
+// Methods marked "locked" must be called between lock() and unlock().
+
+class ChunkScan {
+public:
+	ChunkScan();
+	~ChunkScan();
+
+	void lock();
+	void unlock();
+
+	// locked: takes the next chunk; false once all are taken or after an error
+	bool next(GIntBig &chunk);
+	// locked: counts a finished chunk and reports progress, failing if cancelled
+	void done();
+	// locked: records the first error
+	void fail(int err_no, const char *msg);
+	// locked: records the calling thread's last CPL error; error state is
+	// thread-local, so it is kept for the thread that started the scan
+	void failWithLastError();
+	bool failed() const { return err != CE_None; }
+
+	// resets the counters before another pass over the chunks
+	void reset();
+	// runs `worker(arg)` on up to `n_threads` threads, at most one per chunk
+	void run(CPLThreadFunc worker, void *arg, int n_threads);
+	// on the calling thread: raises the first error, if any, and returns it
+	CPLErr error();
+
+	GIntBig n_chunks;
+	GDALProgressFunc pfnProgress;
+	void *pProgressArg;
+	// done() reports progress in [progress_base, progress_base + progress_span]
+	double progress_base;
+	double progress_span;
+
+private:
+	ChunkScan(const ChunkScan &);
+	ChunkScan& operator=(const ChunkScan &);
+
+	CPLMutex *mutex;
+	GIntBig next_chunk;
+	GIntBig done_chunks;
+	CPLErr err;
+	int err_no;
+	std::string error_msg;
+};
+
+}
+
+#endif
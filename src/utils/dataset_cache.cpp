@@ -0,0 +1,40 @@
+#include "dataset_cache.hpp"
+
+namespace node_gdal {
+
+CachedDataset::CachedDataset(const char *path)
+	: GDALProxyPoolDataset(path, 0, 0, GA_ReadOnly, FALSE)
+{}
+
+CachedDataset* CachedDataset::Open(const char *path)
+{
+	CachedDataset *ds = new CachedDataset(path);
+	if(!ds->init()) {
+		delete ds;
+		return NULL;
+	}
+	return ds;
+}
+
+bool CachedDataset::init()
+{
+	// the header is read through the pool, so this open is reused by later accesses
+	GDALDataset *ds = RefUnderlyingDataset();
+	if(!ds) return false;
+
+	nRasterXSize = ds->GetRasterXSize();
+	nRasterYSize = ds->GetRasterYSize();
+	poDriver = ds->GetDriver();
+
+	for(int i = 1; i <= ds->GetRasterCount(); i++) {
+		GDALRasterBand *band = ds->GetRasterBand(i);
+		int block_x, block_y;
+		band->GetBlockSize(&block_x, &block_y);
+		AddSrcBandDescription(band->GetRasterDataType(), block_x, block_y);
+	}
+
+	UnrefUnderlyingDataset(ds);
+	return true;
+}
+
+}
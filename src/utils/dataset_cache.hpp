@@ -0,0 +1,26 @@
+#ifndef __NODE_GDAL_DATASET_CACHE_H__
+#define __NODE_GDAL_DATASET_CACHE_H__
+
+// gdal
+#include <gdal_priv.h>
+#include <gdal_proxy.h>
+
+namespace node_gdal {
+
+// A read-only dataset whose underlying handle lives in GDAL's shared dataset
+// pool (GDAL_MAX_DATASET_POOL_SIZE handles at most, least recently used are
+// closed first). Evicted handles are reopened transparently on next access.
+
+class CachedDataset : public GDALProxyPoolDataset {
+public:
+	// returns NULL (with the CPL error set) if the file can't be opened
+	static CachedDataset* Open(const char *path);
+
+private:
+	CachedDataset(const char *path);
+	bool init();
+};
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+#include "dataset_pool.hpp"
+
+namespace node_gdal {
+
+DatasetPool::DatasetPool(GDALDataset *primary, const char *path, int size)
+	: waiting(), primary(primary), path(path), handles(size, (GDALDataset*) NULL), busy(size, false), next(0)
+{}
+
+DatasetPool::~DatasetPool()
+{
+	// the primary handle belongs to the PtrManager
+	for(size_t i = 0; i < handles.size(); i++) {
+		if(handles[i]) GDALClose(handles[i]);
+	}
+}
+
+int DatasetPool::size()
+{
+	return (int) handles.size();
+}
+
+bool DatasetPool::contains(GDALRasterBand *band)
+{
+	// overviews and mask bands aren't numbered, so they stay on the primary handle
+	return band->GetDataset() == primary && band->GetBand() > 0
+		&& primary->GetRasterBand(band->GetBand()) == band;
+}
+
+int DatasetPool::acquire()
+{
+	// round-robin, so the block caches of all handles stay warm
+	int n = (int) handles.size();
+	for(int i = 0; i < n; i++) {
+		int j = (next + i) % n;
+		if(!busy[j]) {
+			busy[j] = true;
+			next = j + 1;
+			return j;
+		}
+	}
+	return -1;
+}
+
+void DatasetPool::release(int i)
+{
+	busy[i] = false;
+}
+
+GDALRasterBand* DatasetPool::getBand(int i, int band_id)
+{
+	if(!handles[i]) {
+		#if GDAL_VERSION_MAJOR < 2
+		GDALDataset *ds = (GDALDataset*) GDALOpen(path.c_str(), GA_ReadOnly);
+		#else
+		GDALDataset *ds = (GDALDataset*) GDALOpenEx(path.c_str(), GDAL_OF_RASTER | GDAL_OF_READONLY, NULL, NULL, NULL);
+		#endif
+		if(!ds) return NULL;
+		// the file may have been replaced since the primary handle was opened
+		if(ds->GetRasterCount() != primary->GetRasterCount()) {
+			GDALClose(ds);
+			CPLError(CE_Failure, CPLE_AppDefined, "Pooled handles of '%s' differ", path.c_str());
+			return NULL;
+		}
+		handles[i] = ds;
+	}
+	return handles[i]->GetRasterBand(band_id);
+}
+
+}
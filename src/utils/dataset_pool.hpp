@@ -0,0 +1,56 @@
+#ifndef __NODE_GDAL_DATASET_POOL_H__
+#define __NODE_GDAL_DATASET_POOL_H__
+
+// gdal
+#include <gdal_priv.h>
+
+#include <list>
+#include <string>
+#include <vector>
+
+namespace node_gdal {
+
+class DatasetJob;
+
+// Extra read-only handles to the file behind a dataset opened with gdal.openPool().
+//
+// A GDALDataset can only be used by one thread at a time, so async reads on a
+// pooled dataset are dispatched to whichever replica is free. The dataset
+// registered in the PtrManager is not part of the pool: it keeps serving
+// synchronous calls and other jobs. Replicas are handed out on the main thread
+// by the PtrManager, and jobs wait in `waiting` (not on a threadpool thread)
+// while all of them are busy. Replicas are opened on first use by the job that
+// reserved them, on the threadpool. The pool is owned by the PtrManager item
+// and destroyed right before the dataset is closed.
+
+class DatasetPool {
+public:
+	DatasetPool(GDALDataset *primary, const char *path, int size);
+	~DatasetPool();
+
+	int size();
+	// main thread: true if reads of the band can be dispatched to any handle
+	bool contains(GDALRasterBand *band);
+
+	// main thread: reserves a free handle, returns -1 if all of them are busy
+	int acquire();
+	void release(int i);
+	// worker thread, with handle `i` reserved: the band with the same index on
+	// the handle, opening it if needed. Returns NULL with a CPL error set if the
+	// file can't be opened again.
+	GDALRasterBand* getBand(int i, int band_id);
+
+	// jobs waiting for a free handle, in order (main thread only)
+	std::list<DatasetJob*> waiting;
+
+private:
+	GDALDataset *primary;
+	std::string path;
+	std::vector<GDALDataset*> handles;
+	std::vector<bool> busy;
+	unsigned int next;
+};
+
+}
+
+#endif
@@ -0,0 +1,289 @@
+#include "dataset_worker.hpp"
+#include "../gdal_common.hpp"
+
+namespace node_gdal {
+
+DatasetJob::DatasetJob()
+	: handle(-1), items(), missing(false), worker(NULL), pool(NULL), state(IDLE)
+{}
+
+DatasetJob::~DatasetJob()
+{
+	finish();
+
+	std::map<long, PtrManagerDatasetItem*>::iterator it;
+	for(it = items.begin(); it != items.end(); ++it) {
+		ptr_manager.release(it->first);
+	}
+}
+
+void DatasetJob::add(long uid)
+{
+	long ds_uid = ptr_manager.getDatasetUid(uid);
+	if(items.count(ds_uid)) return;
+
+	PtrManagerDatasetItem *item = ptr_manager.retain(ds_uid);
+	if(!item) {
+		missing = true;
+		return;
+	}
+	items[ds_uid] = item;
+}
+
+void DatasetJob::setPool(DatasetPool *pool)
+{
+	this->pool = pool;
+}
+
+void DatasetJob::queue(Nan::AsyncWorker *worker)
+{
+	this->worker = worker;
+	ptr_manager.queueJob(this);
+}
+
+void DatasetJob::finish()
+{
+	if(state == QUEUED || state == STARTED) ptr_manager.finishJob(this);
+}
+
+bool DatasetJob::begin()
+{
+	return !missing;
+}
+
+void DatasetJob::end()
+{
+	if(pool) return;
+
+	std::map<long, PtrManagerDatasetItem*>::iterator it;
+	for(it = items.begin(); it != items.end(); ++it) {
+		uv_mutex_lock(&it->second->async_lock);
+		it->second->running = false;
+		uv_cond_broadcast(&it->second->async_idle);
+		uv_mutex_unlock(&it->second->async_lock);
+	}
+}
+
+DatasetSyncLock::DatasetSyncLock()
+	: items()
+{}
+
+DatasetSyncLock::DatasetSyncLock(long uid)
+	: items()
+{
+	add(uid);
+}
+
+DatasetSyncLock::~DatasetSyncLock()
+{
+	for(size_t i = 0; i < items.size(); i++) {
+		ptr_manager.unlockSync(items[i]);
+	}
+}
+
+void DatasetSyncLock::add(long uid)
+{
+	PtrManagerDatasetItem *item = ptr_manager.lockSync(uid);
+	if(item) items.push_back(item);
+}
+
+// CPL error state is thread-local, so it must be captured on the worker thread
+static const char* getCPLErrorMessage(const char *fallback)
+{
+	const char *msg = CPLGetLastErrorMsg();
+	if((!msg || !msg[0]) && fallback) return fallback;
+	return msg;
+}
+
+DatasetWorker::DatasetWorker(Nan::Callback *callback, long uid)
+	: Nan::AsyncWorker(callback), job()
+{
+	if(uid) job.add(uid);
+}
+
+DatasetWorker::~DatasetWorker()
+{}
+
+void DatasetWorker::addDataset(long uid)
+{
+	job.add(uid);
+}
+
+void DatasetWorker::setPool(DatasetPool *pool)
+{
+	job.setPool(pool);
+}
+
+void DatasetWorker::queue()
+{
+	job.queue(this);
+}
+
+void DatasetWorker::Execute()
+{
+	if(!job.begin()) {
+		SetErrorMessage("Dataset object has already been destroyed");
+		return;
+	}
+
+	CPLErrorReset();
+	Run();
+	job.end();
+}
+
+void DatasetWorker::WorkComplete()
+{
+	// the next job on the datasets can start while this one's callback runs
+	job.finish();
+	Nan::AsyncWorker::WorkComplete();
+}
+
+int DatasetWorker::poolHandle()
+{
+	return job.handle;
+}
+
+Local<Value> DatasetWorker::GetResult()
+{
+	return Nan::Undefined();
+}
+
+void DatasetWorker::HandleOKCallback()
+{
+	Nan::HandleScope scope;
+
+	Local<Value> argv[] = { Nan::Null(), GetResult() };
+	callback->Call(2, argv, async_resource);
+}
+
+void DatasetWorker::SetCPLErrorMessage(const char *fallback)
+{
+	SetErrorMessage(getCPLErrorMessage(fallback));
+}
+
+DatasetProgressWorker::DatasetProgressWorker(Nan::Callback *callback, long uid)
+	: Nan::AsyncProgressWorkerBase<double>(callback), job(), progress_callback(NULL),
+	  cancel_flag(NULL), execution_progress(NULL), last_progress(-1), reported_progress(-1), completed(false)
+{
+	if(uid) job.add(uid);
+}
+
+DatasetProgressWorker::~DatasetProgressWorker()
+{
+	if(progress_callback) delete progress_callback;
+}
+
+void DatasetProgressWorker::addDataset(long uid)
+{
+	job.add(uid);
+}
+
+void DatasetProgressWorker::queue()
+{
+	job.queue(this);
+}
+
+void DatasetProgressWorker::setProgressCallback(Local<Function> progress)
+{
+	if(progress_callback) delete progress_callback;
+	progress_callback = new Nan::Callback(progress);
+}
+
+void DatasetProgressWorker::setCancelToken(Local<Object> token)
+{
+	// the typed array is persisted so its backing store stays alive while the job runs
+	SaveToPersistent("cancel_token", token);
+	Nan::TypedArrayContents<int32_t> contents(token);
+	if(contents.length() > 0) cancel_flag = *contents;
+}
+
+bool DatasetProgressWorker::isCancelled()
+{
+	return cancel_flag && cancel_flag[0] != 0;
+}
+
+void DatasetProgressWorker::Execute(const ExecutionProgress &progress)
+{
+	if(!job.begin()) {
+		SetErrorMessage("Dataset object has already been destroyed");
+		return;
+	}
+
+	execution_progress = &progress;
+	CPLErrorReset();
+	if(isCancelled()) {
+		SetErrorMessage("Operation cancelled");
+	} else {
+		Run();
+	}
+	execution_progress = NULL;
+	job.end();
+}
+
+void DatasetProgressWorker::WorkComplete()
+{
+	job.finish();
+	Nan::AsyncProgressWorkerBase<double>::WorkComplete();
+}
+
+int CPL_STDCALL DatasetProgressWorker::ProgressFunc(double complete, const char *message, void *arg)
+{
+	DatasetProgressWorker *worker = (DatasetProgressWorker *) arg;
+
+	if(worker->isCancelled()) return FALSE;
+
+	if(worker->progress_callback && worker->execution_progress) {
+		if(complete - worker->last_progress >= 0.001 || (complete >= 1.0 && worker->last_progress < 1.0)) {
+			worker->last_progress = complete;
+			worker->execution_progress->Send(&complete, 1);
+		}
+	}
+	return TRUE;
+}
+
+void DatasetProgressWorker::HandleProgressCallback(const double *data, size_t count)
+{
+	Nan::HandleScope scope;
+
+	if(!progress_callback || completed || !data || count == 0) return;
+
+	reported_progress = data[0];
+	Local<Value> argv[] = { Nan::New<Number>(data[0]) };
+	progress_callback->Call(1, argv, async_resource);
+}
+
+Local<Value> DatasetProgressWorker::GetResult()
+{
+	return Nan::Undefined();
+}
+
+void DatasetProgressWorker::HandleOKCallback()
+{
+	Nan::HandleScope scope;
+
+	if(progress_callback && !completed && reported_progress < 1.0) {
+		double complete = 1.0;
+		HandleProgressCallback(&complete, 1);
+	}
+	completed = true;
+
+	Local<Value> argv[] = { Nan::Null(), GetResult() };
+	callback->Call(2, argv, async_resource);
+}
+
+void DatasetProgressWorker::HandleErrorCallback()
+{
+	completed = true;
+	Nan::AsyncProgressWorkerBase<double>::HandleErrorCallback();
+}
+
+void DatasetProgressWorker::SetCPLErrorMessage(const char *fallback)
+{
+	if(isCancelled()) {
+		SetErrorMessage("Operation cancelled");
+		return;
+	}
+	SetErrorMessage(getCPLErrorMessage(fallback));
+}
+
+}
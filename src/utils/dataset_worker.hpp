@@ -0,0 +1,171 @@
+#ifndef __NODE_GDAL_DATASET_WORKER_H__
+#define __NODE_GDAL_DATASET_WORKER_H__
+
+// node
+#include <node.h>
+#include <uv.h>
+
+// nan
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+// gdal
+#include <cpl_port.h>
+
+#include <map>
+#include <vector>
+
+using namespace v8;
+
+struct PtrManagerDatasetItem;
+
+namespace node_gdal {
+
+class DatasetPool;
+
+// The datasets an async job depends on, and its place in their queues.
+//
+// Each dataset is retained in the PtrManager until the job is destroyed. Jobs
+// on the same dataset run one at a time, in the order they were queued: the
+// PtrManager keeps a FIFO per dataset and only hands a job to the libuv
+// threadpool once it is at the head of the queue of every dataset it needs,
+// so threadpool threads never wait for a dataset. A job is appended to all of
+// its queues at once, so two jobs are in the same order in every queue they
+// share and jobs on several datasets can't deadlock.
+//
+// Jobs on a dataset opened with gdal.openPool() can instead wait for any free
+// handle of its pool (see setPool()).
+
+class DatasetJob {
+public:
+	DatasetJob();
+	~DatasetJob();
+
+	// main thread: accepts a dataset, band or layer uid
+	void add(long uid);
+	// main thread: runs the job on a free handle of `pool` instead of the dataset itself
+	void setPool(DatasetPool *pool);
+	// main thread: hands `worker` to the threadpool once its datasets are free
+	void queue(Nan::AsyncWorker *worker);
+	// main thread: called when the worker has completed; starts the jobs waiting for it
+	void finish();
+
+	// worker thread: returns false if a dataset was destroyed before the job was queued
+	bool begin();
+	// worker thread: lets synchronous calls waiting for the datasets proceed
+	void end();
+
+	// the pool handle reserved for the job, or -1
+	int handle;
+
+private:
+	friend class PtrManager;
+	enum State { IDLE, QUEUED, STARTED, FINISHED };
+
+	std::map<long, PtrManagerDatasetItem*> items;
+	bool missing;
+	Nan::AsyncWorker *worker;
+	DatasetPool *pool;
+	State state;
+};
+
+// Keeps async jobs off the given datasets for the lifetime of the object, so
+// synchronous calls on the main thread never touch a GDALDataset used by a
+// job. Waits for the job currently running on each dataset, if any; queued
+// jobs start once the lock is released.
+
+class DatasetSyncLock {
+public:
+	DatasetSyncLock();
+	// accepts a dataset, band or layer uid
+	DatasetSyncLock(long uid);
+	~DatasetSyncLock();
+
+	void add(long uid);
+private:
+	std::vector<PtrManagerDatasetItem*> items;
+};
+
+// Base class for jobs that operate on open datasets from the libuv threadpool.
+//
+// Run() executes once the dataset owning `uid` (plus any added with
+// addDataset()) is free, so two jobs never touch the same GDALDataset at the
+// same time. Callers must check isAlive() before constructing a worker, should
+// SaveToPersistent() any JS objects the job depends on, and start it with
+// queue() instead of Nan::AsyncQueueWorker().
+
+class DatasetWorker : public Nan::AsyncWorker {
+public:
+	DatasetWorker(Nan::Callback *callback, long uid);
+	virtual ~DatasetWorker();
+
+	void addDataset(long uid);
+	void setPool(DatasetPool *pool);
+	void queue();
+	void Execute();
+	void WorkComplete();
+
+protected:
+	// called on a worker thread once the datasets are free
+	virtual void Run() = 0;
+	// called on the main thread to produce the value passed to the callback
+	virtual Local<Value> GetResult();
+
+	void HandleOKCallback();
+	void SetCPLErrorMessage(const char *fallback = NULL);
+	// the pool handle to use in Run() after setPool()
+	int poolHandle();
+
+private:
+	DatasetJob job;
+};
+
+// Same as DatasetWorker, but hands ProgressFunc to GDAL so progress can be
+// reported to a JS callback and the job can be aborted with a cancel token
+// (an Int32Array whose first element is set to non-zero from JS).
+//
+// Progress is delivered through uv_async, so JS sees at most one update per
+// event loop tick; updates smaller than 0.1% are not sent at all. Since the
+// last update can be coalesced away, a final 1 is reported right before the
+// callback of a successful job if JS hasn't seen it yet.
+
+class DatasetProgressWorker : public Nan::AsyncProgressWorkerBase<double> {
+public:
+	DatasetProgressWorker(Nan::Callback *callback, long uid = 0);
+	virtual ~DatasetProgressWorker();
+
+	void addDataset(long uid);
+	void setProgressCallback(Local<Function> progress);
+	void setCancelToken(Local<Object> token);
+	void queue();
+	void Execute(const ExecutionProgress &progress);
+	void WorkComplete();
+
+	static int CPL_STDCALL ProgressFunc(double complete, const char *message, void *arg);
+
+protected:
+	virtual void Run() = 0;
+	virtual Local<Value> GetResult();
+
+	bool isCancelled();
+	void HandleOKCallback();
+	void HandleErrorCallback();
+	void HandleProgressCallback(const double *data, size_t count);
+	void SetCPLErrorMessage(const char *fallback = NULL);
+
+private:
+	DatasetJob job;
+	Nan::Callback *progress_callback;
+	volatile int32_t *cancel_flag;
+	const ExecutionProgress *execution_progress;
+	double last_progress;
+	// main thread: the last value passed to progress_callback, and whether
+	// the job's callback has been called (late updates are dropped)
+	double reported_progress;
+	bool completed;
+};
+
+}
+#endif
@@ -0,0 +1,444 @@
+#include "mosaic_builder.hpp"
+#include "chunk_scan.hpp"
+#include "buffer_path.hpp"
+
+// gdal
+#include <cpl_quad_tree.h>
+#include <gdal_proxy.h>
+#include <vrtdataset.h>
+#include <ogr_spatialref.h>
+
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+
+namespace node_gdal {
+
+// what the mosaic needs to know about a file, read from its header
+struct SourceHeader {
+	int x_size;
+	int y_size;
+	double gt[6];
+	std::string wkt;
+	std::vector<GDALDataType> types;
+	std::vector<int> block_x_size;
+	std::vector<int> block_y_size;
+	std::vector<int> has_nodata;
+	std::vector<double> nodata;
+	std::vector<GDALColorInterp> color_interp;
+	// empty if the header was read successfully
+	std::string error;
+};
+
+// each chunk is a file
+struct HeaderReader : public ChunkScan {
+	const std::vector<std::string> *files;
+	std::vector<SourceHeader> *headers;
+};
+
+static void readHeader(const std::string &file, SourceHeader &header)
+{
+	if(isBufferPath(file)) {
+		header.error = file + " belongs to a dataset opened with gdal.openBuffer() and can't be opened again";
+		return;
+	}
+
+	CPLErrorReset();
+	CPLPushErrorHandler(CPLQuietErrorHandler);
+	GDALDataset *ds = (GDALDataset *) GDALOpenEx(file.c_str(), GDAL_OF_RASTER | GDAL_OF_READONLY, NULL, NULL, NULL);
+	CPLPopErrorHandler();
+	if(!ds) {
+		header.error = CPLGetLastErrorMsg();
+		if(header.error.empty()) header.error = "Unable to open " + file;
+		return;
+	}
+
+	header.x_size = ds->GetRasterXSize();
+	header.y_size = ds->GetRasterYSize();
+	const char *wkt = ds->GetProjectionRef();
+	header.wkt = wkt ? wkt : "";
+
+	if(ds->GetGeoTransform(header.gt) != CE_None) {
+		header.error = file + " has no geotransform";
+	} else if(header.gt[2] != 0 || header.gt[4] != 0) {
+		header.error = file + " has a rotated geotransform, which mosaics don't support";
+	} else if(ds->GetRasterCount() == 0) {
+		header.error = file + " has no raster bands";
+	}
+
+	for(int i = 1; header.error.empty() && i <= ds->GetRasterCount(); i++) {
+		GDALRasterBand *band = ds->GetRasterBand(i);
+		int block_x_size, block_y_size, has_nodata;
+		band->GetBlockSize(&block_x_size, &block_y_size);
+		double nodata = band->GetNoDataValue(&has_nodata);
+		header.types.push_back(band->GetRasterDataType());
+		header.block_x_size.push_back(block_x_size);
+		header.block_y_size.push_back(block_y_size);
+		header.has_nodata.push_back(has_nodata);
+		header.nodata.push_back(nodata);
+		header.color_interp.push_back(band->GetColorInterpretation());
+	}
+
+	GDALClose((GDALDatasetH) ds);
+}
+
+static void readHeaders(void *arg)
+{
+	HeaderReader *reader = (HeaderReader *) arg;
+	GIntBig i;
+	while(true) {
+		reader->lock();
+		if(!reader->next(i)) {
+			reader->unlock();
+			break;
+		}
+		reader->unlock();
+
+		readHeader((*reader->files)[i], (*reader->headers)[i]);
+
+		reader->lock();
+		reader->done();
+		reader->unlock();
+	}
+}
+
+class MosaicDataset;
+
+// Narrows a band's sources to `subset` for the lifetime of the object, so
+// VRTSourcedRasterBand only iterates the sources a read actually touches
+class SourceSubset {
+public:
+	SourceSubset(VRTSourcedRasterBand *band, std::vector<VRTSource*> &subset)
+		: band(band), n_sources(band->nSources), sources(band->papoSources)
+	{
+		band->nSources = (int) subset.size();
+		band->papoSources = subset.empty() ? NULL : &subset[0];
+	}
+	~SourceSubset()
+	{
+		band->nSources = n_sources;
+		band->papoSources = sources;
+	}
+private:
+	VRTSourcedRasterBand *band;
+	int n_sources;
+	VRTSource **sources;
+};
+
+class MosaicRasterBand : public VRTSourcedRasterBand {
+public:
+	MosaicRasterBand(GDALDataset *ds, int band, GDALDataType type, int x_size, int y_size)
+		: VRTSourcedRasterBand(ds, band, type, x_size, y_size), all_sources_array(NULL)
+	{}
+
+	virtual CPLErr IRasterIO(GDALRWFlag eRWFlag, int nXOff, int nYOff, int nXSize, int nYSize,
+	                         void *pData, int nBufXSize, int nBufYSize, GDALDataType eBufType,
+	                         GSpacing nPixelSpace, GSpacing nLineSpace,
+	                         GDALRasterIOExtraArg *psExtraArg);
+
+	// VRT only builds implicit overviews for single source datasets, and
+	// would build them from whatever subset a read left in place
+	virtual int GetOverviewCount()
+	{
+		if(all_sources.size() > 1) return GDALRasterBand::GetOverviewCount();
+		return VRTSourcedRasterBand::GetOverviewCount();
+	}
+	virtual GDALRasterBand *GetOverview(int i)
+	{
+		if(all_sources.size() > 1) return GDALRasterBand::GetOverview(i);
+		return VRTSourcedRasterBand::GetOverview(i);
+	}
+
+	void indexSources()
+	{
+		all_sources.assign(papoSources, papoSources + nSources);
+		all_sources_array = papoSources;
+	}
+
+	// false while a read has replaced the sources (VRTDataset does this too,
+	// to fill the buffer with nodata), in which case they are left alone
+	bool hasAllSources()
+	{
+		return papoSources == all_sources_array && nSources == (int) all_sources.size();
+	}
+
+	// every source of the band, in mosaic order
+	std::vector<VRTSource*> all_sources;
+
+private:
+	VRTSource **all_sources_array;
+};
+
+class MosaicDataset : public VRTDataset {
+public:
+	MosaicDataset(int x_size, int y_size)
+		: VRTDataset(x_size, y_size), index(NULL)
+	{
+		poDriver = (GDALDriver *) GDALGetDriverByName("VRT");
+	}
+	~MosaicDataset()
+	{
+		if(index) CPLQuadTreeDestroy(index);
+	}
+
+	void addBand(GDALDataType type)
+	{
+		int n = GetRasterCount() + 1;
+		SetBand(n, new MosaicRasterBand(this, n, type, nRasterXSize, nRasterYSize));
+	}
+
+	// called once every source has been added
+	void buildIndex()
+	{
+		CPLRectObj bounds;
+		bounds.minx = 0;
+		bounds.miny = 0;
+		bounds.maxx = nRasterXSize;
+		bounds.maxy = nRasterYSize;
+		index = CPLQuadTreeCreate(&bounds, getWindow);
+		CPLQuadTreeSetMaxDepth(index, CPLQuadTreeGetAdvisedMaxDepth((int) windows.size()));
+		for(size_t i = 0; i < windows.size(); i++) {
+			CPLQuadTreeInsert(index, &windows[i]);
+		}
+		for(int i = 1; i <= nBands; i++) {
+			((MosaicRasterBand *) GetRasterBand(i))->indexSources();
+		}
+	}
+
+	// the sources among `all` overlapping a window, in mosaic order
+	void selectSources(const std::vector<VRTSource*> &all, int x_off, int y_off, int x_size, int y_size, std::vector<VRTSource*> &subset)
+	{
+		CPLRectObj rect;
+		rect.minx = x_off;
+		rect.miny = y_off;
+		rect.maxx = x_off + x_size;
+		rect.maxy = y_off + y_size;
+
+		int count = 0;
+		void **found = CPLQuadTreeSearch(index, &rect, &count);
+		std::vector<size_t> indices;
+		for(int i = 0; i < count; i++) {
+			const CPLRectObj *window = (const CPLRectObj *) found[i];
+			// the tree also returns windows that only share an edge with rect
+			if(window->maxx > rect.minx && window->minx < rect.maxx && window->maxy > rect.miny && window->miny < rect.maxy) {
+				indices.push_back(window - &windows[0]);
+			}
+		}
+		CPLFree(found);
+
+		// sources painted later win, so keep their order
+		std::sort(indices.begin(), indices.end());
+		subset.clear();
+		for(size_t i = 0; i < indices.size(); i++) {
+			subset.push_back(all[indices[i]]);
+		}
+	}
+
+	// Reads go band by band, each band narrowing its own sources. Narrowing
+	// them here instead would let VRTDataset::IRasterIO() cache whether the
+	// sources allow dataset level reads from whatever subset the first read
+	// touched, and later reads of sources with nodata would ignore it.
+	virtual CPLErr IRasterIO(GDALRWFlag eRWFlag, int nXOff, int nYOff, int nXSize, int nYSize,
+	                         void *pData, int nBufXSize, int nBufYSize, GDALDataType eBufType,
+	                         int nBandCount, int *panBandMap,
+	                         GSpacing nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
+	                         GDALRasterIOExtraArg *psExtraArg)
+	{
+		if(!index || eRWFlag != GF_Read) {
+			return VRTDataset::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize, pData, nBufXSize, nBufYSize, eBufType,
+			                             nBandCount, panBandMap, nPixelSpace, nLineSpace, nBandSpace, psExtraArg);
+		}
+		return GDALDataset::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize, pData, nBufXSize, nBufYSize, eBufType,
+		                              nBandCount, panBandMap, nPixelSpace, nLineSpace, nBandSpace, psExtraArg);
+	}
+
+	// destination window of each source, in pixels of the mosaic
+	std::vector<CPLRectObj> windows;
+
+private:
+	static void getWindow(const void *feature, CPLRectObj *bounds)
+	{
+		*bounds = *(const CPLRectObj *) feature;
+	}
+
+	CPLQuadTree *index;
+};
+
+CPLErr MosaicRasterBand::IRasterIO(GDALRWFlag eRWFlag, int nXOff, int nYOff, int nXSize, int nYSize,
+                                   void *pData, int nBufXSize, int nBufYSize, GDALDataType eBufType,
+                                   GSpacing nPixelSpace, GSpacing nLineSpace,
+                                   GDALRasterIOExtraArg *psExtraArg)
+{
+	if(all_sources.empty() || eRWFlag != GF_Read || !hasAllSources()) {
+		return VRTSourcedRasterBand::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize, pData, nBufXSize, nBufYSize, eBufType,
+		                                       nPixelSpace, nLineSpace, psExtraArg);
+	}
+
+	std::vector<VRTSource*> subset;
+	((MosaicDataset *) poDS)->selectSources(all_sources, nXOff, nYOff, nXSize, nYSize, subset);
+	SourceSubset narrowed(this, subset);
+	return VRTSourcedRasterBand::IRasterIO(eRWFlag, nXOff, nYOff, nXSize, nYSize, pData, nBufXSize, nBufYSize, eBufType,
+	                                       nPixelSpace, nLineSpace, psExtraArg);
+}
+
+// checks that a source can go in the same mosaic as the first one
+static bool checkCompatible(const std::string &file, const SourceHeader &header, const std::string &first_file, const SourceHeader &first)
+{
+	if(header.types.size() != first.types.size()) {
+		CPLError(CE_Failure, CPLE_AppDefined, "%s has %d bands but %s has %d",
+			file.c_str(), (int) header.types.size(), first_file.c_str(), (int) first.types.size());
+		return false;
+	}
+	for(size_t i = 0; i < header.types.size(); i++) {
+		if(header.types[i] != first.types[i]) {
+			CPLError(CE_Failure, CPLE_AppDefined, "Band %d of %s is %s but band %d of %s is %s",
+				(int) i + 1, file.c_str(), GDALGetDataTypeName(header.types[i]),
+				(int) i + 1, first_file.c_str(), GDALGetDataTypeName(first.types[i]));
+			return false;
+		}
+	}
+	if(header.wkt != first.wkt) {
+		OGRSpatialReference srs, first_srs;
+		char *wkt = (char *) header.wkt.c_str();
+		char *first_wkt = (char *) first.wkt.c_str();
+		if(header.wkt.empty() || first.wkt.empty()
+			|| srs.importFromWkt(&wkt) != OGRERR_NONE || first_srs.importFromWkt(&first_wkt) != OGRERR_NONE
+			|| !srs.IsSame(&first_srs)) {
+			CPLError(CE_Failure, CPLE_AppDefined, "%s has a different spatial reference than %s", file.c_str(), first_file.c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+CPLErr buildMosaic(const std::vector<std::string> &files, const MosaicOptions &options,
+                   GDALDataset **result, GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	*result = NULL;
+	if(files.empty()) {
+		CPLError(CE_Failure, CPLE_AppDefined, "No files to mosaic");
+		return CE_Failure;
+	}
+
+	std::vector<SourceHeader> headers(files.size());
+	HeaderReader reader;
+	reader.files = &files;
+	reader.headers = &headers;
+	reader.n_chunks = (GIntBig) files.size();
+	if(pfnProgress) reader.pfnProgress = pfnProgress;
+	reader.pProgressArg = pProgressArg;
+
+	reader.run(readHeaders, &reader, options.threads);
+	if(reader.error()) return CE_Failure;
+	for(size_t i = 0; i < headers.size(); i++) {
+		if(!headers[i].error.empty()) {
+			CPLError(CE_Failure, CPLE_OpenFailed, "%s", headers[i].error.c_str());
+			return CE_Failure;
+		}
+		if(i > 0 && !checkCompatible(files[i], headers[i], files[0], headers[0])) {
+			return CE_Failure;
+		}
+	}
+
+	// extent and resolution of the mosaic
+	double min_x = headers[0].gt[0], max_y = headers[0].gt[3];
+	double max_x = min_x, min_y = max_y;
+	double x_res = 0, y_res = 0;
+	for(size_t i = 0; i < headers.size(); i++) {
+		const SourceHeader &header = headers[i];
+		double w = fabs(header.gt[1]), h = fabs(header.gt[5]);
+		double left = std::min(header.gt[0], header.gt[0] + header.x_size * header.gt[1]);
+		double top = std::max(header.gt[3], header.gt[3] + header.y_size * header.gt[5]);
+		min_x = std::min(min_x, left);
+		max_x = std::max(max_x, left + header.x_size * w);
+		max_y = std::max(max_y, top);
+		min_y = std::min(min_y, top - header.y_size * h);
+
+		if(options.resolution == MosaicOptions::AVERAGE) {
+			x_res += w / headers.size();
+			y_res += h / headers.size();
+		} else if(options.resolution == MosaicOptions::HIGHEST) {
+			x_res = i == 0 ? w : std::min(x_res, w);
+			y_res = i == 0 ? h : std::min(y_res, h);
+		} else if(options.resolution == MosaicOptions::LOWEST) {
+			x_res = std::max(x_res, w);
+			y_res = std::max(y_res, h);
+		}
+	}
+	if(options.resolution == MosaicOptions::USER) {
+		x_res = options.x_res;
+		y_res = options.y_res;
+	}
+
+	double x_size = (max_x - min_x) / x_res, y_size = (max_y - min_y) / y_res;
+	if(!(x_size >= 1 && y_size >= 1 && x_size < INT_MAX && y_size < INT_MAX)) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Invalid mosaic size %.0fx%.0f", x_size, y_size);
+		return CE_Failure;
+	}
+
+	const SourceHeader &first = headers[0];
+	MosaicDataset *mosaic = new MosaicDataset((int) (x_size + 0.5), (int) (y_size + 0.5));
+	double gt[6] = {min_x, x_res, 0, max_y, 0, -y_res};
+	mosaic->SetGeoTransform(gt);
+	if(!first.wkt.empty()) mosaic->SetProjection(first.wkt.c_str());
+
+	int n_bands = (int) first.types.size();
+	for(int b = 0; b < n_bands; b++) {
+		mosaic->addBand(first.types[b]);
+		GDALRasterBand *band = mosaic->GetRasterBand(b + 1);
+		band->SetColorInterpretation(first.color_interp[b]);
+		if(options.has_vrt_nodata) band->SetNoDataValue(options.vrt_nodata);
+		else if(options.has_src_nodata) band->SetNoDataValue(options.src_nodata);
+		else if(first.has_nodata[b]) band->SetNoDataValue(first.nodata[b]);
+	}
+
+	mosaic->windows.resize(headers.size());
+	for(size_t i = 0; i < headers.size(); i++) {
+		const SourceHeader &header = headers[i];
+		double left = std::min(header.gt[0], header.gt[0] + header.x_size * header.gt[1]);
+		double top = std::max(header.gt[3], header.gt[3] + header.y_size * header.gt[5]);
+		double dst_x_off = (left - min_x) / x_res;
+		double dst_y_off = (max_y - top) / y_res;
+		double dst_x_size = header.x_size * fabs(header.gt[1]) / x_res;
+		double dst_y_size = header.y_size * fabs(header.gt[5]) / y_res;
+
+		CPLRectObj &window = mosaic->windows[i];
+		window.minx = dst_x_off;
+		window.miny = dst_y_off;
+		window.maxx = dst_x_off + dst_x_size;
+		window.maxy = dst_y_off + dst_y_size;
+
+		// opened on demand, through a pool bounding the number of open files
+		GDALProxyPoolDataset *proxy = new GDALProxyPoolDataset(files[i].c_str(), header.x_size, header.y_size, GA_ReadOnly, TRUE,
+			header.wkt.c_str(), (double *) header.gt);
+		for(int b = 0; b < n_bands; b++) {
+			proxy->AddSrcBandDescription(header.types[b], header.block_x_size[b], header.block_y_size[b]);
+		}
+
+		for(int b = 0; b < n_bands; b++) {
+			VRTSourcedRasterBand *band = (VRTSourcedRasterBand *) mosaic->GetRasterBand(b + 1);
+			VRTSimpleSource *source;
+			if(options.has_src_nodata || header.has_nodata[b]) {
+				VRTComplexSource *complex = new VRTComplexSource();
+				complex->SetNoDataValue(options.has_src_nodata ? options.src_nodata : header.nodata[b]);
+				source = complex;
+			} else {
+				source = new VRTSimpleSource();
+			}
+			band->ConfigureSource(source, proxy->GetRasterBand(b + 1), FALSE,
+				0, 0, header.x_size, header.y_size,
+				dst_x_off, dst_y_off, dst_x_size, dst_y_size);
+			band->AddSource(source);
+		}
+
+		GDALDereferenceDataset((GDALDatasetH) proxy);
+	}
+
+	mosaic->buildIndex();
+	*result = mosaic;
+
+	reader.pfnProgress(1.0, NULL, reader.pProgressArg);
+	return CE_None;
+}
+
+}
@@ -0,0 +1,43 @@
+#ifndef __MOSAIC_BUILDER_H__
+#define __MOSAIC_BUILDER_H__
+
+// gdal
+#include <gdal_priv.h>
+
+#include <string>
+#include <vector>
+
+namespace node_gdal {
+
+struct MosaicOptions {
+	enum Resolution { AVERAGE, HIGHEST, LOWEST, USER };
+	Resolution resolution;
+	// used with USER resolution; both positive
+	double x_res;
+	double y_res;
+	// overrides the sources' own nodata values
+	bool has_src_nodata;
+	double src_nodata;
+	bool has_vrt_nodata;
+	double vrt_nodata;
+	int threads;
+};
+
+// Builds an in-memory VRT mosaic of `files`, like gdalbuildvrt.
+//
+// File headers are read on a CPL worker pool, then checked for a common
+// spatial reference, band count and band types. Sources are referenced
+// through GDALProxyPoolDataset, so only a bounded number of them are open at
+// any time. The returned dataset keeps a quadtree of its sources' extents:
+// reads only visit the sources overlapping the requested window instead of
+// scanning every source of the mosaic.
+//
+// The dataset has no description, so closing it doesn't write a .vrt file;
+// it can be saved with the VRT driver's CreateCopy().
+
+CPLErr buildMosaic(const std::vector<std::string> &files, const MosaicOptions &options,
+                   GDALDataset **result, GDALProgressFunc pfnProgress, void *pProgressArg);
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "overview_builder.hpp"
+#include "chunk_scan.hpp"
+
+// gdal
+#include <gdal_proxy.h>
+
+#include <string>
+#include <vector>
+
+namespace node_gdal {
+
+// Forwards every call to the underlying band while holding the shared mutex
+class LockedRasterBand : public GDALProxyRasterBand {
+public:
+	LockedRasterBand(GDALRasterBand *band, CPLMutex *mutex)
+		: band(band), mutex(mutex)
+	{
+		nRasterXSize = band->GetXSize();
+		nRasterYSize = band->GetYSize();
+		eDataType = band->GetRasterDataType();
+		eAccess = band->GetAccess();
+		band->GetBlockSize(&nBlockXSize, &nBlockYSize);
+	}
+
+protected:
+	GDALRasterBand* RefUnderlyingRasterBand()
+	{
+		lockMutex(mutex);
+		return band;
+	}
+	void UnrefUnderlyingRasterBand(GDALRasterBand*)
+	{
+		CPLReleaseMutex(mutex);
+	}
+
+private:
+	GDALRasterBand *band;
+	CPLMutex *mutex;
+};
+
+struct OverviewBuild;
+
+struct OverviewBandJob {
+	OverviewBuild *build;
+	GDALRasterBand *src;
+	std::vector<GDALRasterBand*> overviews;
+	double progress;
+	CPLErr err;
+	std::string error_msg;
+};
+
+struct OverviewBuild {
+	const char *resampling;
+	CPLMutex *io_mutex;
+	CPLMutex *progress_mutex;
+	std::vector<OverviewBandJob> jobs;
+	GDALProgressFunc pfnProgress;
+	void *pProgressArg;
+	bool cancelled;
+};
+
+// reports the average progress of all bands
+static int CPL_STDCALL bandProgress(double complete, const char *message, void *arg)
+{
+	OverviewBandJob *job = (OverviewBandJob *) arg;
+	OverviewBuild *build = job->build;
+
+	lockMutex(build->progress_mutex);
+	job->progress = complete;
+	if(!build->cancelled) {
+		double total = 0;
+		for(size_t i = 0; i < build->jobs.size(); i++) {
+			total += build->jobs[i].progress;
+		}
+		if(!build->pfnProgress(total / build->jobs.size(), message, build->pProgressArg)) {
+			build->cancelled = true;
+		}
+	}
+	bool cancelled = build->cancelled;
+	CPLReleaseMutex(build->progress_mutex);
+
+	return cancelled ? FALSE : TRUE;
+}
+
+static void regenerateBand(void *arg)
+{
+	OverviewBandJob *job = (OverviewBandJob *) arg;
+	OverviewBuild *build = job->build;
+
+	LockedRasterBand src(job->src, build->io_mutex);
+	std::vector<LockedRasterBand*> proxies;
+	std::vector<GDALRasterBandH> overviews;
+	for(size_t i = 0; i < job->overviews.size(); i++) {
+		proxies.push_back(new LockedRasterBand(job->overviews[i], build->io_mutex));
+		overviews.push_back((GDALRasterBandH) proxies.back());
+	}
+
+	CPLErrorReset();
+	job->err = GDALRegenerateOverviews((GDALRasterBandH) &src, (int) overviews.size(), &overviews[0],
+	                                   build->resampling, bandProgress, job);
+	if(job->err) {
+		job->error_msg = CPLGetLastErrorMsg();
+	}
+
+	for(size_t i = 0; i < proxies.size(); i++) {
+		delete proxies[i];
+	}
+}
+
+// finds the overview of `band` created for the given decimation factor
+static GDALRasterBand* findOverview(GDALRasterBand *band, int level)
+{
+	int w = band->GetXSize();
+	int h = band->GetYSize();
+
+	for(int i = 0; i < band->GetOverviewCount(); i++) {
+		GDALRasterBand *overview = band->GetOverview(i);
+		int factor = GDALComputeOvFactor(overview->GetXSize(), w, overview->GetYSize(), h);
+		if(factor == level || factor == GDALOvLevelAdjust2(level, w, h)) {
+			return overview;
+		}
+	}
+	return NULL;
+}
+
+CPLErr buildOverviewsConcurrently(GDALDataset *ds, const char *resampling,
+                                  int n_overviews, int *overviews,
+                                  int n_bands, int *bands,
+                                  GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	std::vector<int> band_ids;
+	if(n_bands > 0) {
+		band_ids.assign(bands, bands + n_bands);
+	} else {
+		for(int i = 1; i <= ds->GetRasterCount(); i++) band_ids.push_back(i);
+	}
+
+	bool concurrent = band_ids.size() > 1 && n_overviews > 0 && !EQUAL(resampling, "NONE");
+	for(size_t i = 0; concurrent && i < band_ids.size(); i++) {
+		// mask bands read the dataset behind the proxies' back
+		if(ds->GetRasterBand(band_ids[i])->GetMaskFlags() != GMF_ALL_VALID) concurrent = false;
+	}
+	if(!concurrent) {
+		return ds->BuildOverviews(resampling, n_overviews, overviews, n_bands, bands, pfnProgress, pProgressArg);
+	}
+	if(!pfnProgress) pfnProgress = GDALDummyProgress;
+
+	// create (empty) overview bands
+	CPLErr err = ds->BuildOverviews("NONE", n_overviews, overviews, n_bands, bands, NULL, NULL);
+	if(err) return err;
+
+	OverviewBuild build;
+	build.resampling = resampling;
+	build.pfnProgress = pfnProgress;
+	build.pProgressArg = pProgressArg;
+	build.cancelled = false;
+	build.jobs.resize(band_ids.size());
+
+	for(size_t i = 0; i < band_ids.size(); i++) {
+		OverviewBandJob &job = build.jobs[i];
+		job.build = &build;
+		job.src = ds->GetRasterBand(band_ids[i]);
+		job.progress = 0;
+		job.err = CE_None;
+		for(int j = 0; j < n_overviews; j++) {
+			GDALRasterBand *overview = findOverview(job.src, overviews[j]);
+			if(!overview) {
+				CPLError(CE_Failure, CPLE_AppDefined, "Unable to find overview level %d of band %d", overviews[j], band_ids[i]);
+				return CE_Failure;
+			}
+			job.overviews.push_back(overview);
+		}
+	}
+
+	build.io_mutex = CPLCreateMutex();
+	CPLReleaseMutex(build.io_mutex);
+	build.progress_mutex = CPLCreateMutex();
+	CPLReleaseMutex(build.progress_mutex);
+
+	std::vector<void*> args;
+	for(size_t i = 0; i < build.jobs.size(); i++) {
+		args.push_back(&build.jobs[i]);
+	}
+	runJobs(regenerateBand, args, CPLGetNumCPUs());
+
+	CPLDestroyMutex(build.io_mutex);
+	CPLDestroyMutex(build.progress_mutex);
+
+	for(size_t i = 0; i < build.jobs.size(); i++) {
+		if(build.jobs[i].err) {
+			CPLError(build.jobs[i].err, CPLE_AppDefined, "%s", build.jobs[i].error_msg.c_str());
+			return build.jobs[i].err;
+		}
+	}
+
+	pfnProgress(1.0, NULL, pProgressArg);
+	return CE_None;
+}
+
+}
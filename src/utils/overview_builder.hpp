@@ -0,0 +1,26 @@
+#ifndef __OVERVIEW_BUILDER_H__
+#define __OVERVIEW_BUILDER_H__
+
+// gdal
+#include <gdal_priv.h>
+
+namespace node_gdal {
+
+// Builds overviews with the levels of each band resampled on a separate thread.
+//
+// GDAL datasets aren't safe for concurrent I/O, so the overview structure is
+// created up front and each band is then regenerated through proxy bands that
+// serialize every driver call on a shared mutex; only the resampling itself
+// runs in parallel. Falls back to GDALDataset::BuildOverviews() when that
+// isn't possible (single band, masked / nodata bands, "NONE" resampling).
+//
+// Must be called with the dataset lock held. Band ids must already be validated.
+
+CPLErr buildOverviewsConcurrently(GDALDataset *ds, const char *resampling,
+                                  int n_overviews, int *overviews,
+                                  int n_bands, int *bands,
+                                  GDALProgressFunc pfnProgress, void *pProgressArg);
+
+}
+
+#endif
@@ -2,13 +2,16 @@
 #include "../gdal_dataset.hpp"
 #include "../gdal_rasterband.hpp"
 #include "../gdal_layer.hpp"
+#include "dataset_pool.hpp"
+#include "dataset_worker.hpp"
+#include "virtual_mem.hpp"
 
 #include <sstream>
 
 namespace node_gdal {
 
 PtrManager::PtrManager()
-	: uid(1), layers(), bands(), datasets()
+	: uid(1), layers(), bands(), datasets(), closing_datasets()
 {
 }
 
@@ -16,6 +19,62 @@ PtrManager::~PtrManager()
 {
 }
 
+DatasetPool* PtrManager::createPool(long ds_uid, const char *path, int size)
+{
+	if(!datasets.count(ds_uid)) return NULL;
+	PtrManagerDatasetItem *item = datasets[ds_uid];
+	if(!item->pool) item->pool = new DatasetPool(item->ptr, path, size);
+	return item->pool;
+}
+
+DatasetPool* PtrManager::getPool(long uid)
+{
+	long ds_uid = getDatasetUid(uid);
+	if(!ds_uid) return NULL;
+	return datasets[ds_uid]->pool;
+}
+
+VirtualMem* PtrManager::createMapping(long uid, GDALRasterBand *band, GDALRWFlag flag)
+{
+	long ds_uid = getDatasetUid(uid);
+	if(!ds_uid) return NULL;
+	VirtualMem *mem = VirtualMem::New(ds_uid, band, flag);
+	if(mem) datasets[ds_uid]->mappings.push_back(mem);
+	return mem;
+}
+
+void PtrManager::disposeMapping(VirtualMem *mem)
+{
+	if(datasets.count(mem->ds_uid)) datasets[mem->ds_uid]->mappings.remove(mem);
+	delete mem;
+}
+
+bool PtrManager::hasMappings(long uid)
+{
+	long ds_uid = getDatasetUid(uid);
+	return ds_uid && !datasets[ds_uid]->mappings.empty();
+}
+
+bool PtrManager::isMapped(long uid, const void *data, size_t size)
+{
+	long ds_uid = getDatasetUid(uid);
+	if(!ds_uid) return false;
+
+	std::list<VirtualMem*>::iterator it;
+	for(it = datasets[ds_uid]->mappings.begin(); it != datasets[ds_uid]->mappings.end(); ++it) {
+		if((*it)->overlaps(data, size)) return true;
+	}
+	return false;
+}
+
+void PtrManager::attachBuffer(long ds_uid, Local<Object> buffer, const std::string &mem_file)
+{
+	if(!datasets.count(ds_uid)) return;
+	PtrManagerDatasetItem *item = datasets[ds_uid];
+	item->buffer = new Nan::Persistent<Object>(buffer);
+	item->mem_file = mem_file;
+}
+
 bool PtrManager::isAlive(long uid)
 {
 	if(uid == 0) return true;
@@ -54,6 +113,15 @@ long PtrManager::add(GDALDataset* ptr)
 	PtrManagerDatasetItem *item = new PtrManagerDatasetItem();
 	item->uid = uid++;
 	item->ptr = ptr;
+	item->async_jobs = 0;
+	item->closing = false;
+	item->active_job = NULL;
+	item->sync_locks = 0;
+	item->running = false;
+	item->pool = NULL;
+	item->buffer = NULL;
+	uv_mutex_init(&item->async_lock);
+	uv_cond_init(&item->async_idle);
 	datasets[item->uid] = item;
 	return item->uid;
 }
@@ -64,11 +132,166 @@ long PtrManager::add(OGRDataSource* ptr)
 	PtrManagerDatasetItem *item = new PtrManagerDatasetItem();
 	item->uid = uid++;
 	item->ptr_datasource = ptr;
+	item->async_jobs = 0;
+	item->closing = false;
+	item->active_job = NULL;
+	item->sync_locks = 0;
+	item->running = false;
+	item->pool = NULL;
+	item->buffer = NULL;
+	uv_mutex_init(&item->async_lock);
+	uv_cond_init(&item->async_idle);
 	datasets[item->uid] = item;
 	return item->uid;
 }
 #endif
 
+long PtrManager::getDatasetUid(long uid)
+{
+	if(datasets.count(uid)) return uid;
+	if(layers.count(uid)) return layers[uid]->parent->uid;
+	if(bands.count(uid)) return bands[uid]->parent->uid;
+	return 0;
+}
+
+PtrManagerDatasetItem* PtrManager::retain(long ds_uid)
+{
+	if(!datasets.count(ds_uid)) return NULL;
+	PtrManagerDatasetItem *item = datasets[ds_uid];
+	item->async_jobs++;
+	return item;
+}
+
+void PtrManager::release(long ds_uid)
+{
+	PtrManagerDatasetItem *item;
+	if(datasets.count(ds_uid)) item = datasets[ds_uid];
+	else if(closing_datasets.count(ds_uid)) item = closing_datasets[ds_uid];
+	else return;
+
+	if(--item->async_jobs > 0) return;
+
+	if(item->closing) {
+		closing_datasets.erase(ds_uid);
+		close(item);
+	} else {
+		releaseResultSets(item);
+	}
+}
+
+void PtrManager::queueJob(DatasetJob *job)
+{
+	job->state = DatasetJob::QUEUED;
+
+	if(job->missing || job->items.empty()) {
+		// nothing to wait for; Execute() reports missing datasets
+		startJob(job);
+		return;
+	}
+
+	if(job->pool) {
+		job->pool->waiting.push_back(job);
+		startNext(job->pool);
+		return;
+	}
+
+	std::map<long, PtrManagerDatasetItem*>::iterator it;
+	for(it = job->items.begin(); it != job->items.end(); ++it) {
+		it->second->pending_jobs.push_back(job);
+	}
+	if(isReady(job)) startJob(job);
+}
+
+void PtrManager::finishJob(DatasetJob *job)
+{
+	DatasetJob::State state = job->state;
+	job->state = DatasetJob::FINISHED;
+
+	if(job->pool) {
+		if(state == DatasetJob::QUEUED) job->pool->waiting.remove(job);
+		if(job->handle >= 0) job->pool->release(job->handle);
+		startNext(job->pool);
+		return;
+	}
+
+	std::map<long, PtrManagerDatasetItem*>::iterator it;
+	for(it = job->items.begin(); it != job->items.end(); ++it) {
+		PtrManagerDatasetItem *item = it->second;
+		if(item->active_job == job) item->active_job = NULL;
+		if(state == DatasetJob::QUEUED) item->pending_jobs.remove(job);
+	}
+	for(it = job->items.begin(); it != job->items.end(); ++it) {
+		startNext(it->second);
+	}
+}
+
+bool PtrManager::isReady(DatasetJob *job)
+{
+	std::map<long, PtrManagerDatasetItem*>::iterator it;
+	for(it = job->items.begin(); it != job->items.end(); ++it) {
+		PtrManagerDatasetItem *item = it->second;
+		if(item->active_job || item->sync_locks > 0 || item->pending_jobs.front() != job) return false;
+	}
+	return true;
+}
+
+void PtrManager::startJob(DatasetJob *job)
+{
+	if(!job->pool && !job->missing) {
+		std::map<long, PtrManagerDatasetItem*>::iterator it;
+		for(it = job->items.begin(); it != job->items.end(); ++it) {
+			PtrManagerDatasetItem *item = it->second;
+			item->pending_jobs.pop_front();
+			item->active_job = job;
+			uv_mutex_lock(&item->async_lock);
+			item->running = true;
+			uv_mutex_unlock(&item->async_lock);
+		}
+	}
+	job->state = DatasetJob::STARTED;
+	Nan::AsyncQueueWorker(job->worker);
+}
+
+void PtrManager::startNext(PtrManagerDatasetItem *item)
+{
+	if(!item->pending_jobs.empty() && isReady(item->pending_jobs.front())) {
+		startJob(item->pending_jobs.front());
+	}
+}
+
+void PtrManager::startNext(DatasetPool *pool)
+{
+	while(!pool->waiting.empty()) {
+		int handle = pool->acquire();
+		if(handle < 0) return;
+		DatasetJob *job = pool->waiting.front();
+		pool->waiting.pop_front();
+		job->handle = handle;
+		startJob(job);
+	}
+}
+
+PtrManagerDatasetItem* PtrManager::lockSync(long uid)
+{
+	long ds_uid = getDatasetUid(uid);
+	PtrManagerDatasetItem *item = retain(ds_uid);
+	if(!item) return NULL;
+
+	item->sync_locks++;
+	uv_mutex_lock(&item->async_lock);
+	while(item->running) {
+		uv_cond_wait(&item->async_idle, &item->async_lock);
+	}
+	uv_mutex_unlock(&item->async_lock);
+	return item;
+}
+
+void PtrManager::unlockSync(PtrManagerDatasetItem *item)
+{
+	if(--item->sync_locks == 0) startNext(item);
+	release(item->uid);
+}
+
 void PtrManager::dispose(long uid)
 {
 	if(datasets.count(uid)) dispose(datasets[uid]);
@@ -90,17 +313,81 @@ void PtrManager::dispose(PtrManagerDatasetItem* item)
 	#if GDAL_VERSION_MAJOR < 2
 	if(item->ptr_datasource) {
 		Dataset::datasource_cache.erase(item->ptr_datasource);
-		OGRDataSource::DestroyDataSource(item->ptr_datasource);
 	}
 	#endif
 	if(item->ptr){
 		Dataset::dataset_cache.erase(item->ptr);
+	}
+
+	// arrays backed by the dataset must not outlive it in JS
+	while(!item->mappings.empty()){
+		delete item->mappings.front();
+		item->mappings.pop_front();
+	}
+
+	if(item->async_jobs > 0) {
+		// jobs still hold raw pointers into the dataset
+		item->closing = true;
+		closing_datasets[item->uid] = item;
+		return;
+	}
+
+	close(item);
+}
+
+void PtrManager::close(PtrManagerDatasetItem* item)
+{
+	releaseResultSets(item);
+
+	if(item->pool){
+		delete item->pool;
+	}
+
+	#if GDAL_VERSION_MAJOR < 2
+	if(item->ptr_datasource) {
+		OGRDataSource::DestroyDataSource(item->ptr_datasource);
+	}
+	#endif
+	if(item->ptr){
 		GDALClose(item->ptr);
 	}
 
+	// only now that no handle reads from it; the file has a directory of its
+	// own, so sidecars written next to it (e.g. .aux.xml) go as well
+	if(!item->mem_file.empty()){
+		CPLString dir = CPLGetPath(item->mem_file.c_str());
+		char **files = VSIReadDir(dir);
+		for(char **file = files; file && *file; file++){
+			VSIUnlink(CPLFormFilename(dir, *file, NULL));
+		}
+		CSLDestroy(files);
+		VSIUnlink(item->mem_file.c_str());
+		VSIRmdir(dir);
+	}
+	if(item->buffer){
+		item->buffer->Reset();
+		delete item->buffer;
+	}
+
+	uv_cond_destroy(&item->async_idle);
+	uv_mutex_destroy(&item->async_lock);
 	delete item;
 }
 
+void PtrManager::releaseResultSets(PtrManagerDatasetItem* item)
+{
+	#if GDAL_VERSION_MAJOR < 2
+	OGRDataSource *ds = item->ptr_datasource;
+	#else
+	GDALDataset *ds = item->ptr;
+	#endif
+
+	while(!item->pending_result_sets.empty()){
+		ds->ReleaseResultSet(item->pending_result_sets.front());
+		item->pending_result_sets.pop_front();
+	}
+}
+
 void PtrManager::dispose(PtrManagerRasterBandItem* item)
 {
 	RasterBand::cache.erase(item->ptr);
@@ -115,14 +402,12 @@ void PtrManager::dispose(PtrManagerLayerItem* item)
 	layers.erase(item->uid);
 	item->parent->layers.remove(item);
 
-	#if GDAL_VERSION_MAJOR < 2
-	OGRDataSource *parent_ds = item->parent->ptr_datasource;
-	#else
-	GDALDataset *parent_ds = item->parent->ptr;
-	#endif
-
 	if (item->is_result_set) {
-		parent_ds->ReleaseResultSet(item->ptr);
+		// a job may be reading from it; released once the dataset is idle
+		item->parent->pending_result_sets.push_back(item->ptr);
+		if (item->parent->async_jobs == 0) {
+			releaseResultSets(item->parent);
+		}
 	}
 
 	delete item;
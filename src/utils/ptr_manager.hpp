@@ -4,6 +4,7 @@
 
 // node
 #include <node.h>
+#include <uv.h>
 
 // nan
 #pragma GCC diagnostic push
@@ -19,9 +20,16 @@
 
 #include <map>
 #include <list>
+#include <string>
 
 using namespace v8;
 
+namespace node_gdal {
+class DatasetPool;
+class DatasetJob;
+class VirtualMem;
+}
+
 struct PtrManagerDatasetItem;
 struct PtrManagerLayerItem {
 	long uid;
@@ -44,6 +52,26 @@ struct PtrManagerDatasetItem {
 	#if GDAL_VERSION_MAJOR < 2
 	OGRDataSource *ptr_datasource;
 	#endif
+	// async jobs and synchronous calls retaining the dataset
+	int async_jobs;
+	bool closing;
+	// jobs waiting for the dataset, in order, and the one holding it (main thread only)
+	std::list<node_gdal::DatasetJob*> pending_jobs;
+	node_gdal::DatasetJob *active_job;
+	// synchronous calls holding the dataset (main thread only)
+	int sync_locks;
+	// whether a job is running on the threadpool; set on the main thread when
+	// the job is started, cleared by the job when it's done
+	bool running;
+	uv_mutex_t async_lock;
+	uv_cond_t async_idle;
+	std::list<OGRLayer*> pending_result_sets;
+	node_gdal::DatasetPool *pool;
+	std::list<node_gdal::VirtualMem*> mappings;
+	// Buffer backing a dataset opened with gdal.openBuffer(), and the
+	// /vsimem file pointing into it
+	Nan::Persistent<Object> *buffer;
+	std::string mem_file;
 };
 
 namespace node_gdal {
@@ -61,6 +89,38 @@ public:
 	void dispose(long uid);
 	bool isAlive(long uid);
 
+	// bookkeeping for jobs running on the libuv threadpool (call from main thread only)
+	//
+	// While a dataset has jobs in flight, disposing it only detaches it from JS:
+	// result sets are released and the dataset is closed when the last job
+	// calls release().
+	long getDatasetUid(long uid);
+	PtrManagerDatasetItem* retain(long ds_uid);
+	void release(long ds_uid);
+
+	// scheduling of async jobs, see DatasetJob (call from main thread only)
+	void queueJob(DatasetJob *job);
+	void finishJob(DatasetJob *job);
+	// synchronous calls: waits for the job running on the dataset, if any,
+	// and keeps queued jobs from starting until unlockSync()
+	PtrManagerDatasetItem* lockSync(long uid);
+	void unlockSync(PtrManagerDatasetItem *item);
+
+	// extra handles for datasets opened with gdal.openPool()
+	DatasetPool* createPool(long ds_uid, const char *path, int size);
+	DatasetPool* getPool(long uid);
+
+	// memory mappings of a band's pixels, freed before the dataset is closed
+	VirtualMem* createMapping(long uid, GDALRasterBand *band, GDALRWFlag flag);
+	void disposeMapping(VirtualMem *mem);
+	bool hasMappings(long uid);
+	// whether [data, data + size) is part of a mapping of the dataset owning `uid`
+	bool isMapped(long uid, const void *data, size_t size);
+
+	// keeps the Buffer behind a /vsimem file alive until the dataset is
+	// closed, then unlinks the file
+	void attachBuffer(long ds_uid, Local<Object> buffer, const std::string &mem_file);
+
 	PtrManager();
 	~PtrManager();
 private:
@@ -68,9 +128,16 @@ private:
 	void dispose(PtrManagerLayerItem* item);
 	void dispose(PtrManagerRasterBandItem* item);
 	void dispose(PtrManagerDatasetItem* item);
+	void close(PtrManagerDatasetItem* item);
+	bool isReady(DatasetJob *job);
+	void startJob(DatasetJob *job);
+	void startNext(PtrManagerDatasetItem *item);
+	void startNext(DatasetPool *pool);
+	void releaseResultSets(PtrManagerDatasetItem* item);
 	std::map<long, PtrManagerLayerItem*> layers;
 	std::map<long, PtrManagerRasterBandItem*> bands;
 	std::map<long, PtrManagerDatasetItem*> datasets;
+	std::map<long, PtrManagerDatasetItem*> closing_datasets;
 };
 
 }
@@ -0,0 +1,391 @@
+#include "tile_generator.hpp"
+#include "chunk_scan.hpp"
+
+// gdal
+#include <cpl_string.h>
+#include <ogr_spatialref.h>
+
+#include <math.h>
+#include <map>
+#include <algorithm>
+
+namespace node_gdal {
+
+// half the width of the Web Mercator square, in meters
+static const double MERCATOR_EXTENT = 20037508.342789244;
+
+struct ZoomLevel {
+	int z;
+	int min_x, max_x;
+	int min_y, max_y;
+	GIntBig first_tile;
+	// overview to warp from, -1 for full resolution
+	int overview;
+};
+
+// each chunk is a tile
+struct TilePyramid : public ChunkScan {
+	GDALDataset *src;
+	const TileOptions *options;
+	GDALDriver *mem_driver;
+	std::string extension;
+	std::string mercator_wkt;
+	std::vector<ZoomLevel> zooms;
+	int n_color_bands;
+	int src_alpha_band;
+	bool dst_alpha;
+	std::vector<double> nodata;
+	// whether worker threads may open their own handle on the source file
+	bool reopen;
+
+	// guarded by the pyramid's lock
+	GIntBig written;
+	GIntBig skipped;
+
+	// held while warping from `src` by threads without their own handle
+	CPLMutex *src_mutex;
+};
+
+// a worker thread's view of the source
+struct TileReader {
+	GDALDataset *handle;
+	bool shared;
+	std::map<int, GDALDataset*> overviews;
+};
+
+static GDALDataset* readerDataset(TileReader &reader, int overview)
+{
+	if(overview < 0) return reader.handle;
+	std::map<int, GDALDataset*>::iterator it = reader.overviews.find(overview);
+	if(it != reader.overviews.end()) return it->second;
+	GDALDataset *ds = GDALCreateOverviewDataset(reader.handle, overview, FALSE, FALSE);
+	reader.overviews[overview] = ds;
+	return ds ? ds : reader.handle;
+}
+
+// warps one tile into `tile`, whose last band is the alpha band
+static CPLErr warpTile(TilePyramid *pyramid, GDALDataset *src, GDALDataset *tile)
+{
+	void *transformer = GDALCreateGenImgProjTransformer2((GDALDatasetH) src, (GDALDatasetH) tile, NULL);
+	if(!transformer) return CE_Failure;
+
+	int n = pyramid->n_color_bands;
+	GDALWarpOptions *wo = GDALCreateWarpOptions();
+	wo->hSrcDS = (GDALDatasetH) src;
+	wo->hDstDS = (GDALDatasetH) tile;
+	wo->eResampleAlg = pyramid->options->resampling;
+	wo->nBandCount = n;
+	wo->panSrcBands = (int *) CPLMalloc(sizeof(int) * n);
+	wo->panDstBands = (int *) CPLMalloc(sizeof(int) * n);
+	for(int i = 0; i < n; i++) {
+		wo->panSrcBands[i] = i + 1;
+		wo->panDstBands[i] = i + 1;
+	}
+	wo->nSrcAlphaBand = pyramid->src_alpha_band;
+	wo->nDstAlphaBand = n + 1;
+	if(!pyramid->nodata.empty()) {
+		wo->padfSrcNoDataReal = (double *) CPLMalloc(sizeof(double) * n);
+		wo->padfSrcNoDataImag = (double *) CPLCalloc(n, sizeof(double));
+		for(int i = 0; i < n; i++) wo->padfSrcNoDataReal[i] = pyramid->nodata[i];
+	}
+	wo->pfnTransformer = GDALGenImgProjTransform;
+	wo->pTransformerArg = transformer;
+
+	GDALWarpOperation operation;
+	CPLErr err = operation.Initialize(wo);
+	if(!err) {
+		err = operation.ChunkAndWarpImage(0, 0, tile->GetRasterXSize(), tile->GetRasterYSize());
+	}
+
+	GDALDestroyGenImgProjTransformer(transformer);
+	GDALDestroyWarpOptions(wo);
+	return err;
+}
+
+// creates `dir` and its missing parents; VSIMkdir() only creates the last level
+static bool makeDirectories(const CPLString &dir)
+{
+	VSIStatBufL stat;
+	if(dir.empty() || VSIStatL(dir, &stat) == 0) return true;
+	CPLString parent = CPLGetPath(dir);
+	if(parent != dir && !makeDirectories(parent)) return false;
+	// another thread may have created it in the meantime
+	return VSIMkdir(dir, 0755) == 0 || (VSIStatL(dir, &stat) == 0 && VSI_ISDIR(stat.st_mode));
+}
+
+// encodes `ds` in memory and writes it to `path`
+static CPLErr writeTile(TilePyramid *pyramid, GDALDataset *ds, const CPLString &mem_path, const CPLString &path)
+{
+	char **creation_options = NULL;
+	for(size_t i = 0; i < pyramid->options->creation_options.size(); i++) {
+		creation_options = CSLAddString(creation_options, pyramid->options->creation_options[i].c_str());
+	}
+	GDALDataset *encoded = pyramid->options->driver->CreateCopy(mem_path, ds, FALSE, creation_options, NULL, NULL);
+	CSLDestroy(creation_options);
+	if(!encoded) return CE_Failure;
+	GDALClose((GDALDatasetH) encoded);
+
+	// georeferencing doesn't fit in PNG / JPEG and ends up in a sidecar we don't want
+	VSIUnlink(CPLString(mem_path + ".aux.xml"));
+
+	vsi_l_offset length = 0;
+	GByte *data = VSIGetMemFileBuffer(mem_path, &length, TRUE);
+	if(!data) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Unable to encode tile %s", path.c_str());
+		return CE_Failure;
+	}
+
+	CPLErr err = CE_None;
+	VSILFILE *fp = VSIFOpenL(path, "wb");
+	if(!fp && makeDirectories(CPLGetPath(path))) {
+		// first tile of its column
+		fp = VSIFOpenL(path, "wb");
+	}
+	if(!fp || VSIFWriteL(data, 1, (size_t) length, fp) != (size_t) length) {
+		CPLError(CE_Failure, CPLE_FileIO, "Unable to write tile %s", path.c_str());
+		err = CE_Failure;
+	}
+	if(fp) VSIFCloseL(fp);
+	CPLFree(data);
+	return err;
+}
+
+// renders tile `index` of the pyramid; sets `written` unless it was skipped
+static CPLErr renderTile(TilePyramid *pyramid, TileReader &reader, GIntBig index, bool &written)
+{
+	const TileOptions &options = *pyramid->options;
+	size_t level = 0;
+	while(level + 1 < pyramid->zooms.size() && pyramid->zooms[level + 1].first_tile <= index) level++;
+	const ZoomLevel &zoom = pyramid->zooms[level];
+
+	int columns = zoom.max_x - zoom.min_x + 1;
+	int x = zoom.min_x + (int) ((index - zoom.first_tile) % columns);
+	int y = zoom.min_y + (int) ((index - zoom.first_tile) / columns);
+	int tiles_per_side = 1 << zoom.z;
+	int size = options.tile_size;
+
+	double span = 2 * MERCATOR_EXTENT / tiles_per_side;
+	double gt[6] = {-MERCATOR_EXTENT + x * span, span / size, 0, MERCATOR_EXTENT - y * span, 0, -span / size};
+
+	int n_bands = pyramid->n_color_bands + 1;
+	GDALDataset *tile = pyramid->mem_driver->Create("", size, size, n_bands, GDT_Byte, NULL);
+	if(!tile) return CE_Failure;
+	tile->SetGeoTransform(gt);
+	tile->SetProjection(pyramid->mercator_wkt.c_str());
+
+	CPLErr err;
+	if(reader.shared) lockMutex(pyramid->src_mutex);
+	err = warpTile(pyramid, readerDataset(reader, zoom.overview), tile);
+	if(reader.shared) CPLReleaseMutex(pyramid->src_mutex);
+
+	bool empty = false;
+	if(!err && options.skip_empty) {
+		std::vector<GByte> alpha((size_t) size * size);
+		err = tile->GetRasterBand(n_bands)->RasterIO(GF_Read, 0, 0, size, size, &alpha[0], size, size, GDT_Byte, 0, 0, NULL);
+		empty = std::find_if(alpha.begin(), alpha.end(), [](GByte a) { return a != 0; }) == alpha.end();
+	}
+
+	GDALDataset *out = tile;
+	if(!err && !empty && !pyramid->dst_alpha) {
+		// drop the alpha band for formats without transparency
+		out = pyramid->mem_driver->Create("", size, size, pyramid->n_color_bands, GDT_Byte, NULL);
+		if(!out) err = CE_Failure;
+		std::vector<GByte> data((size_t) size * size);
+		for(int i = 1; !err && i <= pyramid->n_color_bands; i++) {
+			err = tile->GetRasterBand(i)->RasterIO(GF_Read, 0, 0, size, size, &data[0], size, size, GDT_Byte, 0, 0, NULL);
+			if(!err) err = out->GetRasterBand(i)->RasterIO(GF_Write, 0, 0, size, size, &data[0], size, size, GDT_Byte, 0, 0, NULL);
+		}
+	}
+
+	written = false;
+	if(!err && !empty) {
+		int tile_y = options.tms ? tiles_per_side - 1 - y : y;
+		CPLString mem_path, path;
+		mem_path.Printf("/vsimem/node_gdal_tile_%p_%d_%d_%d.%s", &reader, zoom.z, x, tile_y, pyramid->extension.c_str());
+		path.Printf("%s/%d/%d/%d.%s", options.dir.c_str(), zoom.z, x, tile_y, pyramid->extension.c_str());
+		err = writeTile(pyramid, out, mem_path, path);
+		written = !err;
+	}
+
+	if(out && out != tile) GDALClose((GDALDatasetH) out);
+	GDALClose((GDALDatasetH) tile);
+	return err;
+}
+
+static void renderTiles(void *arg)
+{
+	TilePyramid *pyramid = (TilePyramid *) arg;
+
+	// a private handle lets this thread read without holding src_mutex
+	TileReader reader;
+	reader.handle = NULL;
+	if(pyramid->reopen) {
+		const char *drivers[] = {pyramid->src->GetDriver()->GetDescription(), NULL};
+		CPLPushErrorHandler(CPLQuietErrorHandler);
+		reader.handle = (GDALDataset *) GDALOpenEx(pyramid->src->GetDescription(), GDAL_OF_RASTER | GDAL_OF_READONLY, drivers, NULL, NULL);
+		CPLPopErrorHandler();
+	}
+	if(reader.handle && (reader.handle->GetRasterXSize() != pyramid->src->GetRasterXSize()
+		|| reader.handle->GetRasterYSize() != pyramid->src->GetRasterYSize()
+		|| reader.handle->GetRasterCount() != pyramid->src->GetRasterCount())) {
+		GDALClose((GDALDatasetH) reader.handle);
+		reader.handle = NULL;
+	}
+	reader.shared = reader.handle == NULL;
+	if(reader.shared) reader.handle = pyramid->src;
+
+	CPLErrorReset();
+	GIntBig index;
+	while(true) {
+		pyramid->lock();
+		if(!pyramid->next(index)) {
+			pyramid->unlock();
+			break;
+		}
+		pyramid->unlock();
+
+		bool written;
+		CPLErr err = renderTile(pyramid, reader, index, written);
+
+		pyramid->lock();
+		if(err) {
+			pyramid->failWithLastError();
+		} else {
+			if(written) pyramid->written++;
+			else pyramid->skipped++;
+			pyramid->done();
+		}
+		pyramid->unlock();
+	}
+
+	// overview datasets of the shared handle dereference it when closed
+	if(reader.shared) lockMutex(pyramid->src_mutex);
+	for(std::map<int, GDALDataset*>::iterator it = reader.overviews.begin(); it != reader.overviews.end(); it++) {
+		if(it->second) GDALClose((GDALDatasetH) it->second);
+	}
+	if(reader.shared) CPLReleaseMutex(pyramid->src_mutex);
+	else GDALClose((GDALDatasetH) reader.handle);
+}
+
+// picks the overview whose resolution is closest to, but not coarser than,
+// `ratio` times the full resolution (the same choice gdalwarp makes)
+static int pickOverview(GDALDataset *src, double ratio)
+{
+	GDALRasterBand *band = src->GetRasterBand(1);
+	int overview = -1;
+	for(int i = 0; i < band->GetOverviewCount(); i++) {
+		double factor = (double) src->GetRasterXSize() / band->GetOverview(i)->GetXSize();
+		if(factor <= ratio * 1.1) overview = i;
+	}
+	return overview;
+}
+
+CPLErr generateTiles(GDALDataset *src, const TileOptions &options, TileResult &result,
+                     GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	TilePyramid pyramid;
+	pyramid.src = src;
+	pyramid.options = &options;
+	pyramid.extension = EQUAL(options.driver->GetDescription(), "JPEG") ? "jpg" : "png";
+	pyramid.dst_alpha = !EQUAL(options.driver->GetDescription(), "JPEG");
+	pyramid.mem_driver = GetGDALDriverManager()->GetDriverByName("MEM");
+	if(!pyramid.mem_driver) {
+		CPLError(CE_Failure, CPLE_AppDefined, "MEM driver is not available");
+		return CE_Failure;
+	}
+
+	double src_gt[6];
+	const char *src_wkt = src->GetProjectionRef();
+	if(src->GetGeoTransform(src_gt) != CE_None || !src_wkt || !src_wkt[0]) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Source dataset must have a geotransform and a spatial reference");
+		return CE_Failure;
+	}
+
+	int count = src->GetRasterCount();
+	if(count < 1) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Source dataset has no raster bands");
+		return CE_Failure;
+	}
+	pyramid.src_alpha_band = 0;
+	if(count > 1 && src->GetRasterBand(count)->GetColorInterpretation() == GCI_AlphaBand) {
+		pyramid.src_alpha_band = count--;
+	}
+	pyramid.n_color_bands = count >= 3 ? 3 : 1;
+	for(int i = 1; i <= pyramid.n_color_bands; i++) {
+		int has_nodata = 0;
+		double nodata = src->GetRasterBand(i)->GetNoDataValue(&has_nodata);
+		if(!has_nodata) {
+			pyramid.nodata.clear();
+			break;
+		}
+		pyramid.nodata.push_back(nodata);
+	}
+
+	OGRSpatialReference mercator;
+	char *mercator_wkt = NULL;
+	if(mercator.importFromEPSG(3857) != OGRERR_NONE || mercator.exportToWkt(&mercator_wkt) != OGRERR_NONE) {
+		CPLFree(mercator_wkt);
+		CPLError(CE_Failure, CPLE_AppDefined, "Unable to create the Web Mercator spatial reference");
+		return CE_Failure;
+	}
+	pyramid.mercator_wkt = mercator_wkt;
+	CPLFree(mercator_wkt);
+
+	// extent and native resolution of the source in Web Mercator
+	void *transformer = GDALCreateGenImgProjTransformer((GDALDatasetH) src, src_wkt, NULL, pyramid.mercator_wkt.c_str(), FALSE, 0, 1);
+	if(!transformer) return CE_Failure;
+	double suggested_gt[6], extent[4];
+	int pixels, lines;
+	CPLErr err = GDALSuggestedWarpOutput2((GDALDatasetH) src, GDALGenImgProjTransform, transformer, suggested_gt, &pixels, &lines, extent, 0);
+	GDALDestroyGenImgProjTransformer(transformer);
+	if(err) return err;
+
+	pyramid.n_chunks = 0;
+	for(int z = options.min_zoom; z <= options.max_zoom; z++) {
+		int tiles_per_side = 1 << z;
+		double span = 2 * MERCATOR_EXTENT / tiles_per_side;
+		ZoomLevel zoom;
+		zoom.z = z;
+		zoom.min_x = std::max(0, (int) floor((extent[0] + MERCATOR_EXTENT) / span));
+		zoom.max_x = std::min(tiles_per_side - 1, (int) ceil((extent[2] + MERCATOR_EXTENT) / span) - 1);
+		zoom.min_y = std::max(0, (int) floor((MERCATOR_EXTENT - extent[3]) / span));
+		zoom.max_y = std::min(tiles_per_side - 1, (int) ceil((MERCATOR_EXTENT - extent[1]) / span) - 1);
+		if(zoom.min_x > zoom.max_x || zoom.min_y > zoom.max_y) continue;
+		zoom.first_tile = pyramid.n_chunks;
+		zoom.overview = pickOverview(src, span / options.tile_size / suggested_gt[1]);
+		pyramid.n_chunks += (GIntBig) (zoom.max_x - zoom.min_x + 1) * (zoom.max_y - zoom.min_y + 1);
+		pyramid.zooms.push_back(zoom);
+	}
+
+	// only a file can be reopened as the same dataset: the description of
+	// e.g. a MEM or in-memory VRT dataset may name an unrelated file
+	VSIStatBufL stat;
+	pyramid.reopen = src->GetDriver() && !EQUAL(src->GetDriver()->GetDescription(), "MEM")
+		&& VSIStatExL(src->GetDescription(), &stat, VSI_STAT_EXISTS_FLAG | VSI_STAT_NATURE_FLAG) == 0
+		&& VSI_ISREG(stat.st_mode);
+
+	// threads with their own handle must see everything written so far
+	src->FlushCache();
+
+	pyramid.written = 0;
+	pyramid.skipped = 0;
+	if(pfnProgress) pyramid.pfnProgress = pfnProgress;
+	pyramid.pProgressArg = pProgressArg;
+	pyramid.src_mutex = CPLCreateMutex();
+	CPLReleaseMutex(pyramid.src_mutex);
+
+	pyramid.run(renderTiles, &pyramid, options.threads);
+
+	CPLDestroyMutex(pyramid.src_mutex);
+
+	result.written = pyramid.written;
+	result.skipped = pyramid.skipped;
+
+	err = pyramid.error();
+	if(err) return err;
+
+	pyramid.pfnProgress(1.0, NULL, pyramid.pProgressArg);
+	return CE_None;
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef __TILE_GENERATOR_H__
+#define __TILE_GENERATOR_H__
+
+// gdal
+#include <gdal_priv.h>
+#include <gdalwarper.h>
+
+#include <string>
+#include <vector>
+
+namespace node_gdal {
+
+struct TileOptions {
+	std::string dir;
+	int min_zoom;
+	int max_zoom;
+	int tile_size;
+	// "PNG" or "JPEG"
+	GDALDriver *driver;
+	std::vector<std::string> creation_options;
+	GDALResampleAlg resampling;
+	// TMS numbering (rows counted from the bottom) instead of XYZ
+	bool tms;
+	// don't write tiles the source doesn't cover at all
+	bool skip_empty;
+	int threads;
+};
+
+struct TileResult {
+	GIntBig written;
+	GIntBig skipped;
+};
+
+// Renders a Web Mercator tile pyramid of `src` to `dir/z/x/y.(png|jpg)`.
+//
+// Tiles are handed out one at a time from a shared counter to a CPL worker
+// pool, so threads that finish early keep taking work until none is left.
+// Each tile is warped from the overview closest to its resolution (as
+// gdalwarp would pick it) into a MEM dataset, encoded with CreateCopy() into
+// /vsimem and written to disk with a single write.
+//
+// Worker threads read the source through their own handle when it is a file
+// that reopens (with the same driver) as a dataset of the same shape;
+// otherwise (e.g. MEM datasets) warping reads the shared dataset one tile at
+// a time and only encoding runs in parallel. Directories are created as
+// tiles are written.
+//
+// The first 1 or 3 bands of the source are used (clamped to Byte), plus its
+// alpha band; PNG tiles get an alpha band marking the area the source covers.
+//
+// Must be called with the dataset lock held.
+
+CPLErr generateTiles(GDALDataset *src, const TileOptions &options, TileResult &result,
+                     GDALProgressFunc pfnProgress, void *pProgressArg);
+
+}
+
+#endif
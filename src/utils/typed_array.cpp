@@ -4,85 +4,76 @@
 
 namespace node_gdal {
 
-//https://github.com/joyent/node/issues/4201#issuecomment-9837340
-
+// Arrays are created directly through the V8 API: the backing store comes from
+// node's ArrayBuffer allocator and no constructors are looked up in JS land.
 Local<Value> TypedArray::New(GDALDataType type, unsigned int length)  {
 	Nan::EscapableHandleScope scope;
 
-	Local<Value> val;
-	Local<Function> constructor;
-	Local<Object> global = Nan::GetCurrentContext()->Global();
+	size_t bytes_per_element = GDALGetDataTypeSize(type) / 8;
+	Local<ArrayBuffer> buffer;
 
-	const char *name;
 	switch(type) {
-		case GDT_Byte:    name = "Uint8Array";   break;
-		case GDT_Int16:   name = "Int16Array";   break;
-		case GDT_UInt16:  name = "Uint16Array";  break;
-		case GDT_Int32:   name = "Int32Array";   break;
-		case GDT_UInt32:  name = "Uint32Array";  break;
-		case GDT_Float32: name = "Float32Array"; break;
-		case GDT_Float64: name = "Float64Array"; break;
-		default: 
-			Nan::ThrowError("Unsupported array type"); 
+		case GDT_Byte:
+		case GDT_Int16:
+		case GDT_UInt16:
+		case GDT_Int32:
+		case GDT_UInt32:
+		case GDT_Float32:
+		case GDT_Float64:
+			buffer = ArrayBuffer::New(v8::Isolate::GetCurrent(), (size_t) length * bytes_per_element);
+			break;
+		default:
+			Nan::ThrowError("Unsupported array type");
 			return scope.Escape(Nan::Undefined());
 	}
 
-
-	// make ArrayBuffer
-	val = global->Get(Nan::New("ArrayBuffer").ToLocalChecked());
-
-	if(val.IsEmpty() || !val->IsFunction()) {
-		Nan::ThrowError("Error getting ArrayBuffer constructor");
-		return scope.Escape(Nan::Undefined());
-	}
-
-	constructor = val.As<Function>();
-	Local<Value> size = Nan::New<Integer>(length * GDALGetDataTypeSize(type) / 8);
-	Local<Value> array_buffer = Nan::NewInstance(constructor, 1, &size).ToLocalChecked();
-
-	if(array_buffer.IsEmpty() || !array_buffer->IsObject()) {
+	if(buffer.IsEmpty()) {
 		Nan::ThrowError("Error allocating ArrayBuffer");
 		return scope.Escape(Nan::Undefined());
 	}
 
+	return scope.Escape(TypedArray::New(type, buffer, length));
+}
 
-	// make TypedArray
-	val = global->Get(Nan::New(name).ToLocalChecked());
-
-	if(val.IsEmpty() || !val->IsFunction()) {
-		Nan::ThrowError("Error getting typed array constructor");
-		return scope.Escape(Nan::Undefined());
-	}
-
-	constructor = val.As<Function>();
-	Local<Object> array = Nan::NewInstance(constructor, 1, &array_buffer).ToLocalChecked();
+// A view over an existing buffer; `type` must be one of the types handled above
+Local<Value> TypedArray::New(GDALDataType type, Local<ArrayBuffer> buffer, size_t length)  {
+	Nan::EscapableHandleScope scope;
 
-	if(array.IsEmpty() || !array->IsObject()) {
-		Nan::ThrowError("Error creating TypedArray");
-		return scope.Escape(Nan::Undefined());
+	Local<Value> array;
+	switch(type) {
+		case GDT_Byte:    array = Uint8Array::New(buffer, 0, length);   break;
+		case GDT_Int16:   array = Int16Array::New(buffer, 0, length);   break;
+		case GDT_UInt16:  array = Uint16Array::New(buffer, 0, length);  break;
+		case GDT_Int32:   array = Int32Array::New(buffer, 0, length);   break;
+		case GDT_UInt32:  array = Uint32Array::New(buffer, 0, length);  break;
+		case GDT_Float32: array = Float32Array::New(buffer, 0, length); break;
+		default:          array = Float64Array::New(buffer, 0, length); break;
 	}
 
-	array->Set(Nan::New("_gdal_type").ToLocalChecked(), Nan::New(type));
-
 	return scope.Escape(array);
 }
 
-GDALDataType TypedArray::Identify(Local<Object> obj) {
-	Nan::HandleScope scope;
-
-	Local<String> sym = Nan::New("_gdal_type").ToLocalChecked();
-	if (!Nan::HasOwnProperty(obj, sym).FromMaybe(false)) return GDT_Unknown;
-	Local<Value> val = obj->Get(sym);
-	if (!val->IsNumber()) return GDT_Unknown;
-
-	return (GDALDataType) val->Int32Value();
+GDALDataType TypedArray::Identify(Local<Object> obj, GDALDataType view_type) {
+	// Buffers are Uint8Arrays and Uint8ClampedArrays hold the same unsigned
+	// bytes (clamping only applies to assignments from JS); GDAL has no signed
+	// 8-bit type, so Int8Arrays are rejected. A DataView has no element type
+	// of its own.
+	if (obj->IsUint8Array() || obj->IsUint8ClampedArray()) return GDT_Byte;
+	if (obj->IsInt16Array())   return GDT_Int16;
+	if (obj->IsUint16Array())  return GDT_UInt16;
+	if (obj->IsInt32Array())   return GDT_Int32;
+	if (obj->IsUint32Array())  return GDT_UInt32;
+	if (obj->IsFloat32Array()) return GDT_Float32;
+	if (obj->IsFloat64Array()) return GDT_Float64;
+	if (obj->IsDataView())     return view_type;
+	return GDT_Unknown;
 }
 
 void* TypedArray::Validate(Local<Object> obj, GDALDataType type, int min_length){
 	//validate array
 	Nan::HandleScope scope;
 
-	GDALDataType src_type = TypedArray::Identify(obj);
+	GDALDataType src_type = TypedArray::Identify(obj, type);
 	if(src_type == GDT_Unknown) {
 		Nan::ThrowTypeError("Unable to identify GDAL datatype of passed array object");
 		return NULL;
@@ -96,46 +87,26 @@ void* TypedArray::Validate(Local<Object> obj, GDALDataType type, int min_length)
 		Nan::ThrowTypeError(ss.str().c_str());
 		return NULL;
 	}
-	switch(type) {
-		case GDT_Byte: {
-			Nan::TypedArrayContents<GByte> contents(obj);
-			if(ValidateLength(contents.length(), min_length)) return NULL;
-			return *contents;
-		}
-		case GDT_Int16: {
-			Nan::TypedArrayContents<GInt16> contents(obj); 
-			if(ValidateLength(contents.length(), min_length)) return NULL;
-			return *contents;
-		}
-		case GDT_UInt16: {
-			Nan::TypedArrayContents<GUInt16> contents(obj); 
-			if(ValidateLength(contents.length(), min_length)) return NULL;
-			return *contents;
-		}
-		case GDT_Int32: {
-			Nan::TypedArrayContents<GInt32> contents(obj); 
-			if(ValidateLength(contents.length(), min_length)) return NULL;
-			return *contents;
-		}
-		case GDT_UInt32: {
-			Nan::TypedArrayContents<GUInt32> contents(obj); 
-			if(ValidateLength(contents.length(), min_length)) return NULL;
-			return *contents;
-		}
-		case GDT_Float32: {
-			Nan::TypedArrayContents<float> contents(obj); 
-			if(ValidateLength(contents.length(), min_length)) return NULL;
-			return *contents;
-		}
-		case GDT_Float64: {
-			Nan::TypedArrayContents<double> contents(obj); 
-			if(ValidateLength(contents.length(), min_length)) return NULL;
-			return *contents;
-		}
-		default:
-			Nan::ThrowError("Unsupported array type"); 
-			return NULL;
+
+	int bytes_per_element = GDALGetDataTypeSize(type) / 8;
+	if(bytes_per_element == 0) {
+		Nan::ThrowError("Unsupported array type");
+		return NULL;
+	}
+
+	// works the same for views on an ArrayBuffer or a SharedArrayBuffer
+	Nan::TypedArrayContents<GByte> contents(obj);
+	if(!*contents && contents.length() > 0) {
+		Nan::ThrowError("Unable to access array data");
+		return NULL;
 	}
+	if(reinterpret_cast<uintptr_t>(*contents) % bytes_per_element != 0) {
+		Nan::ThrowError("Array data must be aligned to the size of the data type");
+		return NULL;
+	}
+	if(ValidateLength(contents.length() / bytes_per_element, min_length)) return NULL;
+
+	return *contents;
 }
 bool TypedArray::ValidateLength(int length, int min_length){
 	if(length < min_length) {
@@ -49,7 +49,9 @@ namespace node_gdal {
 namespace TypedArray {
 
 	Local<Value> New(GDALDataType type, unsigned int length);
-	GDALDataType Identify(Local<Object> array);
+	Local<Value> New(GDALDataType type, Local<ArrayBuffer> buffer, size_t length);
+	// `view_type` is returned for DataViews, which don't carry an element type
+	GDALDataType Identify(Local<Object> array, GDALDataType view_type = GDT_Unknown);
 	void* Validate(Local<Object> obj, GDALDataType type, int min_length);
 	bool ValidateLength(int length, int min_length);
 }
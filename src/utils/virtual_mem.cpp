@@ -0,0 +1,191 @@
+#include "virtual_mem.hpp"
+#include "typed_array.hpp"
+#include "../gdal_common.hpp"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace node_gdal {
+
+#ifdef __linux__
+// Finds the file (path and inode) and the offset in it that are mapped at
+// `addr` in this process
+static bool findFileMapping(const void *addr, std::string &path, unsigned long long &inode, unsigned long long &offset)
+{
+	FILE *maps = fopen("/proc/self/maps", "r");
+	if(!maps) return false;
+
+	unsigned long long a = (unsigned long long) (size_t) addr;
+	char line[PATH_MAX + 256];
+	bool found = false;
+	while(!found && fgets(line, sizeof(line), maps)) {
+		unsigned long long start, end, file_offset;
+		int path_pos = 0;
+		if(sscanf(line, "%llx-%llx %*s %llx %*s %llu %n", &start, &end, &file_offset, &inode, &path_pos) < 4 || !path_pos) continue;
+		if(a < start || a >= end) continue;
+
+		path = line + path_pos;
+		while(!path.empty() && (path[path.size() - 1] == '\n' || path[path.size() - 1] == ' ')) {
+			path.erase(path.size() - 1);
+		}
+		offset = file_offset + (a - start);
+		found = !path.empty() && path[0] == '/';
+	}
+	fclose(maps);
+	return found;
+}
+
+// Maps the file range behind the read-only mapping at `addr` again, this time
+// private and writable
+static void* mapPrivate(const void *addr, size_t size, void **base, size_t *base_size)
+{
+	std::string path;
+	unsigned long long inode, offset;
+	if(!findFileMapping(addr, path, inode, offset)) return NULL;
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) return NULL;
+
+	struct stat st;
+	void *p = MAP_FAILED;
+	size_t page = CPLGetPageSize();
+	size_t delta = (size_t) (offset % page);
+	// the file may have been replaced since GDAL mapped it
+	if(fstat(fd, &st) == 0 && (unsigned long long) st.st_ino == inode) {
+		p = mmap(NULL, size + delta, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t) (offset - delta));
+	}
+	close(fd);
+	if(p == MAP_FAILED) return NULL;
+
+	*base = p;
+	*base_size = size + delta;
+	return (GByte*) p + delta;
+}
+#endif
+
+VirtualMem::VirtualMem(long ds_uid, GDALRasterBand *band)
+	: ds_uid(ds_uid), vmem(NULL), private_base(NULL), private_size(0), addr(NULL),
+	  type(band->GetRasterDataType()), type_size(GDALGetDataTypeSize(band->GetRasterDataType()) / 8),
+	  length((size_t) band->GetXSize() * band->GetYSize()), buffer()
+{}
+
+VirtualMem::~VirtualMem()
+{
+	if(!buffer.IsEmpty()) {
+		Nan::HandleScope scope;
+		Nan::New(buffer)->Neuter();
+		buffer.Reset();
+	}
+	if(vmem) CPLVirtualMemFree(vmem);
+	#ifdef __linux__
+	if(private_base) munmap(private_base, private_size);
+	#endif
+}
+
+VirtualMem* VirtualMem::New(long ds_uid, GDALRasterBand *band, GDALRWFlag flag)
+{
+	#ifndef __linux__
+	CPLError(CE_Failure, CPLE_NotSupported, "Memory mapping is only supported on Linux");
+	return NULL;
+	#else
+	VirtualMem *mem = new VirtualMem(ds_uid, band);
+
+	switch(mem->type) {
+		case GDT_Byte:
+		case GDT_Int16:
+		case GDT_UInt16:
+		case GDT_Int32:
+		case GDT_UInt32:
+		case GDT_Float32:
+		case GDT_Float64:
+			break;
+		default:
+			CPLError(CE_Failure, CPLE_NotSupported, "Unsupported band data type: %s", GDALGetDataTypeName(mem->type));
+			delete mem;
+			return NULL;
+	}
+	if(mem->length > INT_MAX) {
+		CPLError(CE_Failure, CPLE_NotSupported, "Band is too large to be mapped into a single array");
+		delete mem;
+		return NULL;
+	}
+
+	int pixel_space;
+	GIntBig line_space;
+	CPLVirtualMem *vmem = band->GetVirtualMemAuto(flag, &pixel_space, &line_space, NULL);
+
+	if(vmem && !CPLVirtualMemIsFileMapping(vmem)) {
+		// GDAL fell back to emulating the mapping with page faults, which
+		// installed its process-wide SIGSEGV handler; undo both
+		CPLVirtualMemFree(vmem);
+		CPLVirtualMemManagerTerminate();
+		vmem = NULL;
+	}
+	if(vmem && !(pixel_space == mem->type_size && line_space == (GIntBig) band->GetXSize() * mem->type_size)) {
+		// interleaved files can't be viewed as a single typed array
+		CPLVirtualMemFree(vmem);
+		vmem = NULL;
+	}
+	if(!vmem) {
+		CPLErrorReset();
+		CPLError(CE_Failure, CPLE_NotSupported, "Band can't be mapped from its file: it must be stored raw, uncompressed and in native byte order");
+		delete mem;
+		return NULL;
+	}
+
+	if(flag == GF_Write) {
+		mem->vmem = vmem;
+		mem->addr = CPLVirtualMemGetAddr(vmem);
+		return mem;
+	}
+
+	mem->addr = mapPrivate(CPLVirtualMemGetAddr(vmem), mem->length * mem->type_size, &mem->private_base, &mem->private_size);
+	CPLVirtualMemFree(vmem);
+	if(!mem->addr) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Error mapping band into memory");
+		delete mem;
+		return NULL;
+	}
+	return mem;
+	#endif
+}
+
+bool VirtualMem::overlaps(const void *data, size_t size)
+{
+	const GByte *start = (const GByte*) addr;
+	const GByte *end = start + length * type_size;
+	return (const GByte*) data < end && (const GByte*) data + size > start;
+}
+
+Local<Value> VirtualMem::array()
+{
+	Nan::EscapableHandleScope scope;
+
+	Local<ArrayBuffer> ab;
+	if(buffer.IsEmpty()) {
+		ab = ArrayBuffer::New(v8::Isolate::GetCurrent(), addr, length * type_size);
+		buffer.Reset(ab);
+		buffer.SetWeak(this, VirtualMem::weakCallback, Nan::WeakCallbackType::kParameter);
+	} else {
+		ab = Nan::New(buffer);
+	}
+
+	return scope.Escape(TypedArray::New(type, ab, length));
+}
+
+void VirtualMem::weakCallback(const Nan::WeakCallbackInfo<VirtualMem> &data)
+{
+	VirtualMem *mem = data.GetParameter();
+	mem->buffer.Reset();
+	ptr_manager.disposeMapping(mem);
+}
+
+}
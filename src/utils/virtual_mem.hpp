@@ -0,0 +1,87 @@
+#ifndef __NODE_GDAL_VIRTUAL_MEM_H__
+#define __NODE_GDAL_VIRTUAL_MEM_H__
+
+// node
+#include <node.h>
+
+// nan
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <nan.h>
+#pragma GCC diagnostic pop
+
+// gdal
+#include <gdal_priv.h>
+#include <cpl_virtualmem.h>
+
+using namespace v8;
+
+namespace node_gdal {
+
+// A band's pixels memory-mapped from its file and exposed to JS as a TypedArray.
+//
+// Only bands stored raw in native byte order with the array's layout (e.g.
+// uncompressed GeoTIFF, ENVI, EHdr) can be mapped; GDAL's page-fault emulation
+// for other bands is never used. "r+" mappings are shared with the file.
+// "r" mappings are private copy-on-write mappings of the same pages, so writes
+// from JS only change the process's copy instead of faulting.
+//
+// Mappings are owned by the PtrManager item of their dataset. The ArrayBuffer
+// is neutered and the mapping freed when the dataset is disposed, or when the
+// ArrayBuffer is garbage collected, whichever comes first. Freeing a mapping
+// only unmaps memory; it never calls into the dataset.
+
+class VirtualMem {
+public:
+	// main thread, with the dataset lock held: returns NULL with a CPL error set on failure
+	static VirtualMem* New(long ds_uid, GDALRasterBand *band, GDALRWFlag flag);
+	~VirtualMem();
+
+	// main thread: a view over the whole mapping, created on first use
+	Local<Value> array();
+	// whether [data, data + size) overlaps the mapped pixels
+	bool overlaps(const void *data, size_t size);
+
+	long ds_uid;
+
+private:
+	VirtualMem(long ds_uid, GDALRasterBand *band);
+
+	static void weakCallback(const Nan::WeakCallbackInfo<VirtualMem> &data);
+
+	// "r+": GDAL's shared mapping
+	CPLVirtualMem *vmem;
+	// "r": our private mapping, starting at the page containing `addr`
+	void *private_base;
+	size_t private_size;
+
+	void *addr;
+	GDALDataType type;
+	int type_size;
+	size_t length;
+	Nan::Persistent<ArrayBuffer> buffer;
+};
+
+// Keeps GDAL's block cache coherent with the mappings of a dataset for the
+// duration of one transfer: cached blocks are dropped before it (they may
+// predate writes through a mapping) and written to the file after it (so
+// mappings see the new pixels). A no-op unless `mapped` is set.
+
+template<class T>
+class MappingSync {
+public:
+	MappingSync(T *obj, bool mapped) : obj(mapped ? obj : NULL)
+	{
+		if(this->obj) this->obj->FlushCache();
+	}
+	~MappingSync()
+	{
+		if(obj) obj->FlushCache();
+	}
+private:
+	T *obj;
+};
+
+}
+
+#endif
@@ -0,0 +1,390 @@
+#include "zonal_stats.hpp"
+#include "chunk_scan.hpp"
+
+// gdal
+#include <gdal_alg.h>
+#include <cpl_quad_tree.h>
+#include <ogr_spatialref.h>
+
+#include <math.h>
+#include <algorithm>
+
+namespace node_gdal {
+
+struct ZonalScan : public ChunkScan {
+	GDALRasterBand *band;
+	GDALDriver *mem_driver;
+	const ZonalStatsOptions *options;
+	std::vector<OGRGeometry*> geometries;
+	// pixel window of each geometry, grown by a pixel on every side and
+	// clipped to the raster; empty for geometries outside of it
+	std::vector<CPLRectObj> windows;
+	// of the non-empty windows
+	CPLQuadTree *index;
+	double geo_transform[6];
+	int width;
+	int height;
+	int chunk_rows;
+	bool has_nodata;
+	double nodata;
+	double hist_scale;
+
+	// guarded by the scan's lock
+	std::vector<ZoneStats> *zones;
+};
+
+static void initZones(std::vector<ZoneStats> &zones, size_t n, const ZonalStatsOptions &options)
+{
+	ZoneStats empty;
+	empty.fid = OGRNullFID;
+	empty.count = 0;
+	empty.sum = 0;
+	empty.min = INFINITY;
+	empty.max = -INFINITY;
+	if(options.histogram) empty.histogram.assign(options.buckets, 0);
+	zones.assign(n, empty);
+}
+
+static void getWindow(const void *feature, CPLRectObj *bounds)
+{
+	*bounds = *(const CPLRectObj *) feature;
+}
+
+static bool isEmpty(const CPLRectObj &rect)
+{
+	return rect.minx >= rect.maxx || rect.miny >= rect.maxy;
+}
+
+static CPLRectObj rasterBounds(const ZonalScan *scan)
+{
+	CPLRectObj bounds;
+	bounds.minx = 0;
+	bounds.miny = 0;
+	bounds.maxx = scan->width;
+	bounds.maxy = scan->height;
+	return bounds;
+}
+
+// windows of the geometries in `index` overlapping `rect`, in layer order
+static void searchWindows(const ZonalScan *scan, CPLQuadTree *index, const CPLRectObj &rect, std::vector<size_t> &found)
+{
+	int count = 0;
+	void **features = CPLQuadTreeSearch(index, &rect, &count);
+	found.clear();
+	for(int i = 0; i < count; i++) {
+		found.push_back((const CPLRectObj *) features[i] - &scan->windows[0]);
+	}
+	CPLFree(features);
+	std::sort(found.begin(), found.end());
+}
+
+// Splits the geometries overlapping rows [y, y + rows) into groups whose
+// windows don't overlap, so that no pixel is claimed by two geometries of a
+// group. Windows are a pixel larger than the geometries, so not even
+// ALL_TOUCHED can make them share a pixel.
+static void groupChunk(const ZonalScan *scan, int y, int rows, std::vector<std::vector<size_t> > &groups)
+{
+	CPLRectObj chunk = rasterBounds(scan);
+	chunk.miny = y;
+	chunk.maxy = y + rows;
+
+	std::vector<size_t> candidates, conflicts;
+	searchWindows(scan, scan->index, chunk, candidates);
+
+	CPLRectObj bounds = rasterBounds(scan);
+	std::vector<CPLQuadTree*> group_index;
+	groups.clear();
+	for(size_t i = 0; i < candidates.size(); i++) {
+		const CPLRectObj &window = scan->windows[candidates[i]];
+		size_t g = 0;
+		for(; g < groups.size(); g++) {
+			searchWindows(scan, group_index[g], window, conflicts);
+			if(conflicts.empty()) break;
+		}
+		if(g == groups.size()) {
+			groups.push_back(std::vector<size_t>());
+			group_index.push_back(CPLQuadTreeCreate(&bounds, getWindow));
+		}
+		groups[g].push_back(candidates[i]);
+		CPLQuadTreeInsert(group_index[g], (void *) &window);
+	}
+
+	for(size_t g = 0; g < group_index.size(); g++) {
+		CPLQuadTreeDestroy(group_index[g]);
+	}
+}
+
+// a MEM dataset of rows [y, y + rows) wrapping the zone id buffer `ids`
+static GDALDataset* createChunkDataset(ZonalScan *scan, int y, int rows, std::vector<GInt32> &ids)
+{
+	const double *gt = scan->geo_transform;
+	double chunk_gt[6] = {gt[0] + y * gt[2], gt[1], gt[2], gt[3] + y * gt[5], gt[4], gt[5]};
+
+	GDALDataset *ds = scan->mem_driver->Create("", scan->width, rows, 0, GDT_Int32, NULL);
+	if(!ds) return NULL;
+
+	char pointer[64];
+	char **band_options = NULL;
+	pointer[CPLPrintPointer(pointer, &ids[0], sizeof(pointer))] = '\0';
+	band_options = CSLSetNameValue(band_options, "DATAPOINTER", pointer);
+	CPLErr err = ds->AddBand(GDT_Int32, band_options);
+	CSLDestroy(band_options);
+
+	if(!err) err = ds->SetGeoTransform(chunk_gt);
+	if(err) {
+		GDALClose((GDALDatasetH) ds);
+		return NULL;
+	}
+	return ds;
+}
+
+// burns the 1-based index of every geometry of `group` into `ids`
+static CPLErr rasterizeGroup(ZonalScan *scan, GDALDataset *ds, const std::vector<size_t> &group, std::vector<GInt32> &ids)
+{
+	std::vector<OGRGeometryH> geometries;
+	std::vector<double> burn_values;
+	for(size_t i = 0; i < group.size(); i++) {
+		geometries.push_back((OGRGeometryH) scan->geometries[group[i]]);
+		burn_values.push_back((double) (group[i] + 1));
+	}
+
+	std::fill(ids.begin(), ids.end(), 0);
+
+	int band_id = 1;
+	char **rasterize_options = NULL;
+	if(scan->options->all_touched) rasterize_options = CSLSetNameValue(rasterize_options, "ALL_TOUCHED", "TRUE");
+	CPLErr err = GDALRasterizeGeometries((GDALDatasetH) ds, 1, &band_id, (int) geometries.size(), &geometries[0],
+	                                     NULL, NULL, &burn_values[0], rasterize_options, NULL, NULL);
+	CSLDestroy(rasterize_options);
+	if(!err) ds->FlushCache();
+	return err;
+}
+
+static void accumulate(const ZonalScan *scan, const double *values, const GInt32 *ids, size_t n, std::vector<ZoneStats> &zones)
+{
+	const ZonalStatsOptions &options = *scan->options;
+
+	for(size_t i = 0; i < n; i++) {
+		GInt32 id = ids[i];
+		double v = values[i];
+		if(!id || v != v || (scan->has_nodata && v == scan->nodata)) continue;
+
+		ZoneStats &zone = zones[id - 1];
+		zone.count++;
+		zone.sum += v;
+		zone.min = v < zone.min ? v : zone.min;
+		zone.max = v > zone.max ? v : zone.max;
+		if(options.histogram && v >= options.hist_min && v <= options.hist_max) {
+			int b = (int) ((v - options.hist_min) * scan->hist_scale);
+			zone.histogram[b < options.buckets ? b : options.buckets - 1]++;
+		}
+	}
+}
+
+static void scanChunks(void *arg)
+{
+	ZonalScan *scan = (ZonalScan *) arg;
+	size_t max_pixels = (size_t) scan->width * scan->chunk_rows;
+	std::vector<double> values(max_pixels);
+	std::vector<GInt32> ids;
+	std::vector<std::vector<size_t> > groups;
+	std::vector<ZoneStats> zones;
+	initZones(zones, scan->geometries.size(), *scan->options);
+
+	CPLErrorReset();
+	GIntBig chunk;
+	while(true) {
+		scan->lock();
+		if(!scan->next(chunk)) {
+			scan->unlock();
+			break;
+		}
+		int y = (int) chunk * scan->chunk_rows;
+		int rows = std::min(scan->chunk_rows, scan->height - y);
+		size_t n = (size_t) scan->width * rows;
+		scan->unlock();
+
+		groupChunk(scan, y, rows, groups);
+		if(!groups.empty()) {
+			scan->lock();
+			CPLErr err = scan->band->RasterIO(GF_Read, 0, y, scan->width, rows, &values[0], scan->width, rows, GDT_Float64, 0, 0, NULL);
+			if(err) {
+				scan->failWithLastError();
+				scan->unlock();
+				break;
+			}
+			scan->unlock();
+
+			// rasterizing only touches this thread's MEM dataset, so it runs unlocked
+			ids.resize(n);
+			GDALDataset *ds = createChunkDataset(scan, y, rows, ids);
+			err = ds ? CE_None : CE_Failure;
+			for(size_t g = 0; !err && g < groups.size(); g++) {
+				err = rasterizeGroup(scan, ds, groups[g], ids);
+				if(!err) accumulate(scan, &values[0], &ids[0], n, zones);
+			}
+			if(ds) GDALClose((GDALDatasetH) ds);
+			if(err) {
+				scan->lock();
+				scan->failWithLastError();
+				scan->unlock();
+				break;
+			}
+		}
+
+		scan->lock();
+		scan->done();
+		scan->unlock();
+	}
+
+	scan->lock();
+	for(size_t i = 0; i < zones.size(); i++) {
+		ZoneStats &total = (*scan->zones)[i];
+		total.count += zones[i].count;
+		total.sum += zones[i].sum;
+		total.min = std::min(total.min, zones[i].min);
+		total.max = std::max(total.max, zones[i].max);
+		for(size_t b = 0; b < total.histogram.size(); b++) total.histogram[b] += zones[i].histogram[b];
+	}
+	scan->unlock();
+}
+
+// reads every geometry of the layer, in the raster's SRS when both are known
+static CPLErr readGeometries(OGRLayer *layer, GDALRasterBand *band, ZonalScan *scan, std::vector<GIntBig> &fids)
+{
+	OGRCoordinateTransformation *ct = NULL;
+	OGRSpatialReference *layer_srs = layer->GetSpatialRef();
+	const char *wkt = band->GetDataset() ? band->GetDataset()->GetProjectionRef() : "";
+	if(layer_srs && wkt && wkt[0]) {
+		OGRSpatialReference raster_srs(wkt);
+		if(!raster_srs.IsSame(layer_srs)) {
+			ct = OGRCreateCoordinateTransformation(layer_srs, &raster_srs);
+			if(!ct) return CE_Failure;
+		}
+	}
+
+	CPLErr err = CE_None;
+	OGRFeature *feature;
+	layer->ResetReading();
+	while((feature = layer->GetNextFeature()) != NULL) {
+		OGRGeometry *geom = feature->StealGeometry();
+		fids.push_back(feature->GetFID());
+		OGRFeature::DestroyFeature(feature);
+
+		if(geom && ct && geom->transform(ct) != OGRERR_NONE) {
+			CPLError(CE_Failure, CPLE_AppDefined, "Unable to reproject the geometry of feature " CPL_FRMT_GIB, fids.back());
+			delete geom;
+			err = CE_Failure;
+			break;
+		}
+		scan->geometries.push_back(geom);
+	}
+	layer->ResetReading();
+
+	if(ct) OGRCoordinateTransformation::DestroyCT(ct);
+	return err;
+}
+
+// computes the window of every geometry and indexes the non-empty ones
+static CPLErr indexGeometries(ZonalScan *scan)
+{
+	double inv[6];
+	if(!GDALInvGeoTransform(scan->geo_transform, inv)) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Raster geotransform is not invertible");
+		return CE_Failure;
+	}
+
+	CPLRectObj bounds = rasterBounds(scan);
+	scan->index = CPLQuadTreeCreate(&bounds, getWindow);
+	CPLQuadTreeSetMaxDepth(scan->index, CPLQuadTreeGetAdvisedMaxDepth((int) scan->geometries.size()));
+
+	scan->windows.resize(scan->geometries.size());
+	for(size_t i = 0; i < scan->geometries.size(); i++) {
+		CPLRectObj &window = scan->windows[i];
+		window.minx = window.miny = window.maxx = window.maxy = 0;
+		OGRGeometry *geom = scan->geometries[i];
+		if(!geom || geom->IsEmpty()) continue;
+
+		OGREnvelope envelope;
+		geom->getEnvelope(&envelope);
+		double xs[2] = {envelope.MinX, envelope.MaxX};
+		double ys[2] = {envelope.MinY, envelope.MaxY};
+		double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+		for(int cx = 0; cx < 2; cx++) {
+			for(int cy = 0; cy < 2; cy++) {
+				double px = inv[0] + xs[cx] * inv[1] + ys[cy] * inv[2];
+				double py = inv[3] + xs[cx] * inv[4] + ys[cy] * inv[5];
+				min_x = std::min(min_x, px);
+				max_x = std::max(max_x, px);
+				min_y = std::min(min_y, py);
+				max_y = std::max(max_y, py);
+			}
+		}
+		window.minx = std::max(bounds.minx, floor(min_x) - 1);
+		window.miny = std::max(bounds.miny, floor(min_y) - 1);
+		window.maxx = std::min(bounds.maxx, ceil(max_x) + 1);
+		window.maxy = std::min(bounds.maxy, ceil(max_y) + 1);
+		if(isEmpty(window)) continue;
+		CPLQuadTreeInsert(scan->index, &window);
+	}
+	return CE_None;
+}
+
+CPLErr computeZonalStats(OGRLayer *layer, GDALRasterBand *band, const ZonalStatsOptions &options,
+                         std::vector<ZoneStats> &zones,
+                         GDALProgressFunc pfnProgress, void *pProgressArg)
+{
+	ZonalScan scan;
+	scan.band = band;
+	scan.options = &options;
+	scan.index = NULL;
+	scan.mem_driver = GetGDALDriverManager()->GetDriverByName("MEM");
+	if(!scan.mem_driver) {
+		CPLError(CE_Failure, CPLE_AppDefined, "MEM driver is not available");
+		return CE_Failure;
+	}
+
+	GDALDataset *ds = band->GetDataset();
+	if(!ds || ds->GetGeoTransform(scan.geo_transform) != CE_None) {
+		CPLError(CE_Failure, CPLE_AppDefined, "Raster has no geotransform");
+		return CE_Failure;
+	}
+
+	std::vector<GIntBig> fids;
+	CPLErr err = readGeometries(layer, band, &scan, fids);
+
+	if(!err) {
+		scan.width = band->GetXSize();
+		scan.height = band->GetYSize();
+		err = indexGeometries(&scan);
+	}
+
+	if(!err) {
+		int has_nodata = 0;
+		scan.nodata = band->GetNoDataValue(&has_nodata);
+		scan.has_nodata = has_nodata;
+		scan.hist_scale = options.hist_max > options.hist_min ? options.buckets / (options.hist_max - options.hist_min) : 0;
+		scan.zones = &zones;
+		if(pfnProgress) scan.pfnProgress = pfnProgress;
+		scan.pProgressArg = pProgressArg;
+		scan.chunk_rows = chunkRows(band);
+		scan.n_chunks = (scan.height + scan.chunk_rows - 1) / scan.chunk_rows;
+
+		initZones(zones, scan.geometries.size(), options);
+		for(size_t i = 0; i < zones.size(); i++) zones[i].fid = fids[i];
+
+		scan.run(scanChunks, &scan, options.threads);
+		err = scan.error();
+	}
+
+	if(scan.index) CPLQuadTreeDestroy(scan.index);
+	for(size_t i = 0; i < scan.geometries.size(); i++) {
+		delete scan.geometries[i];
+	}
+	if(err) return err;
+
+	scan.pfnProgress(1.0, NULL, scan.pProgressArg);
+	return CE_None;
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef __ZONAL_STATS_H__
+#define __ZONAL_STATS_H__
+
+// gdal
+#include <gdal_priv.h>
+
+// ogr
+#include <ogrsf_frmts.h>
+
+#include <vector>
+
+namespace node_gdal {
+
+struct ZonalStatsOptions {
+	// burn every pixel touched by a geometry, not just those whose center is inside
+	bool all_touched;
+	// per zone histogram over [hist_min, hist_max]; out of range values are dropped
+	bool histogram;
+	double hist_min;
+	double hist_max;
+	int buckets;
+	int threads;
+};
+
+struct ZoneStats {
+	GIntBig fid;
+	GUIntBig count;
+	double sum;
+	double min;
+	double max;
+	std::vector<GUIntBig> histogram;
+};
+
+// Computes statistics of the pixels of `band` covered by each feature of
+// `layer`, in a single pass over the band.
+//
+// Geometries are read once (and reprojected to the raster's SRS when both are
+// known and differ) and their pixel windows indexed in a quadtree. The band is
+// then processed in chunks of whole block rows spread over a CPL worker pool.
+// The geometries overlapping a chunk are split into groups whose windows don't
+// overlap; each group is rasterized into a zone id buffer with
+// GDALRasterizeGeometries() and the band pixels are accumulated into the zone
+// they fall in. Only the band reads are serialized.
+//
+// Overlapping features each count every pixel they cover, at the cost of one
+// more rasterization of the chunk per level of overlap. Nodata pixels (and
+// NaN) are skipped.
+//
+// `zones` receives one entry per feature, in layer order. Must be called with
+// the locks of both datasets held; the layer's reading position is reset.
+
+CPLErr computeZonalStats(OGRLayer *layer, GDALRasterBand *band, const ZonalStatsOptions &options,
+                         std::vector<ZoneStats> &zones,
+                         GDALProgressFunc pfnProgress, void *pProgressArg);
+
+}
+
+#endif
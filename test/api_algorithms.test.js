@@ -56,6 +56,17 @@ describe('gdal', function() {
 				assert.isFalse(feature.getGeometry().isEmpty());
 			});
 		});
+		it('should generate contours asynchronously', function() {
+			return gdal.contourGenerateAsync({
+				src: srcband,
+				dst: lyr,
+				interval: 32,
+				idField: 0,
+				elevField: 1
+			}).then(function() {
+				assert(lyr.features.count() > 0, 'features were created');
+			});
+		});
 		it('should accept an array of fixed levels', function() {
 			var levels = [53, 43, 193].sort();
 
@@ -122,6 +133,16 @@ describe('gdal', function() {
 				assert.notEqual(srcband.pixels.get(holes_x[i], holes_y[i]), nodata);
 			}
 		});
+		it('should fill nodata values asynchronously', function() {
+			return gdal.fillNodataAsync({
+				src: srcband,
+				searchDist: 3
+			}).then(function() {
+				for (var i = 0; i < holes_x.length; i++) {
+					assert.notEqual(srcband.pixels.get(holes_x[i], holes_y[i]), nodata);
+				}
+			});
+		});
 	});
 	describe('checksumImage()', function() {
 		var src, band;
@@ -153,6 +174,13 @@ describe('gdal', function() {
 			assert.notEqual(a, b);
 			assert.notEqual(b, c);
 		});
+		it('should resolve with the same checksum as checksumImage()', function() {
+			band.pixels.set(4, 4, 25);
+			var expected = gdal.checksumImage(band, 8, 0, w / 2, h);
+			return gdal.checksumImageAsync(band, 8, 0, w / 2, h).then(function(checksum) {
+				assert.equal(checksum, expected);
+			});
+		});
 	});
 	describe('sieveFilter()', function() {
 		var src, band;
@@ -190,6 +218,16 @@ describe('gdal', function() {
 
 			assert.equal(band.pixels.get(8, 8), 20);
 		});
+		it('should filter asynchronously', function() {
+			return gdal.sieveFilterAsync({
+				src: band,
+				dst: band,
+				threshold: 4 * 4 + 1,
+				connectedness: 8
+			}).then(function() {
+				assert.equal(band.pixels.get(8, 8), 20);
+			});
+		});
 	});
 	describe('polygonize()', function() {
 		var src, srcband, dst, lyr;
@@ -240,5 +278,345 @@ describe('gdal', function() {
 				assert.instanceOf(geom, gdal.Polygon);
 			});
 		});
+		it('should generate polygons asynchronously with progress', function() {
+			var last = 0;
+			return gdal.polygonizeAsync({
+				src: srcband,
+				dst: lyr,
+				pixValField: 0,
+				connectedness: 8
+			}, {
+				progress: function(ratio) {
+					assert.isAtLeast(ratio, last);
+					last = ratio;
+				}
+			}).then(function() {
+				assert.isAbove(last, 0);
+				assert.equal(lyr.features.count(), 2);
+			});
+		});
+		it('should reject when cancelled', function() {
+			var token = new gdal.CancelToken();
+			var promise = gdal.polygonizeAsync({
+				src: srcband,
+				dst: lyr,
+				pixValField: 0
+			}, {cancelToken: token});
+			token.cancel();
+			return promise.then(function() {
+				assert.fail('should have been cancelled');
+			}, function(err) {
+				assert.match(err.message, /cancelled/);
+			});
+		});
+		it('should keep the destination layer alive until complete', function() {
+			var promise = gdal.polygonizeAsync({
+				src: srcband,
+				dst: dst.layers.get(0),
+				pixValField: 0
+			});
+			lyr = null;
+			gc();
+			return promise.then(function() {
+				assert.equal(dst.layers.get(0).features.count(), 2);
+			});
+		});
+	});
+	describe('calc()', function() {
+		var ds, a, b, out;
+		var w = 300;
+		var h = 300;
+		beforeEach(function() {
+			ds = gdal.open('temp', 'w', 'MEM', w, h, 3, gdal.GDT_Float32);
+			a = ds.bands.get(1);
+			b = ds.bands.get(2);
+			out = ds.bands.get(3);
+			var row_a = new Float32Array(w);
+			var row_b = new Float32Array(w);
+			for (var x = 0; x < w; x++) {
+				row_a[x] = x;
+				row_b[x] = 2;
+			}
+			for (var y = 0; y < h; y++) {
+				a.pixels.write(0, y, w, 1, row_a);
+				b.pixels.write(0, y, w, 1, row_b);
+			}
+		});
+		afterEach(function() {
+			try {
+				ds.close();
+			} catch (err) {
+				/* ignore */
+			}
+		});
+		it('should evaluate the expression for every pixel', function() {
+			gdal.calc({
+				inputs: {a: a, b: b},
+				dst: out,
+				expression: '(a - b) / (a + b) + where(a > 10, 1, 0) * b ^ 2'
+			});
+			assert.closeTo(out.pixels.get(0, 0), -1, 1e-6);
+			assert.closeTo(out.pixels.get(6, 150), 0.5, 1e-6);
+			assert.closeTo(out.pixels.get(298, 299), 296 / 300 + 4, 1e-6);
+		});
+		it('should give the same result on one thread', function() {
+			gdal.calc({inputs: {a: a, b: b}, dst: out, expression: 'sqrt(a) * b', threads: 1});
+			var single = out.pixels.read(0, 0, w, h);
+			out.fill(0);
+			gdal.calc({inputs: {a: a, b: b}, dst: out, expression: 'sqrt(a) * b', threads: 4});
+			assert.deepEqual(Array.prototype.slice.call(out.pixels.read(0, 0, w, h)), Array.prototype.slice.call(single));
+		});
+		it('should propagate nodata', function() {
+			a.noDataValue = 5;
+			gdal.calc({inputs: {a: a, b: b}, dst: out, expression: 'b * (a - 1) / (a - 1)', nodata: -1});
+			assert.equal(out.noDataValue, -1);
+			assert.equal(out.pixels.get(5, 0), -1);
+			assert.equal(out.pixels.get(1, 0), -1);
+			assert.equal(out.pixels.get(3, 0), 2);
+		});
+		it('should write nodata as 0 in integer bands without nodata', function() {
+			a.noDataValue = 5;
+			var int_ds = gdal.open('temp', 'w', 'MEM', w, h, 1, gdal.GDT_Int16);
+			var int_out = int_ds.bands.get(1);
+			int_out.fill(7);
+			gdal.calc({inputs: {a: a, b: b}, dst: int_out, expression: 'b * (a - 1) / (a - 1)'});
+			assert.isNull(int_out.noDataValue);
+			assert.equal(int_out.pixels.get(5, 0), 0);
+			assert.equal(int_out.pixels.get(1, 0), 0);
+			assert.equal(int_out.pixels.get(3, 0), 2);
+			int_ds.close();
+		});
+		it('should throw on an invalid expression', function() {
+			assert.throws(function() {
+				gdal.calc({inputs: {a: a}, dst: out, expression: 'a + c'});
+			}, /Unknown input 'c'/);
+			assert.throws(function() {
+				gdal.calc({inputs: {a: a}, dst: out, expression: 'max(a'});
+			}, /Expected '\)'/);
+		});
+		it('should throw if the bands differ in size', function() {
+			var other = gdal.open('temp', 'w', 'MEM', 10, 10, 1, gdal.GDT_Float32);
+			assert.throws(function() {
+				gdal.calc({inputs: {a: a, c: other.bands.get(1)}, dst: out, expression: 'a + c'});
+			}, /same size/);
+		});
+		it('should evaluate asynchronously with progress', function() {
+			var calls = 0;
+			return gdal.calcAsync({
+				inputs: {a: a, b: b},
+				dst: out,
+				expression: 'a * b'
+			}, {
+				progress: function() { calls++; }
+			}).then(function() {
+				assert.isAbove(calls, 0);
+				assert.equal(out.pixels.get(7, 7), 14);
+			});
+		});
+	});
+	describe('zonalStats()', function() {
+		var raster, band, vector, lyr;
+		before(function() {
+			// 100x100 raster where each pixel holds its column
+			raster = gdal.open('temp', 'w', 'MEM', 100, 100, 1, gdal.GDT_Float32);
+			raster.geoTransform = [0, 1, 0, 100, 0, -1];
+			band = raster.bands.get(1);
+			var row = new Float32Array(100);
+			for (var x = 0; x < 100; x++) row[x] = x;
+			for (var y = 0; y < 100; y++) band.pixels.write(0, y, 100, 1, row);
+
+			vector = gdal.open('temp', 'w', 'Memory');
+			lyr = vector.layers.create('zones', null, gdal.Polygon);
+			[
+				'POLYGON ((0 90,10 90,10 100,0 100,0 90))',
+				'POLYGON ((50 0,60 0,60 20,50 20,50 0))',
+				'POLYGON ((200 200,210 200,210 210,200 210,200 200))'
+			].forEach(function(wkt) {
+				var feature = new gdal.Feature(lyr);
+				feature.setGeometry(gdal.Geometry.fromWKT(wkt));
+				lyr.features.add(feature);
+			});
+		});
+		after(function() {
+			raster.close();
+			vector.close();
+		});
+		it('should compute statistics for each feature', function() {
+			var zones = gdal.zonalStats(lyr, band);
+			assert.lengthOf(zones, 3);
+			assert.deepEqual(zones[0], {fid: 0, count: 100, sum: 450, min: 0, max: 9, mean: 4.5});
+			assert.equal(zones[1].count, 200);
+			assert.equal(zones[1].mean, 54.5);
+			assert.deepEqual(zones[2], {fid: 2, count: 0, sum: 0, min: null, max: null, mean: null});
+		});
+		it('should compute only the requested statistics', function() {
+			var zones = gdal.zonalStats(lyr, band, {
+				stats: ['max', 'histogram'],
+				histogram: {min: 0, max: 100, buckets: 10},
+				threads: 2
+			});
+			assert.deepEqual(zones[0], {fid: 0, max: 9, histogram: [100, 0, 0, 0, 0, 0, 0, 0, 0, 0]});
+			assert.deepEqual(zones[1].histogram, [0, 0, 0, 0, 0, 200, 0, 0, 0, 0]);
+		});
+		it('should count pixels covered by overlapping features towards each of them', function() {
+			var overlapping = gdal.open('temp', 'w', 'Memory');
+			var layer = overlapping.layers.create('zones', null, gdal.Polygon);
+			[
+				'POLYGON ((0 0,20 0,20 20,0 20,0 0))',
+				'POLYGON ((10 0,30 0,30 20,10 20,10 0))',
+				'POLYGON ((0 0,20 0,20 20,0 20,0 0))'
+			].forEach(function(wkt) {
+				var feature = new gdal.Feature(layer);
+				feature.setGeometry(gdal.Geometry.fromWKT(wkt));
+				layer.features.add(feature);
+			});
+			var zones = gdal.zonalStats(layer, band, {stats: ['count', 'mean'], threads: 2});
+			assert.deepEqual(zones, [
+				{fid: 0, count: 400, mean: 9.5},
+				{fid: 1, count: 400, mean: 19.5},
+				{fid: 2, count: 400, mean: 9.5}
+			]);
+			overlapping.close();
+		});
+		it('should skip nodata pixels', function() {
+			band.noDataValue = 0;
+			try {
+				assert.equal(gdal.zonalStats(lyr, band)[0].count, 90);
+			} finally {
+				band.noDataValue = null;
+			}
+		});
+		it('should require a histogram range for non-Byte bands', function() {
+			assert.throws(function() {
+				gdal.zonalStats(lyr, band, {stats: ['histogram']});
+			}, /histogram/);
+		});
+		it('should compute statistics asynchronously', function() {
+			return gdal.zonalStatsAsync(lyr, band, {stats: ['mean']}).then(function(zones) {
+				assert.deepEqual(zones.map(function(zone) { return zone.mean; }), [4.5, 54.5, null]);
+			});
+		});
+	});
+	describe('buildVRT()', function() {
+		var files;
+		// writes a 50x50 tile of a 2x2 grid covering [0, 100] x [0, 100]
+		function createTile(x, y, value, type) {
+			var file = __dirname + '/data/temp/mosaic.' + String(Math.random()).substring(2) + '.tif';
+			var ds = gdal.open(file, 'w', 'GTiff', 50, 50, 1, type || gdal.GDT_Byte);
+			ds.geoTransform = [x * 50, 1, 0, 100 - y * 50, 0, -1];
+			ds.srs = gdal.SpatialReference.fromEPSG(3857);
+			ds.bands.get(1).fill(value);
+			ds.close();
+			files.push(file);
+			return file;
+		}
+		beforeEach(function() {
+			files = [];
+		});
+
+		it('should mosaic the files into one dataset', function() {
+			createTile(0, 0, 1);
+			createTile(1, 0, 2);
+			createTile(0, 1, 3);
+			createTile(1, 1, 4);
+			var ds = gdal.buildVRT(files);
+			assert.equal(ds.driver.description, 'VRT');
+			assert.equal(ds.rasterSize.x, 100);
+			assert.equal(ds.rasterSize.y, 100);
+			assert.deepEqual(ds.geoTransform, [0, 1, 0, 100, 0, -1]);
+			assert.isTrue(ds.srs.isSame(gdal.SpatialReference.fromEPSG(3857)));
+
+			var band = ds.bands.get(1);
+			assert.equal(band.pixels.get(10, 10), 1);
+			assert.equal(band.pixels.get(90, 10), 2);
+			assert.equal(band.pixels.get(10, 90), 3);
+			assert.equal(band.pixels.get(90, 90), 4);
+
+			var data = band.pixels.read(0, 0, 100, 100);
+			var sum = 0;
+			for (var i = 0; i < data.length; i++) sum += data[i];
+			assert.equal(sum, 2500 * (1 + 2 + 3 + 4));
+		});
+		it('should fill areas without files with the nodata value', function() {
+			createTile(0, 0, 1);
+			createTile(1, 1, 4);
+			var ds = gdal.buildVRT(files, {vrtNodata: 255});
+			var band = ds.bands.get(1);
+			assert.equal(band.noDataValue, 255);
+			assert.equal(band.pixels.get(90, 10), 255);
+			assert.equal(band.pixels.get(10, 10), 1);
+			assert.equal(band.pixels.get(90, 90), 4);
+		});
+		it('should let later files win where files overlap', function() {
+			createTile(0, 0, 1);
+			createTile(0, 0, 2);
+			var ds = gdal.buildVRT(files);
+			assert.equal(ds.bands.get(1).pixels.get(10, 10), 2);
+		});
+		it('should composite files with and without nodata in dataset reads', function() {
+			createTile(0, 0, 1);
+			var partial = createTile(0, 0, 5);
+			createTile(1, 0, 2);
+			var untouched = createTile(1, 1, 4);
+
+			// the left half of `partial` is nodata and shows the file below
+			var ds = gdal.open(partial, 'r+');
+			ds.bands.get(1).noDataValue = 0;
+			ds.bands.get(1).pixels.write(0, 0, 25, 50, new Uint8Array(25 * 50));
+			ds.close();
+
+			var mosaic = gdal.buildVRT(files);
+			require('fs').unlinkSync(untouched);
+
+			// a first read of a file without nodata mustn't decide how the
+			// others are read
+			var data = mosaic.pixels.read(50, 0, 50, 50);
+			assert.equal(data[0], 2);
+			data = mosaic.pixels.read(0, 0, 50, 50);
+			assert.equal(data[10], 1);
+			assert.equal(data[40], 5);
+			assert.equal(data[49 * 50 + 10], 1);
+			assert.equal(data[49 * 50 + 40], 5);
+		});
+		it('should use the given resolution', function() {
+			createTile(0, 0, 1);
+			var ds = gdal.buildVRT(files, {xRes: 2, yRes: 2});
+			assert.equal(ds.rasterSize.x, 25);
+			assert.equal(ds.rasterSize.y, 25);
+			assert.equal(ds.bands.get(1).pixels.get(5, 5), 1);
+		});
+		it('should throw if band types differ', function() {
+			createTile(0, 0, 1);
+			createTile(1, 0, 2, gdal.GDT_Float32);
+			assert.throws(function() {
+				gdal.buildVRT(files);
+			}, /Band 1 of .* is Float32/);
+		});
+		it('should throw if a file can\'t be opened', function() {
+			assert.throws(function() {
+				gdal.buildVRT([__dirname + '/data/does-not-exist.tif']);
+			});
+		});
+		it('should throw if files is empty', function() {
+			assert.throws(function() {
+				gdal.buildVRT([]);
+			}, /files must not be empty/);
+		});
+	});
+
+	describe('buildVRTAsync()', function() {
+		it('should resolve with the mosaic', function() {
+			var file = __dirname + '/data/temp/mosaic.' + String(Math.random()).substring(2) + '.tif';
+			var ds = gdal.open(file, 'w', 'GTiff', 50, 50, 1, gdal.GDT_Byte);
+			ds.geoTransform = [0, 1, 0, 50, 0, -1];
+			ds.bands.get(1).fill(7);
+			ds.close();
+
+			return gdal.buildVRTAsync([file, file]).then(function(mosaic) {
+				assert.instanceOf(mosaic, gdal.Dataset);
+				assert.equal(mosaic.rasterSize.x, 50);
+				assert.equal(mosaic.bands.get(1).pixels.get(25, 25), 7);
+			});
+		});
 	});
 });
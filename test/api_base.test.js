@@ -81,6 +81,32 @@ describe('gdal', function() {
 			});
 		});
 	});
+	describe('blockCache', function() {
+		describe('stats()', function() {
+			it('should report used and max bytes', function() {
+				var stats = gdal.blockCache.stats();
+				assert.isNumber(stats.used);
+				assert.isNumber(stats.max);
+				assert.isAtMost(stats.used, stats.max);
+			});
+		});
+		describe('setMax()', function() {
+			it('should set the cache size', function() {
+				var max = gdal.blockCache.stats().max;
+				try {
+					gdal.blockCache.setMax(16 * 1024 * 1024);
+					assert.equal(gdal.blockCache.stats().max, 16 * 1024 * 1024);
+				} finally {
+					gdal.blockCache.setMax(max);
+				}
+			});
+			it('should throw on negative size', function() {
+				assert.throws(function() {
+					gdal.blockCache.setMax(-1);
+				}, RangeError);
+			});
+		});
+	});
 	describe('decToDMS()', function() {
 		it('should throw when axis not provided', function() {
 			assert.throws(function() {
@@ -108,6 +108,84 @@ describe('gdal.Dataset', function() {
 				});
 			});
 		});
+		describe('"pixels" property', function() {
+			var createRGBA = function() {
+				var mem = gdal.open('temp', 'w', 'MEM', 4, 2, 4, gdal.GDT_Byte);
+				for (var b = 1; b <= 4; b++) {
+					var values = new Uint8Array(new ArrayBuffer(8));
+					for (var i = 0; i < 8; i++) values[i] = b * 10 + i;
+					mem.bands.get(b).pixels.write(0, 0, 4, 2, values);
+				}
+				return mem;
+			};
+			it('should exist', function() {
+				assert.instanceOf(ds.pixels, gdal.DatasetPixels);
+			});
+			describe('read()', function() {
+				it('should read all bands band-sequentially by default', function() {
+					var mem = createRGBA();
+					var data = mem.pixels.read(0, 0, 4, 2);
+					assert.instanceOf(data, Uint8Array);
+					assert.equal(data.length, 32);
+					assert.equal(data[0], 10);
+					assert.equal(data[8], 20);
+					assert.equal(data[31], 47);
+				});
+				it('should interleave pixels', function() {
+					var mem = createRGBA();
+					var data = mem.pixels.read(0, 0, 4, 2, null, {interleave: 'pixel'});
+					assert.deepEqual(Array.prototype.slice.call(data, 0, 8), [10, 20, 30, 40, 11, 21, 31, 41]);
+				});
+				it('should use the band map', function() {
+					var mem = createRGBA();
+					var data = mem.pixels.read(0, 0, 4, 2, null, {bands: [3, 1], interleave: 'pixel'});
+					assert.equal(data.length, 16);
+					assert.deepEqual(Array.prototype.slice.call(data, 0, 4), [30, 10, 31, 11]);
+				});
+				it('should throw on invalid band id', function() {
+					var mem = createRGBA();
+					assert.throws(function() {
+						mem.pixels.read(0, 0, 4, 2, null, {bands: [5]});
+					}, /invalid band id/);
+				});
+				it('should convert to the given type', function() {
+					var mem = createRGBA();
+					var data = mem.pixels.read(0, 0, 4, 2, null, {type: gdal.GDT_Float32});
+					assert.instanceOf(data, Float32Array);
+					assert.equal(data[8], 20);
+				});
+				it('should throw on invalid type', function() {
+					var mem = createRGBA();
+					assert.throws(function() {
+						mem.pixels.read(0, 0, 4, 2, null, {type: 'Float33'});
+					}, /Invalid data type/);
+				});
+				it('should throw if the array is too small', function() {
+					var mem = createRGBA();
+					assert.throws(function() {
+						mem.pixels.read(0, 0, 4, 2, new Uint8Array(new ArrayBuffer(16)));
+					});
+				});
+			});
+			describe('write()', function() {
+				it('should write pixel-interleaved data', function() {
+					var mem = gdal.open('temp', 'w', 'MEM', 2, 1, 3, gdal.GDT_Byte);
+					var data = new Uint8Array(new ArrayBuffer(6));
+					data.set([1, 2, 3, 4, 5, 6]);
+					mem.pixels.write(0, 0, 2, 1, data, {interleave: 'pixel'});
+					assert.equal(mem.bands.get(1).pixels.get(1, 0), 4);
+					assert.equal(mem.bands.get(3).pixels.get(0, 0), 3);
+				});
+			});
+			describe('readAsync()', function() {
+				it('should resolve with the data', function() {
+					var mem = createRGBA();
+					return mem.pixels.readAsync(0, 0, 4, 2, null, {interleave: 'pixel'}).then(function(data) {
+						assert.equal(data[1], 20);
+					});
+				});
+			});
+		});
 		describe('"layers" property', function() {
 			it('should exist', function() {
 				assert.instanceOf(ds.layers, gdal.DatasetLayers);
@@ -495,6 +573,43 @@ describe('gdal.Dataset', function() {
 				});
 			});
 		});
+		describe('executeSQLAsync()', function() {
+			it('should resolve with a Layer', function() {
+				var ds = gdal.open(__dirname + '/data/shp/sample.shp');
+				return ds.executeSQLAsync('SELECT name FROM sample ORDER BY name').then(function(result_set) {
+					assert.instanceOf(result_set, gdal.Layer);
+					assert.deepEqual(result_set.fields.getNames(), ['name']);
+					assert.equal(result_set.features.count(), ds.layers.get(0).features.count());
+					ds.close();
+				});
+			});
+			it('should destroy result set when dataset is closed', function() {
+				var ds = gdal.open(__dirname + '/data/shp/sample.shp');
+				return ds.executeSQLAsync('SELECT name FROM sample').then(function(result_set) {
+					ds.close();
+					assert.throws(function() {
+						result_set.fields.getNames();
+					});
+				});
+			});
+			it('should reject if the statement is invalid', function() {
+				var ds = gdal.open(__dirname + '/data/shp/sample.shp');
+				return ds.executeSQLAsync('SELECT nonexistent FROM sample').then(function() {
+					assert.fail('should have been rejected');
+				}, function(err) {
+					assert.instanceOf(err, Error);
+				});
+			});
+			it('should reject if dataset already closed', function() {
+				var ds = gdal.open(__dirname + '/data/shp/sample.shp');
+				ds.close();
+				return ds.executeSQLAsync('SELECT name FROM sample').then(function() {
+					assert.fail('should have been rejected');
+				}, function(err) {
+					assert.match(err.message, /already been destroyed/);
+				});
+			});
+		});
 		describe('getFileList()', function() {
 			it('should return list of filenames', function() {
 				var ds = gdal.open(path.join(__dirname, 'data', 'sample.vrt'));
@@ -527,6 +642,31 @@ describe('gdal.Dataset', function() {
 				});
 			});
 		});
+		describe('getCacheStats()', function() {
+			it('should sum the counters of all bands', function() {
+				if (!gdal.bundled) this.skip();
+				var ds = gdal.open(__dirname + '/data/multiband.tif');
+				ds.bands.forEach(function(band) {
+					band.pixels.get(0, 0);
+				});
+				var misses = 0;
+				ds.bands.forEach(function(band) {
+					misses += band.getCacheStats().misses;
+				});
+				var stats = ds.getCacheStats();
+				assert.isAbove(stats.misses, 0);
+				assert.equal(stats.misses, misses);
+				ds.resetCacheStats();
+				assert.equal(ds.getCacheStats().misses, 0);
+			});
+			it('should throw if dataset already closed', function() {
+				var ds = gdal.open(__dirname + '/data/sample.tif');
+				ds.close();
+				assert.throws(function() {
+					ds.getCacheStats();
+				});
+			});
+		});
 		describe('buildOverviews()', function() {
 			it('should generate overviews for all bands', function() {
 				var ds = gdal.open(fileUtils.clone(__dirname + '/data/multiband.tif'), 'r+');
@@ -587,6 +727,61 @@ describe('gdal.Dataset', function() {
 				});
 			});
 		});
+		describe('buildOverviewsAsync()', function() {
+			it('should generate overviews for all bands', function() {
+				var ds = gdal.open(fileUtils.clone(__dirname + '/data/multiband.tif'), 'r+');
+				var last = 0;
+				return ds.buildOverviewsAsync('NEAREST', [2, 4, 8], null, {
+					progress: function(ratio) {
+						assert.isAtLeast(ratio, last);
+						last = ratio;
+					}
+				}).then(function() {
+					assert.equal(last, 1);
+					ds.bands.forEach(function(band) {
+						assert.equal(band.overviews.count(), 3);
+					});
+					ds.close();
+				});
+			});
+			it('should produce the same overviews when building bands concurrently', function() {
+				var expected = gdal.open(fileUtils.clone(__dirname + '/data/multiband.tif'), 'r+');
+				var ds = gdal.open(fileUtils.clone(__dirname + '/data/multiband.tif'), 'r+');
+				expected.buildOverviews('AVERAGE', [2, 4]);
+				return ds.buildOverviewsAsync('AVERAGE', [2, 4], null, {concurrent: true}).then(function() {
+					ds.bands.forEach(function(band, i) {
+						assert.equal(band.overviews.count(), 2);
+						for (var j = 0; j < 2; j++) {
+							assert.equal(
+								gdal.checksumImage(band.overviews.get(j)),
+								gdal.checksumImage(expected.bands.get(i).overviews.get(j))
+							);
+						}
+					});
+					ds.close();
+					expected.close();
+				});
+			});
+			it('should reject when cancelled', function() {
+				var ds = gdal.open(fileUtils.clone(__dirname + '/data/multiband.tif'), 'r+');
+				var token = new gdal.CancelToken();
+				var promise = ds.buildOverviewsAsync('NEAREST', [2, 4, 8], null, {cancelToken: token});
+				token.cancel();
+				return promise.then(function() {
+					assert.fail('should have been cancelled');
+				}, function(err) {
+					assert.match(err.message, /cancelled/);
+				});
+			});
+			it('should reject if invalid band given', function() {
+				var ds = gdal.open(fileUtils.clone(__dirname + '/data/sample.tif'), 'r+');
+				return ds.buildOverviewsAsync('NEAREST', [2, 4, 8], [4]).then(function() {
+					assert.fail('should have been rejected');
+				}, function(err) {
+					assert.match(err.message, /invalid band id/);
+				});
+			});
+		});
 	});
 	describe('setGCPs()', function() {
 		it('should update gcps', function() {
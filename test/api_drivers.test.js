@@ -1,5 +1,6 @@
 var assert = require('chai').assert;
 var gdal = require('../lib/gdal.js');
+var fs = require('fs');
 
 describe('gdal.drivers', function() {
 	afterEach(gc);
@@ -138,3 +139,129 @@ describe('gdal.drivers', function() {
 		});
 	});
 });
+
+describe('gdal.Driver', function() {
+	afterEach(gc);
+
+	describe('createCopyAsync()', function() {
+		var src;
+		before(function() {
+			src = gdal.open(__dirname + '/data/sample.tif');
+		});
+
+		it('should resolve with the new dataset', function() {
+			var driver = gdal.drivers.get('MEM');
+			return driver.createCopyAsync('', src).then(function(ds) {
+				assert.instanceOf(ds, gdal.Dataset);
+				assert.equal(ds.rasterSize.x, src.rasterSize.x);
+				assert.equal(ds.rasterSize.y, src.rasterSize.y);
+				assert.equal(ds.bands.count(), src.bands.count());
+			});
+		});
+		it('should report progress', function() {
+			var driver = gdal.drivers.get('MEM');
+			var ratios = [];
+			return driver.createCopyAsync('', src, null, {
+				progress: function(ratio) { ratios.push(ratio); }
+			}).then(function() {
+				assert.isAbove(ratios.length, 0);
+				for (var i = 1; i < ratios.length; i++) {
+					assert.isAtLeast(ratios[i], ratios[i - 1]);
+				}
+				assert.equal(ratios[ratios.length - 1], 1);
+			});
+		});
+		it('should reject when cancelled', function() {
+			var driver = gdal.drivers.get('MEM');
+			var token = new gdal.CancelToken();
+			var promise = driver.createCopyAsync('', src, null, {cancelToken: token});
+			token.cancel();
+			assert.isTrue(token.cancelled);
+			return promise.then(function() {
+				assert.fail('should have been cancelled');
+			}, function(err) {
+				assert.match(err.message, /cancelled/);
+			});
+		});
+		it('should reject if cancelToken is invalid', function() {
+			var driver = gdal.drivers.get('MEM');
+			return driver.createCopyAsync('', src, null, {cancelToken: {}}).then(function() {
+				assert.fail('should have been rejected');
+			}, function(err) {
+				assert.instanceOf(err, TypeError);
+			});
+		});
+		it('should reject if source dataset is closed', function() {
+			var driver = gdal.drivers.get('MEM');
+			var ds = gdal.open(__dirname + '/data/sample.tif');
+			ds.close();
+			return driver.createCopyAsync('', ds).then(function() {
+				assert.fail('should have been rejected');
+			}, function(err) {
+				assert.match(err.message, /destroyed/);
+			});
+		});
+	});
+
+	describe('encode()', function() {
+		var src;
+		beforeEach(function() {
+			src = gdal.open('temp', 'w', 'MEM', 64, 64, 1, gdal.GDT_Byte);
+			src.bands.get(1).fill(10);
+		});
+
+		it('should return the encoded file in a Buffer', function() {
+			var png = gdal.drivers.get('PNG').encode(src);
+			assert.instanceOf(png, Buffer);
+			assert.equal(png.slice(1, 4).toString(), 'PNG');
+
+			var file = __dirname + '/data/temp/encoded.' + String(Math.random()).substring(2) + '.png';
+			fs.writeFileSync(file, png);
+			var ds = gdal.open(file);
+			assert.equal(ds.rasterSize.x, 64);
+			assert.equal(ds.bands.get(1).pixels.get(32, 32), 10);
+			ds.close();
+		});
+		it('should pass creation options to the driver', function() {
+			var jpeg = gdal.drivers.get('JPEG').encode(src, ['QUALITY=50']);
+			assert.equal(jpeg[0], 0xFF);
+			assert.equal(jpeg[1], 0xD8);
+		});
+		it('should leave out .aux.xml and world files', function() {
+			src.geoTransform = [0, 1, 0, 64, 0, -1];
+			src.srs = gdal.SpatialReference.fromEPSG(4326);
+			var png = gdal.drivers.get('PNG').encode(src, ['WORLDFILE=YES']);
+			assert.equal(png.slice(1, 4).toString(), 'PNG');
+		});
+		it('should throw if the driver writes several files', function() {
+			var shp = gdal.open(__dirname + '/data/shp/sample.shp');
+			assert.throws(function() {
+				gdal.drivers.get('ESRI Shapefile').encode(shp);
+			}, /only single file formats/);
+		});
+		it('should throw if the driver doesn\'t write files', function() {
+			assert.throws(function() {
+				gdal.drivers.get('MEM').encode(src);
+			});
+		});
+		it('should throw if source dataset is closed', function() {
+			src.close();
+			assert.throws(function() {
+				gdal.drivers.get('PNG').encode(src);
+			}, /destroyed/);
+		});
+	});
+
+	describe('encodeAsync()', function() {
+		it('should resolve with the same Buffer as encode()', function() {
+			var src = gdal.open('temp', 'w', 'MEM', 64, 64, 1, gdal.GDT_Byte);
+			src.bands.get(1).fill(10);
+			var driver = gdal.drivers.get('PNG');
+			var expected = driver.encode(src);
+			return driver.encodeAsync(src).then(function(png) {
+				assert.instanceOf(png, Buffer);
+				assert.isTrue(png.equals(expected));
+			});
+		});
+	});
+});
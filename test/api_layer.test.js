@@ -438,6 +438,57 @@ describe('gdal.Layer', function() {
 					});
 				});
 			});
+			describe('nextBatchAsync()', function() {
+				var ds, layer;
+				beforeEach(function() {
+					ds = gdal.open(__dirname + '/data/shp/sample.shp');
+					layer = ds.layers.get(0);
+				});
+				afterEach(function() {
+					try { ds.close(); } catch (err) { /* ignore */ }
+				});
+				it('should resolve with up to n features', function() {
+					return layer.features.nextBatchAsync(2).then(function(features) {
+						assert.isArray(features);
+						assert.lengthOf(features, 2);
+						features.forEach(function(feature) {
+							assert.instanceOf(feature, gdal.Feature);
+						});
+						assert.equal(features[0].fid, 0);
+						assert.equal(features[1].fid, 1);
+						assert.equal(layer.features.next().fid, 2);
+					});
+				});
+				it('should read all features across batches and then resolve with an empty array', function() {
+					var count = layer.features.count();
+					var read = 0;
+					var next = function() {
+						return layer.features.nextBatchAsync(7).then(function(features) {
+							if (!features.length) return;
+							read += features.length;
+							return next();
+						});
+					};
+					return next().then(function() {
+						assert.equal(read, count);
+					});
+				});
+				it('should reject if n is invalid', function() {
+					return layer.features.nextBatchAsync(0).then(function() {
+						assert.fail('should have been rejected');
+					}, function(err) {
+						assert.instanceOf(err, RangeError);
+					});
+				});
+				it('should reject if dataset is destroyed', function() {
+					ds.close();
+					return layer.features.nextBatchAsync(2).then(function() {
+						assert.fail('should have been rejected');
+					}, function(err) {
+						assert.match(err.message, /already destroyed/);
+					});
+				});
+			});
 			describe('first()', function() {
 				it('should return a Feature and reset the iterator', function() {
 					prepare_dataset_layer_test('r', function(dataset, layer) {
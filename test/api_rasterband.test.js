@@ -512,6 +512,47 @@ describe('gdal.RasterBand', function() {
 							band.pixels.read(0, 0, 20, 31, data);
 						});
 					});
+					it('should accept a Buffer', function() {
+						var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Byte);
+						var band = ds.bands.get(1);
+						band.pixels.set(1, 1, 30);
+						var data = new Buffer(20 * 30);
+						band.pixels.read(0, 0, 20, 30, data);
+						assert.equal(data[21], 30);
+					});
+					it('should accept a Uint8ClampedArray', function() {
+						var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Byte);
+						var band = ds.bands.get(1);
+						band.pixels.set(1, 1, 200);
+						var data = new Uint8ClampedArray(new ArrayBuffer(20 * 30));
+						band.pixels.read(0, 0, 20, 30, data);
+						assert.equal(data[21], 200);
+					});
+					it('should throw for an Int8Array', function() {
+						var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Byte);
+						var band = ds.bands.get(1);
+						var data = new Int8Array(new ArrayBuffer(20 * 30));
+						assert.throws(function() {
+							band.pixels.read(0, 0, 20, 30, data);
+						}, /Invalid array/);
+					});
+					it('should accept a DataView using the band data type', function() {
+						var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Int16);
+						var band = ds.bands.get(1);
+						band.pixels.set(1, 0, -300);
+						var view = new DataView(new ArrayBuffer(20 * 30 * 2));
+						band.pixels.read(0, 0, 20, 30, view);
+						assert.equal(view.getInt16(2, true), -300);
+					});
+					it('should accept a view on a SharedArrayBuffer', function() {
+						if (typeof SharedArrayBuffer === 'undefined') return this.skip();
+						var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Byte);
+						var band = ds.bands.get(1);
+						band.pixels.set(1, 1, 30);
+						var data = new Uint8Array(new SharedArrayBuffer(20 * 30));
+						band.pixels.read(0, 0, 20, 30, data);
+						assert.equal(data[21], 30);
+					});
 					it('should automatically translate data to array data type', function() {
 						var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Byte);
 						var band = ds.bands.get(1);
@@ -619,6 +660,64 @@ describe('gdal.RasterBand', function() {
 							}, /Array length must be greater than.*/);
 						});
 					});
+					describe('"resampling"', function() {
+						it('should average pixels when downsampling', function() {
+							var ds   = gdal.open('temp', 'w', 'MEM', 4, 4, 1, gdal.GDT_Float32);
+							var band = ds.bands.get(1);
+							band.pixels.write(0, 0, 4, 4, new Float32Array([
+								0, 2, 4, 4,
+								2, 0, 4, 4,
+								8, 8, 1, 1,
+								8, 8, 1, 3
+							]));
+							var options = {buffer_width: 2, buffer_height: 2, resampling: gdal.GRA_Average};
+							var data = band.pixels.read(0, 0, 4, 4, null, options);
+							assert.deepEqual(Array.prototype.slice.call(data), [1, 4, 8, 1.5]);
+						});
+						it('should default to nearest neighbour', function() {
+							var ds   = gdal.open('temp', 'w', 'MEM', 4, 4, 1, gdal.GDT_Byte);
+							var band = ds.bands.get(1);
+							band.pixels.write(0, 0, 4, 4, new Uint8Array([
+								1, 0, 2, 0,
+								0, 0, 0, 0,
+								3, 0, 4, 0,
+								0, 0, 0, 0
+							]));
+							var data = band.pixels.read(0, 0, 4, 4, null, {buffer_width: 2, buffer_height: 2});
+							assert.deepEqual(Array.prototype.slice.call(data), [1, 2, 3, 4]);
+						});
+						it('should throw on unknown algorithm', function() {
+							var ds   = gdal.open('temp', 'w', 'MEM', 4, 4, 1, gdal.GDT_Byte);
+							assert.throws(function() {
+								ds.bands.get(1).pixels.read(0, 0, 4, 4, null, {buffer_width: 2, buffer_height: 2, resampling: 'foo'});
+							}, /Invalid resampling/);
+						});
+						it('should be supported by readAsync()', function() {
+							var ds   = gdal.open('temp', 'w', 'MEM', 4, 4, 1, gdal.GDT_Float32);
+							var band = ds.bands.get(1);
+							band.fill(3);
+							band.pixels.set(0, 0, 7);
+							var options = {buffer_width: 1, buffer_height: 1, resampling: gdal.GRA_Average};
+							return band.pixels.readAsync(0, 0, 2, 2, null, options).then(function(data) {
+								assert.equal(data[0], 4);
+							});
+						});
+					});
+					describe('fractional window', function() {
+						it('should resample from the exact source window', function() {
+							var ds   = gdal.open('temp', 'w', 'MEM', 4, 1, 1, gdal.GDT_Float32);
+							var band = ds.bands.get(1);
+							band.pixels.write(0, 0, 4, 1, new Float32Array([0, 10, 20, 30]));
+							// sampled at x = 1.0 and 2.0 rather than 0.75 and 2.25 of the whole-pixel window
+							var data = band.pixels.read(0.5, 0, 2, 1, null, {buffer_width: 2, buffer_height: 1});
+							assert.deepEqual(Array.prototype.slice.call(data), [10, 20]);
+						});
+						it('should default the buffer to the rounded window size', function() {
+							var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
+							var data = ds.bands.get(1).pixels.read(0.25, 0.25, 7.5, 7.5);
+							assert.equal(data.length, 8 * 8);
+						});
+					});
 					it('should throw an error if region is out of bounds', function() {
 						var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
 						var band = ds.bands.get(1);
@@ -874,6 +973,469 @@ describe('gdal.RasterBand', function() {
 					});
 				});
 			});
+			describe('readAsync()', function() {
+				it('should resolve with a TypedArray', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var w = 20;
+					var h = 30;
+					return band.pixels.readAsync(190, 290, w, h).then(function(data) {
+						assert.instanceOf(data, Uint8Array);
+						assert.equal(data.length, w * h);
+						assert.equal(data[10 * 20 + 10], 10);
+					});
+				});
+				it('should put the data in the existing array', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var data = new Float64Array(new ArrayBuffer(20 * 30 * 8));
+					return band.pixels.readAsync(190, 290, 20, 30, data).then(function(result) {
+						assert.equal(result, data);
+						assert.equal(data[10 * 20 + 10], 10);
+					});
+				});
+				it('should return the same values as read()', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var expected = band.pixels.read(0, 0, 100, 100);
+					return Promise.all([
+						band.pixels.readAsync(0, 0, 100, 100),
+						band.pixels.readAsync(0, 0, 100, 100)
+					]).then(function(results) {
+						results.forEach(function(data) {
+							assert.deepEqual(data, expected);
+						});
+					});
+				});
+				it('should run jobs on the same dataset in the order they were queued', function() {
+					var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
+					var band = ds.bands.get(1);
+					var jobs = [];
+					var order = [];
+					for (var i = 1; i <= 16; i++) {
+						var data = new Uint8Array(new ArrayBuffer(16 * 16));
+						for (var j = 0; j < data.length; j++) data[j] = i;
+						jobs.push(band.pixels.writeAsync(0, 0, 16, 16, data));
+						jobs.push(band.pixels.readAsync(0, 0, 16, 16).then(function(result) {
+							order.push(result[0]);
+							assert.equal(result[255], result[0]);
+						}));
+					}
+					return Promise.all(jobs).then(function() {
+						assert.deepEqual(order, [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16]);
+					});
+				});
+				it('should allow synchronous calls while a read is in flight', function() {
+					var src  = gdal.open(__dirname + '/data/sample.tif');
+					var ds   = gdal.drivers.get('MEM').createCopy('', src);
+					var band = ds.bands.get(1);
+					var expected = Array.prototype.slice.call(band.pixels.read(0, 0, 100, 100));
+					var reads = [];
+					for (var i = 0; i < 8; i++) {
+						reads.push(band.pixels.readAsync(0, 0, 100, 100));
+					}
+					var stats = band.computeStatistics(false);
+					assert.isAtMost(stats.min, stats.max);
+					assert.property(band.getMetadata(), 'STATISTICS_MAXIMUM');
+					assert.deepEqual(Array.prototype.slice.call(band.pixels.read(0, 0, 100, 100)), expected);
+					ds.flush();
+					return Promise.all(reads).then(function(results) {
+						results.forEach(function(data) {
+							assert.deepEqual(Array.prototype.slice.call(data), expected);
+						});
+					});
+				});
+				it('should reject if region is out of bounds', function() {
+					var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
+					var band = ds.bands.get(1);
+					return band.pixels.readAsync(20, 20, 16, 16).then(function() {
+						assert.fail('expected rejection');
+					}, function(err) {
+						assert.instanceOf(err, Error);
+					});
+				});
+				it('should reject if dataset already closed', function() {
+					var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
+					var band = ds.bands.get(1);
+					ds.close();
+					return band.pixels.readAsync(0, 0, 16, 16).then(function() {
+						assert.fail('expected rejection');
+					}, function(err) {
+						assert.instanceOf(err, Error);
+					});
+				});
+				it('should defer closing the dataset until pending reads finish', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var expected = band.pixels.read(0, 0, 100, 100);
+					var promise = band.pixels.readAsync(0, 0, 100, 100);
+					ds.close();
+					assert.throws(function() {
+						band.pixels.get(0, 0);
+					}, /already been destroyed/);
+					return promise.then(function(data) {
+						assert.deepEqual(Array.prototype.slice.call(data), Array.prototype.slice.call(expected));
+					});
+				});
+			});
+			describe('writeAsync()', function() {
+				it('should write data from TypedArray', function() {
+					var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Byte);
+					var band = ds.bands.get(1);
+					var i, w = 16, h = 16;
+
+					var data = new Uint8Array(new ArrayBuffer(w * h));
+					for (i = 0; i < w * h; i++) data[i] = i;
+
+					return band.pixels.writeAsync(100, 120, w, h, data).then(function() {
+						var result = band.pixels.read(100, 120, w, h);
+						for (i = 0; i < w * h; i++) {
+							assert.equal(result[i], data[i]);
+						}
+					});
+				});
+				it('should throw error if array is too small', function() {
+					var ds   = gdal.open('temp', 'w', 'MEM', 256, 256, 1, gdal.GDT_Byte);
+					var band = ds.bands.get(1);
+					var data = new Uint8Array(new ArrayBuffer(16 * 16 - 1));
+					return band.pixels.writeAsync(100, 120, 16, 16, data).then(function() {
+						assert.fail('expected rejection');
+					}, function(err) {
+						assert.match(err.message, /Array length/);
+					});
+				});
+			});
+			describe('readBlockAsync()', function() {
+				it('should resolve with the same data as readBlock()', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var expected = band.pixels.readBlock(0, 0);
+					return band.pixels.readBlockAsync(0, 0).then(function(data) {
+						assert.instanceOf(data, Uint8Array);
+						assert.deepEqual(data, expected);
+					});
+				});
+			});
+			describe('writeBlockAsync()', function() {
+				it('should write data from TypedArray', function() {
+					var i;
+					var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
+					var band = ds.bands.get(1);
+
+					var length = band.blockSize.x * band.blockSize.y;
+					var data = new Uint8Array(new ArrayBuffer(length));
+					for (i = 0; i < length; i++) data[i] = i;
+
+					return band.pixels.writeBlockAsync(0, 0, data).then(function() {
+						var result = band.pixels.readBlock(0, 0);
+						for (i = 0; i < length; i++) {
+							assert.equal(result[i], data[i]);
+						}
+					});
+				});
+			});
+			describe('blocks()', function() {
+				it('should visit every block in storage order', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var it = band.pixels.blocks();
+					var step, n = 0, area = 0, last;
+					while (!(step = it.next()).done) {
+						var block = step.value;
+						if (last) {
+							assert.isTrue(block.y > last.y || (block.y === last.y && block.x === last.x + 1));
+						}
+						assert.equal(block.offset_x, block.x * band.blockSize.x);
+						assert.equal(block.data.length, band.blockSize.x * band.blockSize.y);
+						area += block.width * block.height;
+						last = block;
+						n++;
+					}
+					var expected = Math.ceil(band.size.x / band.blockSize.x) * Math.ceil(band.size.y / band.blockSize.y);
+					assert.equal(n, expected);
+					assert.equal(area, band.size.x * band.size.y);
+				});
+				it('should clip edge blocks', function() {
+					var ds   = gdal.open('/vsimem/blocks_edge.tif', 'w', 'GTiff', 20, 24, 1, gdal.GDT_Byte, {
+						TILED: 'YES', BLOCKXSIZE: '16', BLOCKYSIZE: '16'
+					});
+					var band = ds.bands.get(1);
+					var it = band.pixels.blocks();
+					var blocks = [];
+					var step;
+					while (!(step = it.next()).done) blocks.push(step.value);
+					assert.equal(blocks.length, 4);
+					assert.deepEqual(blocks.map(function(b) { return [b.width, b.height]; }), [[16, 16], [4, 16], [16, 8], [4, 8]]);
+					assert.equal(blocks[3].data.length, 16 * 16);
+					ds.close();
+				});
+			});
+			describe('blocksAsync()', function() {
+				it('should not read ahead with prefetch 0', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var pixels = band.pixels;
+					var reads = 0;
+					var readBlockAsync = pixels.readBlockAsync;
+					pixels.readBlockAsync = function() {
+						reads++;
+						return readBlockAsync.apply(this, arguments);
+					};
+					var it = pixels.blocksAsync({prefetch: 0});
+					return it.next().then(function(result) {
+						assert.isFalse(result.done);
+						assert.equal(reads, 1);
+						return it.next();
+					}).then(function() {
+						assert.equal(reads, 2);
+					});
+				});
+				it('should resolve blocks in order with prefetching', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var sync = band.pixels.blocks();
+					var it = band.pixels.blocksAsync({prefetch: 3});
+					var n = 0;
+					var step = function() {
+						return it.next().then(function(result) {
+							var expected = sync.next();
+							assert.equal(result.done, expected.done);
+							if (result.done) return;
+							assert.equal(result.value.x, expected.value.x);
+							assert.equal(result.value.y, expected.value.y);
+							if (n++ < 3) assert.deepEqual(result.value.data, expected.value.data);
+							return step();
+						});
+					};
+					return step();
+				});
+				it('should throw on invalid prefetch', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					assert.throws(function() {
+						ds.bands.get(1).pixels.blocksAsync({prefetch: -1});
+					}, RangeError);
+				});
+			});
+			describe('map()', function() {
+				beforeEach(function() {
+					if (process.platform !== 'linux') this.skip();
+				});
+				it('should map the whole band', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var data = band.pixels.map();
+					assert.instanceOf(data, Uint8Array);
+					assert.equal(data.length, band.size.x * band.size.y);
+					var expected = band.pixels.read(0, 0, band.size.x, band.size.y);
+					assert.deepEqual(data, expected);
+				});
+				it('should throw for bands that can\'t be mapped from the file', function() {
+					var ds   = gdal.open(__dirname + '/data/sample_deflate.tif');
+					assert.throws(function() {
+						ds.bands.get(1).pixels.map();
+					}, /can't be mapped/);
+				});
+				it('should keep writes to "r" mappings private', function() {
+					var file = fileUtils.clone(__dirname + '/data/sample.tif');
+					var ds   = gdal.open(file);
+					var band = ds.bands.get(1);
+					var data = band.pixels.map();
+					var original = band.pixels.get(10, 0);
+					data[10] = original + 1;
+					assert.equal(data[10], original + 1);
+					assert.equal(band.pixels.get(10, 0), original);
+					ds.close();
+
+					ds = gdal.open(file);
+					assert.equal(ds.bands.get(1).pixels.get(10, 0), original);
+				});
+				it('should write through "r+" mappings', function() {
+					var file = fileUtils.clone(__dirname + '/data/sample.tif');
+					var ds   = gdal.open(file, 'r+');
+					var data = ds.bands.get(1).pixels.map('r+');
+					data[10] = 42;
+					ds.close();
+
+					ds = gdal.open(file);
+					assert.equal(ds.bands.get(1).pixels.get(10, 0), 42);
+				});
+				it('should keep read() and write() consistent with "r+" mappings', function() {
+					var file = fileUtils.clone(__dirname + '/data/sample.tif');
+					var ds   = gdal.open(file, 'r+');
+					var band = ds.bands.get(1);
+					band.pixels.get(10, 0); // caches the block
+					var data = band.pixels.map('r+');
+					data[10] = 42;
+					assert.equal(band.pixels.get(10, 0), 42);
+					band.pixels.set(11, 0, 43);
+					assert.equal(data[11], 43);
+				});
+				it('should throw when a mapped array is passed to the same dataset', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var data = band.pixels.map();
+					assert.throws(function() {
+						band.pixels.read(0, 0, 10, 10, data);
+					}, /mapped from the same dataset/);
+					assert.throws(function() {
+						band.pixels.write(0, 0, 10, 10, data);
+					}, /mapped from the same dataset/);
+				});
+				it('should detach the array when the dataset is closed', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var data = ds.bands.get(1).pixels.map();
+					ds.close();
+					assert.equal(data.length, 0);
+				});
+				it('should throw on invalid mode', function() {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					assert.throws(function() {
+						ds.bands.get(1).pixels.map('w');
+					});
+				});
+			});
+			describe('createReadStream()', function() {
+				it('should emit tiles covering the window', function(done) {
+					var ds   = gdal.open(__dirname + '/data/sample.tif');
+					var band = ds.bands.get(1);
+					var window = {x: 10, y: 20, width: 100, height: 50};
+					var area = 0;
+					band.pixels.createReadStream({window: window, tileSize: {x: 32, y: 32}})
+						.on('data', function(tile) {
+							assert.isAtMost(tile.width, 32);
+							assert.isAtMost(tile.height, 32);
+							assert.deepEqual(tile.data, band.pixels.read(tile.x, tile.y, tile.width, tile.height));
+							area += tile.width * tile.height;
+						})
+						.on('error', done)
+						.on('end', function() {
+							assert.equal(area, window.width * window.height);
+							done();
+						});
+				});
+				it('should throw if the window is outside the band', function() {
+					var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
+					assert.throws(function() {
+						ds.bands.get(1).pixels.createReadStream({window: {x: 8, y: 0, width: 16, height: 16}});
+					}, RangeError);
+				});
+			});
+			describe('createWriteStream()', function() {
+				it('should write tiles in any order', function(done) {
+					var ds   = gdal.open('temp', 'w', 'MEM', 20, 20, 1, gdal.GDT_Int16);
+					var band = ds.bands.get(1);
+					var stream = band.pixels.createWriteStream();
+					var tiles = [];
+					for (var y = 0; y < 20; y += 7) {
+						for (var x = 0; x < 20; x += 7) {
+							var w = Math.min(7, 20 - x), h = Math.min(7, 20 - y);
+							var data = new Int16Array(w * h);
+							for (var i = 0; i < data.length; i++) {
+								data[i] = (y + Math.floor(i / w)) * 20 + x + i % w;
+							}
+							tiles.push({x: x, y: y, width: w, height: h, data: data});
+						}
+					}
+					tiles.reverse().forEach(function(tile) { stream.write(tile); });
+					stream.on('error', done);
+					stream.end(function() {
+						var result = band.pixels.read(0, 0, 20, 20);
+						for (var i = 0; i < result.length; i++) assert.equal(result[i], i);
+						done();
+					});
+				});
+				it('should keep pixels not covered by any tile', function(done) {
+					var ds   = gdal.open('temp', 'w', 'MEM', 8, 8, 1, gdal.GDT_Byte);
+					var band = ds.bands.get(1);
+					band.fill(5);
+					var stream = band.pixels.createWriteStream();
+					stream.on('error', done);
+					stream.end({x: 2, y: 2, width: 2, height: 2, data: new Uint8Array([1, 1, 1, 1])}, function() {
+						assert.equal(band.pixels.get(0, 0), 5);
+						assert.equal(band.pixels.get(2, 2), 1);
+						assert.equal(band.pixels.get(3, 3), 1);
+						assert.equal(band.pixels.get(4, 3), 5);
+						done();
+					});
+				});
+				it('should write partial edge blocks of a tiled file', function(done) {
+					var file = '/vsimem/write_stream_tiled.tif';
+					var ds   = gdal.open(file, 'w', 'GTiff', 20, 24, 1, gdal.GDT_Int16, ['TILED=YES', 'BLOCKXSIZE=16', 'BLOCKYSIZE=16']);
+					var band = ds.bands.get(1);
+					assert.deepEqual(band.blockSize, {x: 16, y: 16});
+					band.fill(-1);
+					band.flush();
+
+					// covers rows 0-17 only, so the bottom blocks stay incomplete
+					var stream = band.pixels.createWriteStream();
+					var tiles = [];
+					for (var y = 0; y < 18; y += 6) {
+						for (var x = 0; x < 20; x += 6) {
+							var w = Math.min(6, 20 - x);
+							var data = new Int16Array(w * 6);
+							for (var i = 0; i < data.length; i++) {
+								data[i] = (y + Math.floor(i / w)) * 20 + x + i % w;
+							}
+							tiles.push({x: x, y: y, width: w, height: 6, data: data});
+						}
+					}
+					tiles.reverse().forEach(function(tile) { stream.write(tile); });
+					stream.on('error', done);
+					stream.end(function() {
+						try {
+							ds.close();
+							ds = gdal.open(file);
+							var result = ds.bands.get(1).pixels.read(0, 0, 20, 24);
+							for (var i = 0; i < result.length; i++) {
+								assert.equal(result[i], i < 18 * 20 ? i : -1);
+							}
+							ds.close();
+							done();
+						} catch (err) {
+							done(err);
+						}
+					});
+				});
+				it('should write partial edge blocks before the stream.pipeline() callback', function(done) {
+					var streams = require('stream');
+					if (!streams.pipeline) this.skip();
+					var file = '/vsimem/write_stream_pipeline.tif';
+					var ds   = gdal.open(file, 'w', 'GTiff', 20, 20, 1, gdal.GDT_Byte, ['TILED=YES', 'BLOCKXSIZE=16', 'BLOCKYSIZE=16']);
+					var band = ds.bands.get(1);
+					band.fill(1);
+					band.flush();
+
+					// only the top left block is complete
+					var tiles = [{x: 0, y: 0, width: 18, height: 18, data: new Uint8Array(18 * 18).fill(9)}];
+					var source = new streams.Readable({objectMode: true, read: function() {
+						this.push(tiles.length ? tiles.shift() : null);
+					}});
+					streams.pipeline(source, band.pixels.createWriteStream(), function(err) {
+						try {
+							if (err) throw err;
+							ds.close();
+							ds = gdal.open(file);
+							var result = ds.bands.get(1).pixels.read(0, 0, 20, 20);
+							for (var i = 0; i < result.length; i++) {
+								assert.equal(result[i], i % 20 < 18 && i < 18 * 20 ? 9 : 1);
+							}
+							ds.close();
+							done();
+						} catch (e) {
+							done(e);
+						}
+					});
+				});
+				it('should emit an error for tiles outside the band', function(done) {
+					var ds   = gdal.open('temp', 'w', 'MEM', 8, 8, 1, gdal.GDT_Byte);
+					var stream = ds.bands.get(1).pixels.createWriteStream();
+					stream.on('error', function(err) {
+						assert.instanceOf(err, RangeError);
+						done();
+					});
+					stream.write({x: 6, y: 0, width: 4, height: 1, data: new Uint8Array(4)});
+				});
+			});
 		});
 		describe('"overviews" property', function() {
 			describe('getter', function() {
@@ -971,6 +1533,156 @@ describe('gdal.RasterBand', function() {
 				});
 			});
 		});
+		describe('getCacheStats()', function() {
+			it('should count block cache hits and misses', function() {
+				if (!gdal.bundled) this.skip();
+				var ds   = gdal.open(__dirname + '/data/sample.tif');
+				var band = ds.bands.get(1);
+				var block_bytes = band.blockSize.x * band.blockSize.y;
+
+				band.pixels.get(0, 0);
+				var stats = band.getCacheStats();
+				assert.equal(stats.misses, 1);
+				assert.equal(stats.bytes_decoded, block_bytes);
+
+				band.pixels.get(1, 0);
+				stats = band.getCacheStats();
+				assert.equal(stats.hits, 1);
+				assert.equal(stats.misses, 1);
+				assert.equal(stats.evictions, 0);
+			});
+			it('should count bytes decoded by readBlock()', function() {
+				if (!gdal.bundled) this.skip();
+				var ds   = gdal.open(__dirname + '/data/sample.tif');
+				var band = ds.bands.get(1);
+				band.pixels.readBlock(0, 0);
+				assert.equal(band.getCacheStats().bytes_decoded, band.blockSize.x * band.blockSize.y);
+			});
+			it('should be reset by resetCacheStats()', function() {
+				if (!gdal.bundled) this.skip();
+				var ds   = gdal.open(__dirname + '/data/sample.tif');
+				var band = ds.bands.get(1);
+				band.pixels.get(0, 0);
+				band.resetCacheStats();
+				assert.deepEqual(band.getCacheStats(), {hits: 0, misses: 0, evictions: 0, bytes_decoded: 0});
+			});
+			it('should throw if dataset already closed', function() {
+				var ds   = gdal.open(__dirname + '/data/sample.tif');
+				var band = ds.bands.get(1);
+				ds.close();
+				assert.throws(function() {
+					band.getCacheStats();
+				});
+			});
+		});
+		describe('computeStatistics()', function() {
+			it('should compute and store the statistics of the band', function() {
+				var ds = gdal.open('temp', 'w', 'MEM', 10, 10, 1, gdal.GDT_Float32);
+				var band = ds.bands.get(1);
+				var data = new Float32Array(100);
+				for (var i = 0; i < 100; i++) data[i] = i;
+				band.pixels.write(0, 0, 10, 10, data);
+				band.noDataValue = 0;
+
+				var stats = band.computeStatistics(false);
+				assert.equal(stats.min, 1);
+				assert.equal(stats.max, 99);
+				assert.closeTo(stats.mean, 50, 1e-9);
+				assert.closeTo(stats.std_dev, Math.sqrt((99 * 99 - 1) / 12), 1e-9);
+				assert.equal(band.getMetadata().STATISTICS_MAXIMUM, 99);
+				var stored = band.getStatistics(false, false);
+				assert.equal(stored.min, 1);
+				assert.closeTo(stored.std_dev, stats.std_dev, 1e-9);
+			});
+			it('should throw if the band has no valid pixels', function() {
+				var ds = gdal.open('temp', 'w', 'MEM', 10, 10, 1, gdal.GDT_Byte);
+				var band = ds.bands.get(1);
+				band.noDataValue = 0;
+				assert.throws(function() {
+					band.computeStatistics(false);
+				});
+			});
+		});
+		describe('getHistogram()', function() {
+			var createBand = function(type) {
+				var ds = gdal.open('temp', 'w', 'MEM', 10, 10, 1, type);
+				var band = ds.bands.get(1);
+				var data = new Float64Array(100);
+				for (var i = 0; i < 100; i++) data[i] = i;
+				band.pixels.write(0, 0, 10, 10, data);
+				return band;
+			};
+			it('should count values and compute statistics', function() {
+				var h = createBand(gdal.GDT_Byte).getHistogram({buckets: 10});
+				assert.equal(h.min, 0);
+				assert.equal(h.max, 99);
+				assert.deepEqual(h.buckets, [10, 10, 10, 10, 10, 10, 10, 10, 10, 10]);
+				assert.equal(h.statistics.count, 100);
+				assert.equal(h.statistics.min, 0);
+				assert.equal(h.statistics.max, 99);
+				assert.closeTo(h.statistics.mean, 49.5, 1e-9);
+				assert.closeTo(h.statistics.std_dev, Math.sqrt((100 * 100 - 1) / 12), 1e-9);
+			});
+			it('should give the same result for floating point bands', function() {
+				var h = createBand(gdal.GDT_Float32).getHistogram({buckets: 10, threads: 3});
+				assert.deepEqual(h.buckets, [10, 10, 10, 10, 10, 10, 10, 10, 10, 10]);
+				assert.equal(h.statistics.count, 100);
+				assert.closeTo(h.statistics.mean, 49.5, 1e-9);
+			});
+			it('should skip nodata pixels', function() {
+				var band = createBand(gdal.GDT_Int16);
+				band.noDataValue = 0;
+				var h = band.getHistogram();
+				assert.equal(h.statistics.count, 99);
+				assert.equal(h.statistics.min, 1);
+				assert.lengthOf(h.buckets, 256);
+			});
+			it('should respect "min" / "max" and "includeOutOfRange"', function() {
+				var band = createBand(gdal.GDT_Float64);
+				assert.deepEqual(band.getHistogram({min: 0, max: 50, buckets: 5}).buckets, [10, 10, 10, 10, 11]);
+				assert.deepEqual(band.getHistogram({min: 0, max: 50, buckets: 5, includeOutOfRange: true}).buckets, [10, 10, 10, 10, 60]);
+			});
+			it('should compute exact percentiles of integer bands', function() {
+				var h = createBand(gdal.GDT_UInt16).getHistogram({percentiles: [0, 50, 100]});
+				assert.deepEqual(h.percentiles, [0, 49.5, 99]);
+			});
+			it('should interpolate percentiles of floating point bands', function() {
+				var h = createBand(gdal.GDT_Float32).getHistogram({buckets: 100, percentiles: [2, 98]});
+				assert.closeTo(h.percentiles[0], 2, 1);
+				assert.closeTo(h.percentiles[1], 97, 1);
+			});
+			it('should throw on invalid options', function() {
+				var band = createBand(gdal.GDT_Byte);
+				assert.throws(function() {
+					band.getHistogram({min: 0});
+				}, /together/);
+				assert.throws(function() {
+					band.getHistogram({percentiles: [101]});
+				}, /between 0 and 100/);
+			});
+			it('should throw if dataset already closed', function() {
+				var ds   = gdal.open(__dirname + '/data/sample.tif');
+				var band = ds.bands.get(1);
+				ds.close();
+				assert.throws(function() {
+					band.getHistogram();
+				});
+			});
+		});
+		describe('getHistogramAsync()', function() {
+			it('should resolve with the same histogram as getHistogram()', function() {
+				var ds   = gdal.open(__dirname + '/data/sample.tif');
+				var band = ds.bands.get(1);
+				var expected = band.getHistogram({approximate: true, percentiles: [50]});
+				var calls = 0;
+				return band.getHistogramAsync({approximate: true, percentiles: [50]}, {
+					progress: function() { calls++; }
+				}).then(function(h) {
+					assert.deepEqual(h, expected);
+					assert.isAbove(calls, 0);
+				});
+			});
+		});
 		describe('fill()', function() {
 			it('should set all pixels to given value', function() {
 				var ds   = gdal.open('temp', 'w', 'MEM', 16, 16, 1, gdal.GDT_Byte);
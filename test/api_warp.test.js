@@ -1,5 +1,7 @@
 var gdal = require('../lib/gdal.js');
 var assert = require('chai').assert;
+var fs = require('fs');
+var path = require('path');
 
 describe('gdal', function() {
 	afterEach(gc);
@@ -484,4 +486,193 @@ describe('gdal', function() {
 			it.skip('should throw error if GDAL can\'t create transformer', function() {});
 		}
 	});
+	describe('reprojectImageAsync()', function() {
+		var src;
+		beforeEach(function() {
+			src = gdal.open(__dirname + '/data/sample.tif');
+		});
+		afterEach(function() {
+			try { src.close(); } catch (err) { /* ignore */ }
+		});
+
+		function createOptions() {
+			var options = {
+				src: src,
+				s_srs: src.srs,
+				t_srs: gdal.SpatialReference.fromEPSG(4326)
+			};
+			var info = gdal.suggestedWarpOutput(options);
+			options.dst = gdal.open('temp', 'w', 'MEM', info.rasterSize.x, info.rasterSize.y, 1, gdal.GDT_Byte);
+			options.dst.geoTransform = info.geoTransform;
+			return options;
+		}
+
+		it('should produce the same result as reprojectImage()', function() {
+			var options = createOptions();
+			gdal.reprojectImage(options);
+			var expected_checksum = gdal.checksumImage(options.dst.bands.get(1));
+
+			var geoTransform = options.dst.geoTransform;
+			options.dst = gdal.open('temp', 'w', 'MEM', options.dst.rasterSize.x, options.dst.rasterSize.y, 1, gdal.GDT_Byte);
+			options.dst.geoTransform = geoTransform;
+
+			return gdal.reprojectImageAsync(options).then(function() {
+				assert.equal(gdal.checksumImage(options.dst.bands.get(1)), expected_checksum);
+			});
+		});
+		it('should report progress', function() {
+			var options = createOptions();
+			options.multi = true;
+			var last = 0;
+			return gdal.reprojectImageAsync(options, {
+				progress: function(ratio) {
+					assert.isAtLeast(ratio, last);
+					last = ratio;
+				}
+			}).then(function() {
+				assert.equal(last, 1);
+			});
+		});
+		it('should reject when cancelled', function() {
+			var options = createOptions();
+			var token = new gdal.CancelToken();
+			var promise = gdal.reprojectImageAsync(options, {cancelToken: token});
+			token.cancel();
+			return promise.then(function() {
+				assert.fail('should have been cancelled');
+			}, function(err) {
+				assert.match(err.message, /cancelled/);
+			});
+		});
+		it('should reject if options are invalid', function() {
+			return gdal.reprojectImageAsync({src: src, s_srs: src.srs, t_srs: src.srs}).then(function() {
+				assert.fail('should have been rejected');
+			}, function(err) {
+				assert.match(err.message, /dst Dataset must be provided/);
+			});
+		});
+	});
+	describe('generateTiles()', function() {
+		var src, dir;
+		beforeEach(function() {
+			src = gdal.open(__dirname + '/data/sample.tif');
+			dir = __dirname + '/data/temp/tiles.' + String(Math.random()).substring(2) + '.tmp';
+		});
+		afterEach(function() {
+			try { src.close(); } catch (err) { /* ignore */ }
+		});
+
+		function countTiles(dir) {
+			return fs.readdirSync(dir).reduce(function(count, name) {
+				var child = path.join(dir, name);
+				return count + (fs.statSync(child).isDirectory() ? countTiles(child) : 1);
+			}, 0);
+		}
+
+		it('should write a tile pyramid', function() {
+			var result = gdal.generateTiles(src, {dir: dir, minZoom: 0, maxZoom: 3});
+			assert.isAbove(result.written, 3);
+			assert.equal(countTiles(dir), result.written);
+
+			var tile = gdal.open(dir + '/0/0/0.png');
+			assert.equal(tile.rasterSize.x, 256);
+			assert.equal(tile.rasterSize.y, 256);
+			assert.equal(tile.bands.count(), 2);
+			assert.equal(tile.bands.get(2).colorInterpretation, gdal.GCI_AlphaBand);
+			tile.close();
+		});
+		it('should produce the same tiles with one thread', function() {
+			gdal.generateTiles(src, {dir: dir, maxZoom: 2});
+			var single_dir = dir + '.single';
+			gdal.generateTiles(src, {dir: single_dir, maxZoom: 2, threads: 1});
+
+			fs.readdirSync(dir + '/2').forEach(function(x) {
+				fs.readdirSync(dir + '/2/' + x).forEach(function(name) {
+					var a = gdal.open(dir + '/2/' + x + '/' + name);
+					var b = gdal.open(single_dir + '/2/' + x + '/' + name);
+					assert.equal(gdal.checksumImage(a.bands.get(1)), gdal.checksumImage(b.bands.get(1)));
+				});
+			});
+		});
+		it('should number rows from the bottom with the tms scheme', function() {
+			gdal.generateTiles(src, {dir: dir, minZoom: 1, maxZoom: 1, scheme: 'tms', format: 'JPEG'});
+			var xyz_dir = dir + '.xyz';
+			gdal.generateTiles(src, {dir: xyz_dir, minZoom: 1, maxZoom: 1, format: 'JPEG'});
+
+			fs.readdirSync(xyz_dir + '/1').forEach(function(x) {
+				fs.readdirSync(xyz_dir + '/1/' + x).forEach(function(name) {
+					var y = parseInt(name, 10);
+					assert.isTrue(fs.existsSync(dir + '/1/' + x + '/' + (1 - y) + '.jpg'));
+				});
+			});
+		});
+		it('should create missing parent directories', function() {
+			var nested = dir + '/nested/deeper';
+			var result = gdal.generateTiles(src, {dir: nested, maxZoom: 1});
+			assert.equal(countTiles(nested), result.written);
+		});
+		it('should not reopen a MEM dataset named after a file', function() {
+			var file = __dirname + '/data/sample.tif';
+			var mem = gdal.drivers.get('MEM').create(file, src.rasterSize.x, src.rasterSize.y, src.bands.count(), gdal.GDT_Byte);
+			mem.geoTransform = src.geoTransform;
+			mem.srs = src.srs;
+			mem.bands.forEach(function(band) { band.fill(7); });
+
+			gdal.generateTiles(mem, {dir: dir, minZoom: 1, maxZoom: 1, threads: 4});
+			fs.readdirSync(dir + '/1').forEach(function(x) {
+				fs.readdirSync(dir + '/1/' + x).forEach(function(name) {
+					var tile = gdal.open(dir + '/1/' + x + '/' + name);
+					var color = tile.bands.get(1).pixels.read(0, 0, 256, 256);
+					var alpha = tile.bands.get(tile.bands.count()).pixels.read(0, 0, 256, 256);
+					for (var i = 0; i < color.length; i++) {
+						if (alpha[i] === 255) assert.equal(color[i], 7);
+					}
+					tile.close();
+				});
+			});
+			mem.close();
+		});
+		it('should throw if the zoom range is invalid', function() {
+			assert.throws(function() {
+				gdal.generateTiles(src, {dir: dir, minZoom: 4, maxZoom: 2});
+			}, /minZoom <= maxZoom/);
+		});
+		it('should throw if the format is not supported', function() {
+			assert.throws(function() {
+				gdal.generateTiles(src, {dir: dir, maxZoom: 2, format: 'GTiff'});
+			}, /format must be/);
+		});
+	});
+
+	describe('generateTilesAsync()', function() {
+		var src, dir;
+		beforeEach(function() {
+			src = gdal.open(__dirname + '/data/sample.tif');
+			dir = __dirname + '/data/temp/tiles.' + String(Math.random()).substring(2) + '.tmp';
+		});
+		afterEach(function() {
+			try { src.close(); } catch (err) { /* ignore */ }
+		});
+
+		it('should resolve with the same result as generateTiles()', function() {
+			var expected = gdal.generateTiles(src, {dir: dir + '.sync', maxZoom: 3});
+			var last = 0;
+			return gdal.generateTilesAsync(src, {dir: dir, maxZoom: 3}, {
+				progress: function(ratio) {
+					assert.isAtLeast(ratio, last);
+					last = ratio;
+				}
+			}).then(function(result) {
+				assert.deepEqual(result, expected);
+				assert.equal(last, 1);
+			});
+		});
+		it('should reject if options are invalid', function() {
+			return gdal.generateTilesAsync(src, {maxZoom: 3}).then(function() {
+				assert.fail('should have been rejected');
+			}, function(err) {
+				assert.match(err.message, /dir must be a string/);
+			});
+		});
+	});
 });
@@ -1,5 +1,6 @@
 var gdal = require('../lib/gdal.js');
 var path = require('path');
+var fs = require('fs');
 var assert = require('assert');
 
 describe('Open', function() {
@@ -11,4 +12,213 @@ describe('Open', function() {
 			gdal.open(filename);
 		}, /Error opening dataset/);
 	});
+
+	describe('openAsync()', function() {
+		it('should resolve with a dataset', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			return gdal.openAsync(filename).then(function(ds) {
+				assert.ok(ds instanceof gdal.Dataset);
+				assert.equal(ds.driver.description, 'GTiff');
+				assert.equal(ds.bands.count(), 1);
+			});
+		});
+		it('should open with the given driver list', function() {
+			var filename = path.join(__dirname, 'data/shp/sample.shp');
+			return gdal.openAsync(filename, 'r', ['GTiff', 'ESRI Shapefile']).then(function(ds) {
+				assert.equal(ds.driver.description, 'ESRI Shapefile');
+			});
+		});
+		it('should reject when invalid file', function() {
+			var filename = path.join(__dirname, 'data/invalid');
+			return gdal.openAsync(filename).then(function() {
+				assert.fail('expected rejection');
+			}, function(err) {
+				assert.ok(/Error opening dataset/.test(err.message));
+			});
+		});
+		it('should reject when invalid mode', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			return gdal.openAsync(filename, 'x').then(function() {
+				assert.fail('expected rejection');
+			}, function(err) {
+				assert.ok(/Invalid open mode/.test(err.message));
+			});
+		});
+	});
+
+	describe('Driver.openAsync()', function() {
+		it('should resolve with a dataset', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			return gdal.drivers.get('GTiff').openAsync(filename).then(function(ds) {
+				assert.ok(ds instanceof gdal.Dataset);
+				assert.equal(ds.rasterSize.x, 984);
+			});
+		});
+		it('should reject when the driver cannot open the file', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			return gdal.drivers.get('PNG').openAsync(filename).then(function() {
+				assert.fail('expected rejection');
+			}, function(err) {
+				assert.ok(/Error opening dataset/.test(err.message));
+			});
+		});
+	});
+
+	describe('openPool()', function() {
+		it('should return a dataset', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			var ds = gdal.openPool(filename, {size: 3});
+			assert.ok(ds instanceof gdal.Dataset);
+			assert.equal(ds.bands.count(), 1);
+			ds.close();
+		});
+		it('should serve concurrent reads from the pooled handles', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			var ds = gdal.openPool(filename, {size: 3});
+			var band = ds.bands.get(1);
+			var expected = Array.prototype.slice.call(band.pixels.read(0, 0, 64, 64));
+			var reads = [];
+			for (var i = 0; i < 8; i++) {
+				reads.push(band.pixels.readAsync(0, 0, 64, 64));
+			}
+			return Promise.all(reads).then(function(results) {
+				results.forEach(function(data) {
+					assert.deepEqual(Array.prototype.slice.call(data), expected);
+				});
+				ds.close();
+			});
+		});
+		it('should throw when size is invalid', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			assert.throws(function() {
+				gdal.openPool(filename, {size: 0});
+			}, /at least 1/);
+		});
+		it('should throw when invalid file', function() {
+			var filename = path.join(__dirname, 'data/invalid');
+			assert.throws(function() {
+				gdal.openPool(filename, {size: 2});
+			}, /Error opening dataset/);
+		});
+	});
+
+	describe('openBuffer()', function() {
+		it('should open a raster from a Buffer', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			var expected = gdal.open(filename).bands.get(1).pixels.read(0, 0, 64, 64);
+			var ds = gdal.openBuffer(fs.readFileSync(filename), 'sample.tif');
+			assert.ok(ds instanceof gdal.Dataset);
+			assert.equal(ds.driver.description, 'GTiff');
+			assert.equal(ds.rasterSize.x, 984);
+			var data = ds.bands.get(1).pixels.read(0, 0, 64, 64);
+			assert.deepEqual(Array.prototype.slice.call(data), Array.prototype.slice.call(expected));
+			ds.close();
+		});
+		it('should open a vector dataset using the hint extension', function() {
+			var filename = path.join(__dirname, 'data/park.geo.json');
+			var ds = gdal.openBuffer(fs.readFileSync(filename), '.geojson');
+			assert.equal(ds.driver.description, 'GeoJSON');
+			assert.ok(ds.layers.get(0).features.count() > 0);
+			ds.close();
+		});
+		it('should refuse to open the in-memory file again', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			var ds = gdal.openBuffer(fs.readFileSync(filename));
+			var mem_file = ds.description;
+			assert.ok(/^\/vsimem\//.test(mem_file));
+			assert.throws(function() {
+				gdal.open(mem_file);
+			}, /openBuffer/);
+			assert.throws(function() {
+				gdal.open('/vsizip/' + mem_file);
+			}, /openBuffer/);
+			ds.close();
+			assert.throws(function() {
+				gdal.open(mem_file);
+			}, /openBuffer/);
+		});
+		it('should refuse to open the in-memory file through a driver or a mosaic', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			var ds = gdal.openBuffer(fs.readFileSync(filename), 'sample.tif');
+			var mem_file = ds.description;
+			assert.throws(function() {
+				gdal.drivers.get('GTiff').open(mem_file);
+			}, /openBuffer/);
+			assert.throws(function() {
+				gdal.buildVRT([filename, mem_file]);
+			}, /openBuffer/);
+			ds.close();
+		});
+		it('should throw when the buffer is not a dataset', function() {
+			assert.throws(function() {
+				gdal.openBuffer(new Buffer('not a dataset'));
+			}, /Error opening dataset/);
+		});
+		it('should throw when not given a Buffer', function() {
+			assert.throws(function() {
+				gdal.openBuffer({});
+			}, /must be a Buffer/);
+		});
+	});
+
+	describe('datasetCache', function() {
+		it('should open a dataset through the pool', function() {
+			var filename = path.join(__dirname, 'data/sample.tif');
+			var ds = gdal.datasetCache.open(filename);
+			assert.ok(ds instanceof gdal.Dataset);
+			assert.equal(ds.rasterSize.x, 984);
+			assert.equal(ds.bands.count(), 1);
+			assert.equal(ds.driver.description, 'GTiff');
+			assert.ok(ds.bands.get(1).pixels.read(0, 0, 16, 16) instanceof Uint8Array);
+			ds.close();
+		});
+		it('should keep reading datasets once more than the pool size are open', function() {
+			// GDAL_MAX_DATASET_POOL_SIZE defaults to 100
+			var max = gdal.bundled ? gdal.datasetCache.stats().max : 100;
+			var driver = gdal.drivers.get('GTiff');
+			var filenames = [];
+			var datasets = [];
+			var i;
+			try {
+				for (i = 0; i < max + 5; i++) {
+					var filename = '/vsimem/dataset_cache_' + i + '.tif';
+					var src = driver.create(filename, 4, 4, 1, gdal.GDT_Int16);
+					filenames.push(filename);
+					src.bands.get(1).fill(i);
+					src.close();
+				}
+				for (i = 0; i < filenames.length; i++) {
+					datasets.push(gdal.datasetCache.open(filenames[i]));
+					assert.equal(datasets[i].bands.get(1).pixels.get(0, 0), i);
+				}
+				// the first handles have been evicted by now and are reopened on access
+				for (i = 0; i < datasets.length; i++) {
+					assert.equal(datasets[i].bands.get(1).pixels.get(3, 3), i);
+				}
+			} finally {
+				// the in-memory files would otherwise stay around for the rest of the run
+				datasets.forEach(function(ds) { ds.close(); });
+				filenames.forEach(function(filename) { driver.deleteDataset(filename); });
+			}
+		});
+		it('should count hits and misses', function() {
+			if (!gdal.bundled) this.skip();
+			var filename = path.join(__dirname, 'data/sample.tif');
+			var before = gdal.datasetCache.stats();
+			var a = gdal.datasetCache.open(filename);
+			var b = gdal.datasetCache.open(filename);
+			b.bands.get(1).pixels.get(0, 0);
+			var after = gdal.datasetCache.stats();
+			assert.ok(after.hits + after.misses > before.hits + before.misses);
+			assert.ok(after.open <= after.max);
+			a.close();
+			b.close();
+		});
+		it('should throw when invalid file', function() {
+			var filename = path.join(__dirname, 'data/invalid');
+			assert.throws(function() {
+				gdal.datasetCache.open(filename);
+			});
+		});
+	});
 });